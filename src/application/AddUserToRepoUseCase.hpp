@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
 #include "../domain/repositories/IProjectDB.repository.hpp"
 
 class AddUserToRepoUseCase {
@@ -10,20 +11,17 @@ public:
    explicit AddUserToRepoUseCase(IProjectRepositoryDB &projectRepositoryDB, IUserRepository &userRepository)
       : projectRepositoryDB_(projectRepositoryDB), userRepository_(userRepository) {}
 
-   bool execute(const std::string &approverEmail, const std::string &approverPassword, const std::string &projectName, const std::string &userEmail) {
+   bool execute(const Principal &approver, const std::string &projectName, const std::string &userEmail) {
       
-      // Verificar que el usuario aprobador exista, este activo, verificado y tenga el password correcto
-      if (!userRepository_.findByEmail(approverEmail).has_value())
-         throw std::runtime_error("Approver user with email " + approverEmail + " does not exist");
+      // Actor y objetivo en una sola consulta; todas las verificaciones se hacen sobre esta copia
+      const UserSnapshot users = userRepository_.loadSnapshot({approver.email, userEmail});
 
-      if (!userRepository_.isValidPassword(approverEmail, approverPassword))
-         throw std::runtime_error("Invalid password for approver user: " + approverEmail);
+      // Verificar que el usuario aprobador (autenticado con su token de sesion) este activo y verificado
+      if (!users.isActive(approver.email))
+         throw std::runtime_error("User: " + approver.email + " is not active");
 
-      if (!userRepository_.isStatusActive(approverEmail))
-         throw std::runtime_error("User: " + approverEmail + " is not active");
-
-      if (!userRepository_.isVerifiedUser(approverEmail))
-         throw std::runtime_error("Approver user with email " + approverEmail + " is not verified");
+      if (!users.isVerified(approver.email))
+         throw std::runtime_error("Approver user with email " + approver.email + " is not verified");
 
 
       auto projectOpt = projectRepositoryDB_.findByName(projectName);
@@ -32,32 +30,30 @@ public:
 
 
       // Verificar que el usuario a agregar exista
-      auto userOpt = userRepository_.findByEmail(userEmail);
-      if (!userOpt.has_value())
+      const User *targetUser = users.find(userEmail);
+      if (targetUser == nullptr)
          throw std::runtime_error("User with email " + userEmail + " does not exist");
 
       // Verificar que no exista ya la relacion entre el usuario y el proyecto
-      if (projectRepositoryDB_.existsUserInProject(projectOpt->idProject, userOpt->idUser))
+      if (projectRepositoryDB_.existsUserInProject(projectOpt->idProject, targetUser->idUser))
          throw std::runtime_error("User with email " + userEmail + " is already added to project " + projectName);
 
       // Verificar que el usuario approver tenga permisos (Senior o Leader del proyecto)
-      auto approverUser = userRepository_.findByEmail(approverEmail);
-
       // Si es senior, permitir a todos los proyectos
-      if (userRepository_.isSeniorUser(approverEmail)) {
-         return projectRepositoryDB_.addUserToProject(projectOpt->idProject, userOpt->idUser);
+      if (users.isSenior(approver.email)) {
+         return projectRepositoryDB_.addUserToProject(projectOpt->idProject, targetUser->idUser);
       }
 
       // Si es leader, permitir solo si es el owner del proyecto
-      if (userRepository_.isLeaderUser(approverEmail)) {
-         if (projectOpt->ownerId == approverUser->idUser) {
-            return projectRepositoryDB_.addUserToProject(projectOpt->idProject, userOpt->idUser);
+      if (users.isLeader(approver.email)) {
+         if (projectOpt->ownerId == approver.idUser) {
+            return projectRepositoryDB_.addUserToProject(projectOpt->idProject, targetUser->idUser);
          } else {
-            throw std::runtime_error("Leader user with email " + approverEmail + " is not the owner of the project " + projectName);
+            throw std::runtime_error("Leader user with email " + approver.email + " is not the owner of the project " + projectName);
          }
       }
 
-      throw std::runtime_error("User " + approverEmail + " is not authorized to add users to the project " + projectName);
+      throw std::runtime_error("User " + approver.email + " is not authorized to add users to the project " + projectName);
    }
 
 private:
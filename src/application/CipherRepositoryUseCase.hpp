@@ -2,12 +2,19 @@
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <chrono>
+#include <vector>
+#include <filesystem>
 
 // Repo de cripto, storage, usuaros DB
 #include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
 #include "../domain/repositories/IRepositoryStore.repository.hpp"
 #include "../domain/repositories/IProjectDB.repository.hpp"
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+#include "../domain/repositories/IMetrics.repository.hpp"
+#include "../domain/entities/RepoManifest.entity.hpp"
+#include "../domain/utils/AliasLocks.hpp"
 
 
 class CipherRepositoryUseCase {
@@ -15,19 +22,44 @@ public:
    explicit CipherRepositoryUseCase(IRepositoryStore &repositoryStore,
                                     IProjectRepositoryDB &DBProjectRepository,
                                     IUserRepository &userRepository,
-                                    IProtectRepoCryptoRepository &cryptoRepo)
+                                    IProtectRepoCryptoRepository &cryptoRepo,
+                                    IMetricsRepository &metrics,
+                                    AliasLocks &aliasLocks)
       : repositoryStore_(repositoryStore),
         DBProjectRepository(DBProjectRepository),
         userRepository_(userRepository),
-        cryptoRepo_(cryptoRepo) {}
+        cryptoRepo_(cryptoRepo),
+        metrics_(metrics),
+        aliasLocks_(aliasLocks) {}
+
+   // Etapas que se miden en cada cifrado (histogramas usecase_stage_duration_seconds)
+   static std::vector<std::string> stageNames() {
+      return { "protect_manifest", "protect_tar", "protect_encrypt", "protect_rsa_wrap", "protect_db_insert" };
+   }
+
+   // Resultado de un cifrado incremental
+   struct IncrementalResult {
+      std::string wrappedKey;        // clave envuelta del líder (la clave del alias no cambia)
+      std::uint32_t snapshot = 0;    // delta escrito (o el ultimo snapshot si no hubo cambios)
+      std::size_t changed = 0;       // archivos nuevos o modificados en el delta
+      std::size_t deleted = 0;       // tombstones
+   };
         
-   std::string execute(const std::string &leaderEmail, const std::string &leaderPassword, const std::string &seniorEmail, const std::string &repoName, const std::string &projectAlias) {
+   // allMembers: ademas del líder y el senior, envolver la clave para todos los miembros del proyecto
+   //             (users_has_projects) activos, verificados y con la clave pública del algoritmo
+   // algorithm:  RSA-OAEP con kpubrsa o ECIES P-256 con kpubecdsa; se guarda en cada fila de repo_protect
+   std::string execute(const Principal &leader, const std::string &seniorEmail, const std::string &repoName,
+                       const std::string &projectAlias, bool allMembers = false,
+                       WrapAlgorithm algorithm = WrapAlgorithm::RSA_OAEP) {
      
       /******************  Verificar existencias de los actores ******************/
 
-      // 1. Verificar que el usuario líder exista
-      auto leaderOpt = userRepository_.findByEmail(leaderEmail);
-      if (!leaderOpt.has_value())
+      // 1. Datos actuales del líder (autenticado con su token de sesion) y del senior, en una sola consulta;
+      //    todas las verificaciones de actores se hacen sobre esta copia
+      const std::string &leaderEmail = leader.email;
+      const UserSnapshot users = userRepository_.loadSnapshot({leaderEmail, seniorEmail});
+      const User *leaderRow = users.find(leaderEmail);
+      if (leaderRow == nullptr)
          throw std::runtime_error("Leader user with email " + leaderEmail + " does not exist");
 
       // 2. Verificar que el repositorio exista en DB y en storage
@@ -39,8 +71,8 @@ public:
          throw std::runtime_error("Repository with name " + repoName + " does not exist in storage");
       
       // 3. Verificar que el usuario senior exista
-      auto seniorOpt = userRepository_.findByEmail(seniorEmail);
-      if (!seniorOpt.has_value())
+      const User *seniorRow = users.find(seniorEmail);
+      if (seniorRow == nullptr)
          throw std::runtime_error("Senior user with email " + seniorEmail + " does not exist");
 
 
@@ -48,7 +80,7 @@ public:
       /******************  Verificar al usuario líder  ******************/
 
       // Pasar a User la info del líder
-      User leaderUser = leaderOpt.value();
+      const User &leaderUser = *leaderRow;
 
       // 4. Verificar que el usuario esté verificado y activo
       if (leaderUser.verify == 0 || leaderUser.status == 0)
@@ -58,11 +90,7 @@ public:
       if (leaderUser.role != 2)
          throw std::runtime_error("User " + leaderEmail + " is not authorized to cipher repositories");
 
-      // 6. Verificar que el password del líder sea correcto
-      if (!userRepository_.isValidPassword(leaderEmail, leaderPassword))
-         throw std::runtime_error("Invalid password for leader user: " + leaderEmail);
-
-      // 7. Verificar que el lider sea el owner del repo que solicita cifrar
+      // 6. Verificar que el lider sea el owner del repo que solicita cifrar
       Repository repo = projectOpt.value();
       if (repo.ownerId != leaderUser.idUser)
          throw std::runtime_error("User " + leaderEmail + " is not the leader of the repository " + repoName);
@@ -70,77 +98,246 @@ public:
 
       
       /******************  Verificar al usuario senior  ******************/
-      // 8. Verificar que el usuario senior tenga permisos
-      if (seniorOpt->role != 3)
+      // 7. Verificar que el usuario senior tenga permisos
+      if (seniorRow->role != 3)
          throw std::runtime_error("User " + seniorEmail + " is not authorized as senior to cipher repositories");
 
-      // 9. Verificar que el usuario senior esté verificado y activo
-      if (seniorOpt->verify == 0 || seniorOpt->status == 0)
+      // 8. Verificar que el usuario senior esté verificado y activo
+      if (seniorRow->verify == 0 || seniorRow->status == 0)
          throw std::runtime_error("Senior user with email " + seniorEmail + " is not verified or not active");
 
 
-      /****************** Existencia de claves públicas RSA ******************/
-      // 10. Verificar que el líder tenga clave pública RSA
-      if (userRepository_.notRSAKeyAdded(leaderEmail))
-         throw std::runtime_error("Leader user with email " + leaderEmail + " does not have a RSA public key added");
+      /****************** Existencia de claves públicas (RSA o EC, segun el algoritmo) ******************/
+      const bool ecies = algorithm == WrapAlgorithm::ECIES_P256;
+      const std::string keyName = ecies ? "an ECDSA" : "a RSA";
+
+      // 9. Verificar que el líder tenga la clave pública del algoritmo
+      if (!(ecies ? users.hasECDSAKey(leaderEmail) : users.hasRSAKey(leaderEmail)))
+         throw std::runtime_error("Leader user with email " + leaderEmail + " does not have " + keyName + " public key added");
 
-      // 11. Verificar que el senior tenga clave pública RSA
-      if (userRepository_.notRSAKeyAdded(seniorEmail))
-         throw std::runtime_error("Senior user with email " + seniorEmail + " does not have a RSA public key added");
+      // 10. Verificar que el senior tenga la clave pública del algoritmo
+      if (!(ecies ? users.hasECDSAKey(seniorEmail) : users.hasRSAKey(seniorEmail)))
+         throw std::runtime_error("Senior user with email " + seniorEmail + " does not have " + keyName + " public key added");
 
 
 
       /******************  Cifrado del repo  ******************/
 
-      // 12. Verificar que el repo no esté ya cifrado (comprobando en el registro de la base de datos)
+      // 11. Verificar que el repo no esté ya cifrado (comprobando en el registro de la base de datos);
+      //     el lock del alias cubre desde esta comprobacion hasta el INSERT
+      AliasLocks::Guard aliasLock = aliasLocks_.exclusive(repoName + "_" + projectAlias);
       if (DBProjectRepository.existsRepoAlias(repoName + "_" + projectAlias))
          throw std::runtime_error("The repository alias " + repoName + "_" + projectAlias + " for the repository " + repoName + " already exists in the database. Choose another alias.");
          
-      // 13. Generar clave AES
+      // 12. Generar clave AES
       std::string aesKeyB64 = cryptoRepo_.gen_b64_AES_GCM_Key();
       
-      // 14. Cifrar la clave AES con la clave pública RSA del usuario lider del repo, aun no la guarda en DB
-      std::string aesKeyCifradaRSA_Leader = cryptoRepo_.cipher_RSA_OAEP(aesKeyB64, leaderUser.publicKeyRSA.c_str());
+      // 13. Destinatarios de la clave: líder, senior y (en modo allMembers) los miembros del proyecto, sin repetir
+      std::vector<User> recipients = { leaderUser, *seniorRow };
+      if (allMembers) {
+         for (User &member : userRepository_.findProjectMembersWithWrapKey(repo.idProject, algorithm)) {
+            bool repeated = false;
+            for (const User &recipient : recipients) repeated = repeated || recipient.idUser == member.idUser;
+            if (!repeated) recipients.push_back(std::move(member));
+         }
+      }
 
-      // 15. Cifrar la clave AES con la clave pública RSA del usuario senior, aun no la guarda en DB
-      std::string aesKeyCifradaRSA_Senior = cryptoRepo_.cipher_RSA_OAEP(aesKeyB64, seniorOpt->publicKeyRSA.c_str());
+      // 14. Cifrar la clave AES con la clave pública de cada destinatario (en paralelo), aun no la guarda en DB
+      auto wrapStart = Clock::now();
+      std::vector<std::string> publicKeys;
+      publicKeys.reserve(recipients.size());
+      for (const User &recipient : recipients) publicKeys.push_back(wrapPublicKey(recipient, algorithm));
+      std::vector<std::string> wrappedKeys = ecies ? cryptoRepo_.cipher_ECIES_many(aesKeyB64, publicKeys)
+                                                   : cryptoRepo_.cipher_RSA_OAEP_many(aesKeyB64, publicKeys);
+
+      std::vector<WrappedKey> rows;
+      rows.reserve(recipients.size());
+      for (std::size_t i = 0; i < recipients.size(); ++i) {
+         if (wrappedKeys[i].empty())
+            throw std::runtime_error("Error ciphering the AES key for user " + recipients[i].email);
+         rows.push_back(WrappedKey{recipients[i].idUser, wrappedKeys[i], algorithm});
+      }
+      metrics_.observeStage("protect_rsa_wrap", microsSince(wrapStart));
+
+      // 15. Manifiesto de la carpeta (ruta, tamaño, mtime, hash), antes del tar: un archivo que cambie
+      //     mientras se empaqueta queda con otro mtime y entra en el siguiente delta
+      auto manifestStart = Clock::now();
+      RepoManifest manifest = repositoryStore_.scanRepository(repoName, RepoManifest{});
+      metrics_.observeStage("protect_manifest", microsSince(manifestStart));
+
+      // 16. Crear el tar.gz del repo y cifrarlo en un solo paso → <repo>_<alias>.tar.enc en carpeta de cifrado
+      //     (el tar se genera en proceso y se cifra al vuelo, sin archivo .tar intermedio;
+      //     el indice de archivos se guarda cifrado en el mismo .tar.enc para extracciones sueltas).
+      //     Un alias nuevo empieza en la generacion 0; lo que haya quedado de un alias anterior con el
+      //     mismo nombre (deltas, manifiesto) se borra antes
+      repositoryStore_.discardGeneration(repoName, projectAlias, 0);
+      std::filesystem::path cipherTarPath = repositoryStore_.cipherFilePath(repoName, projectAlias, 0);
+      bool cifradoOk = archiveAndCipher(
+         [this, &repoName](const ByteSink &sink) { return repositoryStore_.folderToTarStream(repoName, sink); },
+         cipherTarPath, aesKeyB64);
+
+      // 17. Verificar que el cifrado fue correcto
+      if (!cifradoOk) throw std::runtime_error("Error ciphering the repository: " + repoName);
+
+      // 18. Guardar el manifiesto cifrado con la misma clave (punto de partida del modo incremental)
+      std::filesystem::path manifestPath = repositoryStore_.manifestFilePath(repoName, projectAlias, 0);
+      if (!writeManifest(manifestPath, manifest, aesKeyB64)) {
+         repositoryStore_.discardGeneration(repoName, projectAlias, 0);
+         throw std::runtime_error("Error storing the manifest of the repository: " + repoName);
+      }
 
-      // 16. Crear tar del repo
-      std::filesystem::path tarPath = repositoryStore_.folderToTar(repoName, projectAlias);
+      // 19. Si el cifrado fue correcto, guardar todas las claves cifradas en repo_protect (un INSERT, una transacción)
+      auto insertStart = Clock::now();
+      if (!DBProjectRepository.addPasswords_repo_users(repo.idProject, repoName + "_" + projectAlias, rows)) {
+         repositoryStore_.discardGeneration(repoName, projectAlias, 0);
+         throw std::runtime_error("Error storing the ciphered AES keys in DB");
+      }
+      metrics_.observeStage("protect_db_insert", microsSince(insertStart));
 
-      // 17. Cifrar el tar → fileOutPath en carpeta de cifrado
-      std::string cipherTarPath = tarPath.string() + ".enc";
-      bool cifradoOk = cryptoRepo_.cipher_AES_GCM(tarPath.string(), cipherTarPath, aesKeyB64);
+      // 20. Retornar la clave AES envuelta del líder para mostrar al cliente (lider/owner del repo/proyecto)
+      return rows.front().rsaAes;
+   }
 
-      // 18. Eliminar el tar original (se cifre o no correctamente, no se necesita más)
-      bool tarDeleted = repositoryStore_.deleteCipherFile((tarPath.filename()).string());
-      if (!tarDeleted) throw std::runtime_error("Error deleting the original tar file: " + tarPath.string());
 
+   // Modo incremental: agrega al alias ya protegido un delta con solo los archivos nuevos o modificados
+   // y tombstones de los borrados, encadenado al ultimo snapshot. Se cifra con la misma clave (keyAES,
+   // desenvuelta por el líder), asi que no se envuelve ni se inserta nada en DB; el tiempo depende de
+   // lo que cambio y no del tamaño del repositorio
+   IncrementalResult executeIncremental(const Principal &leader, const std::string &repoName,
+                                        const std::string &projectAlias, const std::string &keyAES) {
 
-      // 19. Verificar que el cifrado fue correcto
-      if (!cifradoOk) throw std::runtime_error("Error ciphering the repository tar file: " + tarPath.string());
+      // 1. Datos actuales del líder: verificado, activo, con rol de líder y owner del repositorio
+      const std::string &leaderEmail = leader.email;
+      auto leaderOpt = userRepository_.findByEmail(leaderEmail);
+      if (!leaderOpt.has_value())
+         throw std::runtime_error("Leader user with email " + leaderEmail + " does not exist");
 
+      const User &leaderUser = leaderOpt.value();
+      if (leaderUser.verify == 0 || leaderUser.status == 0)
+         throw std::runtime_error("Leader user with email " + leaderEmail + " is not verified or not active");
 
-      // 20. Si el cifrado fue correcto, guardar las claves cifradas en la tabla repo_protect
-      bool passwordStored_Leader = DBProjectRepository.addPassword_repo_user(leaderUser.idUser, repo.idProject, aesKeyCifradaRSA_Leader, repoName + "_" + projectAlias);
-      if (!passwordStored_Leader) {
-         repositoryStore_.deleteCipherFile((tarPath.filename().string() + ".enc"));
-         throw std::runtime_error("Error storing the ciphered AES key for leader user in DB");
-      }
-      
-      bool passwordStored_Senior = DBProjectRepository.addPassword_repo_user(seniorOpt->idUser, repo.idProject, aesKeyCifradaRSA_Senior, repoName + "_" + projectAlias);
-      if (!passwordStored_Senior) {
-         repositoryStore_.deleteCipherFile((tarPath.filename().string() + ".enc"));
-         throw std::runtime_error("Error storing the ciphered AES key for senior user in DB");
+      if (leaderUser.role != 2)
+         throw std::runtime_error("User " + leaderEmail + " is not authorized to cipher repositories");
+
+      auto projectOpt = DBProjectRepository.findByName(repoName);
+      if (!projectOpt.has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      if (projectOpt->ownerId != leaderUser.idUser)
+         throw std::runtime_error("User " + leaderEmail + " is not the leader of the repository " + repoName);
+
+      if (!repositoryStore_.findByName(repoName).has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in storage");
+
+      // 2. Lock exclusivo del alias: delta y manifiesto salen del mismo recorrido y un re-cifrado no
+      //    cambia la generacion a la mitad (un segundo incremental o un re-cifrado esperan a que termine)
+      std::string fullAlias = repoName + "_" + projectAlias;
+      AliasLocks::Guard aliasLock = aliasLocks_.exclusive(fullAlias);
+
+      // 3. El alias debe estar protegido y el líder debe tener una copia de la clave
+      IncrementalResult result;
+      for (const WrappedKey &holder : DBProjectRepository.findKeyHolders(fullAlias))
+         if (holder.idUser == leaderUser.idUser) result.wrappedKey = holder.rsaAes;
+      if (result.wrappedKey.empty())
+         throw std::runtime_error("User " + leaderEmail + " has no key for the protected repository " + fullAlias);
+
+      // 4. Archivos de la generacion de clave activa; verificar la clave y leer el manifiesto del ultimo snapshot
+      auto generation = DBProjectRepository.findKeyGeneration(fullAlias);
+      if (!generation.has_value() ||
+          !std::filesystem::is_regular_file(repositoryStore_.cipherFilePath(repoName, projectAlias, *generation)))
+         throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+
+      if (!cryptoRepo_.verifyKey_AES_GCM(repositoryStore_.cipherFilePath(repoName, projectAlias, *generation).string(), keyAES))
+         throw std::runtime_error("The AES key does not match the protected repository " + fullAlias);
+
+      std::filesystem::path manifestPath = repositoryStore_.manifestFilePath(repoName, projectAlias, *generation);
+      if (!std::filesystem::exists(manifestPath))
+         throw std::runtime_error("Protected repository " + fullAlias + " has no manifest (protected before incremental mode); protect it under a new alias");
+
+      // 5. Recorrer la carpeta: solo se hashean los archivos con otro tamaño o mtime
+      auto manifestStart = Clock::now();
+      RepoManifest previous = readManifest(manifestPath, keyAES);
+      RepoManifest current = repositoryStore_.scanRepository(repoName, previous);
+      ManifestDiff diff = diffManifests(previous, current);
+      metrics_.observeStage("protect_manifest", microsSince(manifestStart));
+
+      result.snapshot = previous.snapshot;
+      if (diff.empty()) return result;
+
+      // 6. Delta N+1 (archivos cambiados + tombstones en su indice), cifrado con la clave del alias
+      std::uint32_t snapshot = previous.snapshot + 1;
+      std::filesystem::path deltaPath = repositoryStore_.snapshotFilePath(repoName, projectAlias, *generation, snapshot);
+      bool cifradoOk = archiveAndCipher(
+         [this, &repoName, &diff, snapshot](const ByteSink &sink) {
+            return repositoryStore_.deltaToTarStream(repoName, diff, snapshot, sink);
+         },
+         deltaPath, keyAES);
+      if (!cifradoOk) throw std::runtime_error("Error ciphering the delta of the repository: " + repoName);
+
+      // 7. Manifiesto nuevo (temporal + rename): el siguiente delta se calcula contra este snapshot
+      current.snapshot = snapshot;
+      if (!writeManifest(manifestPath, current, keyAES)) {
+         repositoryStore_.deleteCipherFile(deltaPath.filename().string());
+         throw std::runtime_error("Error storing the manifest of the repository: " + repoName);
       }
 
-      // 21. Retornar la clave AES cifrada con RSA del líder para mostrar al cliente (lider/owner del repo/proyecto)
-      return aesKeyCifradaRSA_Leader;
+      result.snapshot = snapshot;
+      result.changed = diff.changed.size();
+      result.deleted = diff.deleted.size();
+      return result;
    }
 
 private:
+   using Clock = std::chrono::steady_clock;
+
    IRepositoryStore  &repositoryStore_;
    IProjectRepositoryDB &DBProjectRepository;
    IUserRepository  &userRepository_;
    IProtectRepoCryptoRepository &cryptoRepo_;
+   IMetricsRepository &metrics_;
+   AliasLocks &aliasLocks_;
+
+   // tar y cifrado corren en la misma pasada: el tiempo dentro del sink es del cifrador,
+   // el resto del productor es del tar/gzip
+   bool archiveAndCipher(const IndexedByteProducer &archive, const std::filesystem::path &outPath, const std::string &keyAES) {
+      auto archiveStart = Clock::now();
+      std::uint64_t tarMicros = 0;
+      bool ok = cryptoRepo_.cipherStreamIndexed_AES_GCM(
+         [&archive, &tarMicros](const ByteSink &sink) {
+            auto producerStart = Clock::now();
+            std::uint64_t sinkMicros = 0;
+            std::string index = archive([&sink, &sinkMicros](const char *data, std::size_t size) {
+               auto sinkStart = Clock::now();
+               sink(data, size);
+               sinkMicros += microsSince(sinkStart);
+            });
+            std::uint64_t producerMicros = microsSince(producerStart);
+            tarMicros = producerMicros > sinkMicros ? producerMicros - sinkMicros : 0;
+            return index;
+         },
+         outPath.string(), keyAES);
+      std::uint64_t archiveMicros = microsSince(archiveStart);
+      metrics_.observeStage("protect_tar", tarMicros);
+      metrics_.observeStage("protect_encrypt", archiveMicros > tarMicros ? archiveMicros - tarMicros : 0);
+      return ok;
+   }
+
+   bool writeManifest(const std::filesystem::path &manifestPath, const RepoManifest &manifest, const std::string &keyAES) {
+      std::string serialized = repositoryStore_.serializeManifest(manifest);
+      return cryptoRepo_.cipherStream_AES_GCM(
+         [&serialized](const ByteSink &sink) { sink(serialized.data(), serialized.size()); },
+         manifestPath.string(), keyAES);
+   }
+
+   RepoManifest readManifest(const std::filesystem::path &manifestPath, const std::string &keyAES) {
+      std::string serialized;
+      cryptoRepo_.decipherStream_AES_GCM(manifestPath.string(), keyAES,
+         [&serialized](const char *data, std::size_t size) { serialized.append(data, size); });
+      return repositoryStore_.parseManifest(serialized);
+   }
+
+   static std::uint64_t microsSince(Clock::time_point start) {
+      return static_cast<std::uint64_t>(
+         std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+   }
 };
\ No newline at end of file
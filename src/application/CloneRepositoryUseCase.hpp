@@ -0,0 +1,159 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <filesystem>
+#include <cstdint>
+#include <cstdio>
+
+// Repo de storage, usuaros DB
+#include "../domain/repositories/IRepositoryStore.repository.hpp"
+#include "../domain/repositories/IProjectDB.repository.hpp"
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+#include "../domain/utils/AliasLocks.hpp"
+
+
+// Descargar un repositorio: la carpeta de trabajo como tar.gz generado al vuelo, o un archivo
+// de la cadena protegida tal cual esta en disco (sin descifrar): el snapshot 0 es el archivo base y
+// 1..N los deltas del modo incremental (con sus tombstones en el indice cifrado). La respuesta dice
+// cual es el ultimo, asi el cliente pide cada delta y los aplica en orden sobre el base.
+// Un archivo guardado como lista de chunks no sirve al cliente: con la clave del alias se envia
+// reconstruido como archivo segmentado normal (sellado al vuelo, mismos bytes en cada peticion).
+class CloneRepositoryUseCase {
+public:
+   // Lo que se va a enviar una vez autorizada la solicitud
+   struct CloneSource {
+      bool protectedArchive;             // true: .tar.enc en disco, false: tar.gz de la carpeta
+      std::string repoName;
+      std::filesystem::path cipherFile;  // solo si protectedArchive
+      std::uint64_t size;                // solo si protectedArchive (el tar.gz no tiene tamaño conocido)
+      std::string etag;                  // solo si protectedArchive
+      std::uint32_t snapshot;            // solo si protectedArchive: el que se envia
+      std::uint32_t lastSnapshot;        // solo si protectedArchive: ultimo delta de la cadena
+      bool chunkList;                    // solo si protectedArchive: se envia reconstruido (requiere keyAES)
+      std::string keyAES;                // solo si chunkList
+   };
+
+   explicit CloneRepositoryUseCase(IRepositoryStore &repositoryStore,
+                                   IProjectRepositoryDB &DBProjectRepository,
+                                   IUserRepository &userRepository,
+                                   IProtectRepoCryptoRepository &cryptoRepo,
+                                   AliasLocks &aliasLocks)
+      : repositoryStore_(repositoryStore),
+        DBProjectRepository(DBProjectRepository),
+        userRepository_(userRepository),
+        cryptoRepo_(cryptoRepo),
+        aliasLocks_(aliasLocks) {}
+
+   // Verifica al usuario y ubica lo que se va a enviar; projectAlias vacio → carpeta de trabajo.
+   // snapshot: archivo de la cadena protegida (0 = base). keyAES solo hace falta si el archivo es una
+   // lista de chunks; sin ella se devuelve chunkList = true con keyAES vacio y quien llama debe rechazar
+   CloneSource execute(const Principal &principal, const std::string &repoName, const std::string &projectAlias,
+                       std::uint32_t snapshot = 0, const std::string &keyAES = "") {
+
+      // 1. Datos actuales del usuario autenticado (pueden haber cambiado desde que inicio sesion)
+      const std::string &email = principal.email;
+      auto userOpt = userRepository_.findByEmail(email);
+      if (!userOpt.has_value())
+         throw std::runtime_error("User with email " + email + " does not exist");
+
+      User user = userOpt.value();
+
+      // 2. Verificar que el usuario esté verificado y activo
+      if (user.verify == 0 || user.status == 0)
+         throw std::runtime_error("User with email " + email + " is not verified or not active");
+
+      // 3. Verificar que el repositorio exista en DB
+      auto projectOpt = DBProjectRepository.findByName(repoName);
+      if (!projectOpt.has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      CloneSource source{};
+      source.repoName = repoName;
+
+      if (projectAlias.empty()) {
+         // 4a. Carpeta de trabajo: el usuario debe ser el owner o miembro del proyecto
+         Repository repo = projectOpt.value();
+         if (repo.ownerId != user.idUser && !DBProjectRepository.existsUserInProject(repo.idProject, user.idUser))
+            throw std::runtime_error("User " + email + " is not a member of the repository " + repoName);
+
+         if (!repositoryStore_.findByName(repoName).has_value())
+            throw std::runtime_error("Repository with name " + repoName + " does not exist in storage");
+
+         source.protectedArchive = false;
+         return source;
+      }
+
+      // 4b. Archivo protegido: el usuario debe tener una copia de la clave del alias
+      std::string fullAlias = repoName + "_" + projectAlias;
+      if (!DBProjectRepository.existsKeyHolder(fullAlias, user.idUser))
+         throw std::runtime_error("User " + email + " has no key for the protected repository " + fullAlias);
+
+      // 5. Cadena de la generacion activa, con el lock compartido (sin un delta ni un re-cifrado a la mitad)
+      AliasLocks::Guard aliasLock = aliasLocks_.shared(fullAlias);
+      auto generation = DBProjectRepository.findKeyGeneration(fullAlias);
+      if (!generation.has_value() ||
+          !std::filesystem::is_regular_file(repositoryStore_.cipherFilePath(repoName, projectAlias, *generation)))
+         throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+
+      source.protectedArchive = true;
+      source.snapshot = snapshot;
+      source.lastSnapshot = repositoryStore_.lastSnapshot(repoName, projectAlias, *generation);
+      if (snapshot > source.lastSnapshot)
+         throw std::runtime_error("Snapshot " + std::to_string(snapshot) + " does not exist in " + fullAlias +
+                                  " (last is " + std::to_string(source.lastSnapshot) + ")");
+
+      source.cipherFile = repositoryStore_.snapshotFilePath(repoName, projectAlias, *generation, snapshot);
+      source.chunkList = cryptoRepo_.isChunkList_AES_GCM(source.cipherFile.string());
+      if (!source.chunkList) {
+         source.size = std::filesystem::file_size(source.cipherFile);
+      } else {
+         // 6. Lista de chunks: el tamaño es el del archivo reconstruido (el ETag de la cadena sigue valiendo
+         //    porque la reconstruccion es determinista)
+         if (keyAES.empty()) return source;
+         if (!cryptoRepo_.verifyKey_AES_GCM(source.cipherFile.string(), keyAES))
+            throw std::runtime_error("Invalid AES key for the protected repository " + fullAlias);
+         source.keyAES = keyAES;
+         source.size = cryptoRepo_.rebuiltSize_AES_GCM(source.cipherFile.string(), keyAES);
+      }
+
+      // 7. ETag de la cadena completa (generacion, ultimo snapshot, tamaño y mtime de cada archivo):
+      //    un delta nuevo o un re-cifrado cambian el ETag de todos los snapshots
+      std::uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+      auto mix = [&hash](const std::string &text) {
+         for (unsigned char c : text) hash = (hash ^ c) * 1099511628211ULL;
+      };
+      for (std::uint32_t i = 0; i <= source.lastSnapshot; ++i) {
+         std::filesystem::path file = repositoryStore_.snapshotFilePath(repoName, projectAlias, *generation, i);
+         mix(std::to_string(std::filesystem::file_size(file)) + ":" +
+             std::to_string(std::filesystem::last_write_time(file).time_since_epoch().count()) + ";");
+      }
+      char digest[17];
+      std::snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+      source.etag = "\"g" + std::to_string(*generation) + "-s" + std::to_string(snapshot) + "-" +
+                    std::to_string(source.lastSnapshot) + "-" + digest + "\"";
+      return source;
+   }
+
+   // Emite [offset, offset + length) del archivo protegido (para respuestas completas y por rangos)
+   void streamProtected(const CloneSource &source, std::uint64_t offset, std::uint64_t length, const ByteSink &out) {
+      if (source.chunkList)
+         cryptoRepo_.readRebuilt_AES_GCM(source.cipherFile.string(), source.keyAES, offset, length, out);
+      else
+         repositoryStore_.readCipherRange(source.cipherFile, offset, length, out);
+   }
+
+   // Emite el tar.gz de la carpeta de trabajo conforme se genera
+   void streamWorkingTree(const CloneSource &source, const ByteSink &out) {
+      repositoryStore_.folderToTarStream(source.repoName, out);
+   }
+
+private:
+   IRepositoryStore  &repositoryStore_;
+   IProjectRepositoryDB &DBProjectRepository;
+   IUserRepository  &userRepository_;
+   IProtectRepoCryptoRepository &cryptoRepo_;
+   AliasLocks &aliasLocks_;
+};
@@ -9,6 +9,7 @@
 // Caso de uso para usuarios en ls base de datos
 // #include "../domain/entities/User.entity.hpp"
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
 
 class CreateRepositoryUseCase {
 public:
@@ -20,27 +21,24 @@ public:
          userRepository_(userRepository),
          projectRepositoryDB_(projectRepositoryDB) {}
 
-   Repository execute(const std::string &repoName, const std::string &userEmail, const std::string &userPassword) {
+   Repository execute(const Principal &owner, const std::string &repoName) {
 
-      // 1.0. Validar que el usuario que desea crear el repo exista
-      auto ownerOpt = userRepository_.findByEmail(userEmail);
-      if (!ownerOpt.has_value()) 
-         throw std::runtime_error("User: " + userEmail + " not found");
+      // 1.0. El usuario que desea crear el repo ya se autentico con su token de sesion
+      const std::string &userEmail = owner.email;
+
+      // Datos del usuario en una sola consulta; todas las verificaciones se hacen sobre esta copia
+      const UserSnapshot users = userRepository_.loadSnapshot({userEmail});
 
       // 1.1. Validar que el status del usuario sea activo (esta trabajando actualmente)
-      if (!userRepository_.isStatusActive(userEmail))
+      if (!users.isActive(userEmail))
          throw std::runtime_error("User: " + userEmail + " is not active");
 
       // 1.2. Validar que el usuario esté verificado
-      if (!userRepository_.isVerifiedUser(userEmail))
+      if (!users.isVerified(userEmail))
          throw std::runtime_error("User with email " + userEmail + " is not verified");
 
-      // 1.3. Validar que el password sea correcto
-      if (!userRepository_.isValidPassword(userEmail, userPassword))
-         throw std::runtime_error("Invalid password for user: " + userEmail);
-
-      // 1.4. Validar que el usuario tenga permisos para crear repositorios (Leader o Senior)
-      if (!userRepository_.isLeaderUser(userEmail) && !userRepository_.isSeniorUser(userEmail))
+      // 1.3. Validar que el usuario tenga permisos para crear repositorios (Leader o Senior)
+      if (!users.isLeader(userEmail) && !users.isSenior(userEmail))
          throw std::runtime_error(userEmail + " is not authorized to create a repository");
  
       // No permitir duplicados: Buscar en la base de datos si ya existe un repo con ese nombre
@@ -59,7 +57,7 @@ public:
 
       // registrar el repositorio en la base de datos
       std::string description = "Repository for " + repoName;
-      return projectRepositoryDB_.create(newRepo.name, description, ownerOpt->idUser);
+      return projectRepositoryDB_.create(newRepo.name, description, owner.idUser);
    }
 
 private:
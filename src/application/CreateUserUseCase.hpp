@@ -5,14 +5,15 @@
 // Caso de uso para usuarios en ls base de datos
 // #include "../domain/entities/User.entity.hpp"
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/repositories/IPasswordHash.repository.hpp"
 
 // Helper para validar formato de email
 #include "../domain/utils/EmailValidator.hpp"
 
 class CreateUserUseCase {
 public:
-   explicit CreateUserUseCase(IUserRepository &userRepository)
-      : userRepository_(userRepository) {}
+   explicit CreateUserUseCase(IUserRepository &userRepository, IPasswordHashRepository &passwordHasher)
+      : userRepository_(userRepository), passwordHasher_(passwordHasher) {}
 
    bool execute(const std::string &name, const std::string &email, const std::string &password) {
       
@@ -26,9 +27,12 @@ public:
       if (existing.has_value()) {
          throw std::runtime_error("User with email " + email + " already exists");
       }
-      return userRepository_.create(name, email, password);
+
+      // Guardar solo el hash con sal (se calcula en el pool de hashing)
+      return userRepository_.create(name, email, passwordHasher_.hash(password));
    }
 
 private:
    IUserRepository  &userRepository_;
+   IPasswordHashRepository &passwordHasher_;
 };
\ No newline at end of file
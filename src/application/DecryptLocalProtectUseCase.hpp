@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <filesystem>
+#include <vector>
+
+// Repo de cripto, storage, usuaros DB
+#include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
+#include "../domain/repositories/IRepositoryStore.repository.hpp"
+#include "../domain/repositories/IProjectDB.repository.hpp"
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+#include "../domain/utils/AliasLocks.hpp"
+
+
+// Descifrar un repositorio protegido en el servidor: .tar.enc → descifrado → gunzip → extraccion,
+// todo en una sola pasada y sin archivos intermedios (ni .tar ni .tar.gz en disco).
+// Si el alias tiene deltas (modo incremental) se aplican en orden sobre el archivo base.
+// La carpeta <repo>_<alias> se instala de forma atomica solo si toda la cadena verifica.
+class DecryptLocalProtectUseCase {
+public:
+   explicit DecryptLocalProtectUseCase(IRepositoryStore &repositoryStore,
+                                       IProjectRepositoryDB &DBProjectRepository,
+                                       IUserRepository &userRepository,
+                                       IProtectRepoCryptoRepository &cryptoRepo,
+                                       AliasLocks &aliasLocks)
+      : repositoryStore_(repositoryStore),
+        DBProjectRepository(DBProjectRepository),
+        userRepository_(userRepository),
+        cryptoRepo_(cryptoRepo),
+        aliasLocks_(aliasLocks) {}
+
+   // keyAES: la clave del alias ya desenvuelta por el cliente. Devuelve el nombre de la carpeta creada
+   std::string execute(const Principal &principal, const std::string &repoName, const std::string &projectAlias,
+                       const std::string &keyAES) {
+
+      // 1. Datos actuales del usuario autenticado
+      const std::string &email = principal.email;
+      auto userOpt = userRepository_.findByEmail(email);
+      if (!userOpt.has_value())
+         throw std::runtime_error("User with email " + email + " does not exist");
+
+      User user = userOpt.value();
+
+      // 2. Verificar que el usuario esté verificado y activo
+      if (user.verify == 0 || user.status == 0)
+         throw std::runtime_error("User with email " + email + " is not verified or not active");
+
+      // 3. Verificar que el proyecto exista y que el usuario tenga una copia de la clave
+      if (!DBProjectRepository.findByName(repoName).has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      std::string fullAlias = repoName + "_" + projectAlias;
+      if (!DBProjectRepository.existsKeyHolder(fullAlias, user.idUser))
+         throw std::runtime_error("User " + email + " has no key for the protected repository " + fullAlias);
+
+      // 4. Verificar que exista el archivo cifrado de la generacion de clave activa; el lock compartido
+      //    se mantiene hasta instalar la carpeta (la cadena no cambia mientras se descifra)
+      AliasLocks::Guard aliasLock = aliasLocks_.shared(fullAlias);
+      auto generation = DBProjectRepository.findKeyGeneration(fullAlias);
+      if (!generation.has_value() ||
+          !std::filesystem::is_regular_file(repositoryStore_.cipherFilePath(repoName, projectAlias, *generation)))
+         throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+
+      // 5. Verificar la clave con el primer segmento antes de crear nada en disco
+      std::filesystem::path cipherFile = repositoryStore_.cipherFilePath(repoName, projectAlias, *generation);
+      if (!cryptoRepo_.verifyKey_AES_GCM(cipherFile.string(), keyAES))
+         throw std::runtime_error("The AES key does not match the protected repository " + fullAlias);
+
+      // 6. Capas: archivo base y deltas en orden; los tombstones de cada delta vienen en su indice,
+      //    que ademas confirma que el archivo es el snapshot esperado de la cadena
+      std::vector<ArchiveLayer> layers;
+      std::uint32_t last = repositoryStore_.lastSnapshot(repoName, projectAlias, *generation);
+      for (std::uint32_t snapshot = 0; snapshot <= last; ++snapshot) {
+         std::string file = repositoryStore_.snapshotFilePath(repoName, projectAlias, *generation, snapshot).string();
+         std::vector<std::string> deleted;
+         if (snapshot > 0)
+            deleted = repositoryStore_.snapshotTombstones(cryptoRepo_.readIndex_AES_GCM(file, keyAES), snapshot);
+
+         layers.push_back(ArchiveLayer{[this, file, &keyAES](const ByteSink &tarGz) {
+            cryptoRepo_.decipherStream_AES_GCM(file, keyAES, tarGz);
+         }, std::move(deleted)});
+      }
+
+      // 7. Descifrar directo al extractor; un segmento alterado aborta y descarta la carpeta temporal
+      repositoryStore_.extractArchiveStream(fullAlias, layers);
+
+      return fullAlias;
+   }
+
+private:
+   IRepositoryStore  &repositoryStore_;
+   IProjectRepositoryDB &DBProjectRepository;
+   IUserRepository  &userRepository_;
+   IProtectRepoCryptoRepository &cryptoRepo_;
+   AliasLocks &aliasLocks_;
+};
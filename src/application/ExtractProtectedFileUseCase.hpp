@@ -0,0 +1,111 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+
+// Repo de cripto, storage, usuaros DB
+#include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
+#include "../domain/repositories/IRepositoryStore.repository.hpp"
+#include "../domain/repositories/IProjectDB.repository.hpp"
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+#include "../domain/entities/ArchiveMember.entity.hpp"
+#include "../domain/utils/AliasLocks.hpp"
+
+
+// Extraer un solo archivo de un repositorio protegido (.tar.enc) sin descifrar todo el archivo:
+// con el indice cifrado se ubican los segmentos que cubren al archivo y solo esos se descifran.
+// Con deltas (modo incremental) se busca del ultimo snapshot hacia el archivo base.
+// Ubicar y emitir toman el lock compartido del alias (cada uno por su lado: no se retiene mientras
+// el cliente recibe la respuesta); si un re-cifrado cambio la generacion en medio, emitir falla.
+class ExtractProtectedFileUseCase {
+public:
+   // Lo necesario para emitir el archivo una vez autorizada la solicitud
+   struct Extraction {
+      std::string fullAlias;
+      std::filesystem::path cipherFile;
+      ArchiveMember member;
+   };
+
+   explicit ExtractProtectedFileUseCase(IRepositoryStore &repositoryStore,
+                                        IProjectRepositoryDB &DBProjectRepository,
+                                        IUserRepository &userRepository,
+                                        IProtectRepoCryptoRepository &cryptoRepo,
+                                        AliasLocks &aliasLocks)
+      : repositoryStore_(repositoryStore),
+        DBProjectRepository(DBProjectRepository),
+        userRepository_(userRepository),
+        cryptoRepo_(cryptoRepo),
+        aliasLocks_(aliasLocks) {}
+
+   // Verifica al usuario y ubica el archivo; no emite datos (los errores salen antes de responder)
+   Extraction execute(const Principal &principal, const std::string &repoName, const std::string &projectAlias,
+                      const std::string &keyAES, const std::string &filePath) {
+
+      // 1. Datos actuales del usuario autenticado (pueden haber cambiado desde que inicio sesion)
+      const std::string &email = principal.email;
+      auto userOpt = userRepository_.findByEmail(email);
+      if (!userOpt.has_value())
+         throw std::runtime_error("User with email " + email + " does not exist");
+
+      User user = userOpt.value();
+
+      // 2. Verificar que el usuario esté verificado y activo
+      if (user.verify == 0 || user.status == 0)
+         throw std::runtime_error("User with email " + email + " is not verified or not active");
+
+      // 3. Verificar que el usuario tenga una copia de la clave del repositorio protegido
+      std::string fullAlias = repoName + "_" + projectAlias;
+      if (!DBProjectRepository.existsKeyHolder(fullAlias, user.idUser))
+         throw std::runtime_error("User " + email + " has no key for the protected repository " + fullAlias);
+
+      // 4. Verificar que exista el archivo cifrado de la generacion de clave activa; con el lock compartido
+      //    ni un incremental ni un re-cifrado cambian la cadena mientras se recorre
+      AliasLocks::Guard aliasLock = aliasLocks_.shared(fullAlias);
+      auto generation = DBProjectRepository.findKeyGeneration(fullAlias);
+      if (!generation.has_value() ||
+          !std::filesystem::is_regular_file(repositoryStore_.cipherFilePath(repoName, projectAlias, *generation)))
+         throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+
+      // 5. Descifrar los indices (verifica la clave: un tag invalido lanza excepcion) del snapshot mas
+      //    reciente al base: gana el primero que tenga el archivo; un tombstone antes de eso lo da por borrado
+      for (std::uint32_t snapshot = repositoryStore_.lastSnapshot(repoName, projectAlias, *generation); ; --snapshot) {
+         std::filesystem::path cipherFile = repositoryStore_.snapshotFilePath(repoName, projectAlias, *generation, snapshot);
+         std::string index = cryptoRepo_.readIndex_AES_GCM(cipherFile.string(), keyAES);
+         std::vector<std::string> deleted = repositoryStore_.snapshotTombstones(index, snapshot);
+
+         auto memberOpt = repositoryStore_.findArchiveMember(index, filePath);
+         if (memberOpt.has_value())
+            return Extraction{fullAlias, cipherFile, memberOpt.value()};
+
+         if (snapshot == 0 || std::find(deleted.begin(), deleted.end(), filePath) != deleted.end()) break;
+      }
+
+      throw std::runtime_error("File " + filePath + " does not exist in " + fullAlias);
+   }
+
+   // Descifra solo los segmentos que cubren los bloques gzip del archivo y emite el archivo descomprimido
+   void stream(const Extraction &extraction, const std::string &keyAES, const ByteSink &out) {
+      AliasLocks::Guard aliasLock = aliasLocks_.shared(extraction.fullAlias);
+      if (!std::filesystem::is_regular_file(extraction.cipherFile))
+         throw std::runtime_error("Protected repository " + extraction.fullAlias + " changed; request the file again");
+
+      const ArchiveMember &member = extraction.member;
+      repositoryStore_.inflateArchiveMember(member,
+         [this, &extraction, &member, &keyAES](const ByteSink &compressed) {
+            cryptoRepo_.decipherRange_AES_GCM(extraction.cipherFile.string(), keyAES,
+                                              member.compressedOffset, member.compressedLength, compressed);
+         },
+         out);
+   }
+
+private:
+   IRepositoryStore  &repositoryStore_;
+   IProjectRepositoryDB &DBProjectRepository;
+   IUserRepository  &userRepository_;
+   IProtectRepoCryptoRepository &cryptoRepo_;
+   AliasLocks &aliasLocks_;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cctype>
+
+// Repo de storage, usuaros DB
+#include "../domain/repositories/IRepositoryStore.repository.hpp"
+#include "../domain/repositories/IProjectDB.repository.hpp"
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+
+
+// Subir (push) el contenido de un repositorio como tar.gz por streaming:
+// se guarda en un temporal mientras se hashea y luego se extrae reemplazando la carpeta de forma atomica
+class PushRepositoryUseCase {
+public:
+   // La subida supera el maximo configurado (la API responde 413)
+   class TooLarge : public std::runtime_error {
+   public:
+      using std::runtime_error::runtime_error;
+   };
+
+   explicit PushRepositoryUseCase(IRepositoryStore &repositoryStore,
+                                  IProjectRepositoryDB &DBProjectRepository,
+                                  IUserRepository &userRepository,
+                                  std::uint64_t maxUploadBytes)
+      : repositoryStore_(repositoryStore),
+        DBProjectRepository(DBProjectRepository),
+        userRepository_(userRepository),
+        maxUploadBytes_(maxUploadBytes) {}
+
+   std::uint64_t maxUploadBytes() const { return maxUploadBytes_; }
+
+   // Verifica al usuario antes de leer el body; declaredSize viene de Content-Length (0 si no hay)
+   void authorize(const Principal &principal, const std::string &repoName, std::uint64_t declaredSize) {
+
+      // 1. Rechazar antes de recibir datos si el tamaño declarado supera el maximo
+      if (declaredSize > maxUploadBytes_)
+         throw TooLarge("Upload of " + std::to_string(declaredSize) + " bytes exceeds the maximum of " + std::to_string(maxUploadBytes_));
+
+      // 2. Datos actuales del usuario autenticado (pueden haber cambiado desde que inicio sesion)
+      const std::string &email = principal.email;
+      auto userOpt = userRepository_.findByEmail(email);
+      if (!userOpt.has_value())
+         throw std::runtime_error("User with email " + email + " does not exist");
+
+      User user = userOpt.value();
+
+      // 3. Verificar que el usuario esté verificado y activo
+      if (user.verify == 0 || user.status == 0)
+         throw std::runtime_error("User with email " + email + " is not verified or not active");
+
+      // 4. Verificar que el repositorio exista y que el usuario sea owner o miembro
+      auto projectOpt = DBProjectRepository.findByName(repoName);
+      if (!projectOpt.has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      Repository repo = projectOpt.value();
+      if (repo.ownerId != user.idUser && !DBProjectRepository.existsUserInProject(repo.idProject, user.idUser))
+         throw std::runtime_error("User " + email + " is not a member of the repository " + repoName);
+   }
+
+   // Recibe el tar.gz, verifica el hash esperado (si se envio) y reemplaza la carpeta del repositorio.
+   // Llamar solo despues de authorize()
+   StagedUpload execute(const std::string &repoName, const std::string &expectedSha256, const ByteProducer &body) {
+
+      // 5. Guardar a disco mientras llega, cortando en cuanto se supera el maximo
+      std::uint64_t maxBytes = maxUploadBytes_;
+      StagedUpload upload = repositoryStore_.stageUpload(repoName,
+         [&body, maxBytes](const ByteSink &sink) {
+            std::uint64_t received = 0;
+            body([&sink, &received, maxBytes](const char *data, std::size_t size) {
+               received += size;
+               if (received > maxBytes)
+                  throw TooLarge("Upload exceeds the maximum of " + std::to_string(maxBytes) + " bytes");
+               sink(data, size);
+            });
+         });
+
+      // 6. Verificar integridad contra el hash que declaro el cliente
+      if (!expectedSha256.empty() && !equalsIgnoreCase(expectedSha256, upload.sha256)) {
+         repositoryStore_.discardUpload(upload);
+         throw std::runtime_error("SHA-256 mismatch: expected " + expectedSha256 + ", received " + upload.sha256);
+      }
+
+      // 7. Extraer y reemplazar la carpeta; el temporal se elimina en cualquier caso
+      try {
+         repositoryStore_.replaceFolderFromArchive(repoName, upload.path);
+      } catch (...) {
+         repositoryStore_.discardUpload(upload);
+         throw;
+      }
+      repositoryStore_.discardUpload(upload);
+
+      return upload;
+   }
+
+private:
+   IRepositoryStore  &repositoryStore_;
+   IProjectRepositoryDB &DBProjectRepository;
+   IUserRepository  &userRepository_;
+   std::uint64_t maxUploadBytes_;
+
+   static bool equalsIgnoreCase(const std::string &a, const std::string &b) {
+      if (a.size() != b.size()) return false;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+         if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+      }
+      return true;
+   }
+};
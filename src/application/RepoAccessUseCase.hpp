@@ -0,0 +1,278 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <utility>
+#include <filesystem>
+
+// Repo de cripto, storage, usuaros DB
+#include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
+#include "../domain/repositories/IRepositoryStore.repository.hpp"
+#include "../domain/repositories/IProjectDB.repository.hpp"
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
+#include "../domain/utils/AliasLocks.hpp"
+
+
+// Dar y quitar acceso a un repositorio ya protegido sin volver a cifrarlo:
+// solo se envuelve (o se borra) la clave AES del alias para un usuario, el .tar.enc no se toca.
+//
+// Quitar una fila no le quita al usuario la clave que ya conoce; para eso revokeAndReencrypt() cambia
+// la clave del archivo, la vuelve a envolver para los usuarios que conservan acceso y quita la fila en la
+// misma transaccion (en segundo plano). Si falla, el usuario conserva la fila y se puede reintentar.
+// Las tres operaciones toman el lock exclusivo del alias: un grant o revoke no puede terminar en medio
+// de un re-cifrado (se perderia o se desharia al reescribir las filas).
+class RepoAccessUseCase {
+public:
+   explicit RepoAccessUseCase(IRepositoryStore &repositoryStore,
+                              IProjectRepositoryDB &DBProjectRepository,
+                              IUserRepository &userRepository,
+                              IProtectRepoCryptoRepository &cryptoRepo,
+                              AliasLocks &aliasLocks)
+      : repositoryStore_(repositoryStore),
+        DBProjectRepository(DBProjectRepository),
+        userRepository_(userRepository),
+        cryptoRepo_(cryptoRepo),
+        aliasLocks_(aliasLocks) {}
+
+   // Un usuario con copia de la clave da acceso a otro; keyAES es la clave del alias ya desenvuelta
+   // por quien da el acceso. Devuelve la clave envuelta (RSA-OAEP o ECIES) para el nuevo usuario
+   std::string grant(const Principal &granter, const std::string &repoName, const std::string &projectAlias,
+                     const std::string &keyAES, const std::string &granteeEmail,
+                     WrapAlgorithm algorithm = WrapAlgorithm::RSA_OAEP) {
+
+      // 1. Ambos usuarios en una sola consulta
+      const UserSnapshot users = userRepository_.loadSnapshot({granter.email, granteeEmail});
+
+      // 2. Verificar que quien da el acceso esté activo y verificado
+      if (!users.isActive(granter.email) || !users.isVerified(granter.email))
+         throw std::runtime_error("User with email " + granter.email + " is not verified or not active");
+
+      // 3. Verificar que el proyecto exista y que quien da el acceso tenga una copia de la clave
+      auto projectOpt = DBProjectRepository.findByName(repoName);
+      if (!projectOpt.has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      std::string fullAlias = repoName + "_" + projectAlias;
+      AliasLocks::Guard aliasLock = aliasLocks_.exclusive(fullAlias);
+      if (!DBProjectRepository.existsKeyHolder(fullAlias, granter.idUser))
+         throw std::runtime_error("User " + granter.email + " has no key for the protected repository " + fullAlias);
+
+      // 4. Verificar al nuevo usuario: existe, activo, verificado y con la clave pública del algoritmo
+      const User *grantee = users.find(granteeEmail);
+      if (grantee == nullptr)
+         throw std::runtime_error("User with email " + granteeEmail + " does not exist");
+
+      if (!users.isActive(granteeEmail) || !users.isVerified(granteeEmail))
+         throw std::runtime_error("User with email " + granteeEmail + " is not verified or not active");
+
+      const bool ecies = algorithm == WrapAlgorithm::ECIES_P256;
+      if (!(ecies ? users.hasECDSAKey(granteeEmail) : users.hasRSAKey(granteeEmail)))
+         throw std::runtime_error("User with email " + granteeEmail + " does not have " + (ecies ? "an ECDSA" : "a RSA") + " public key added");
+
+      // 5. Solo miembros del proyecto, su owner o un senior pueden recibir la clave
+      if (!DBProjectRepository.existsUserInProject(projectOpt->idProject, grantee->idUser) &&
+          projectOpt->ownerId != grantee->idUser && !users.isSenior(granteeEmail))
+         throw std::runtime_error("User " + granteeEmail + " is not a member of the project " + repoName);
+
+      // 6. Verificar que no tenga ya una copia
+      if (DBProjectRepository.existsKeyHolder(fullAlias, grantee->idUser))
+         throw std::runtime_error("User " + granteeEmail + " already has a key for the protected repository " + fullAlias);
+
+      // 7. Verificar la clave contra el archivo cifrado de la generacion activa (descifra solo el primer segmento)
+      std::uint32_t generation = activeGeneration(fullAlias);
+      std::filesystem::path cipherFile = repositoryStore_.cipherFilePath(repoName, projectAlias, generation);
+      if (!std::filesystem::is_regular_file(cipherFile))
+         throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+
+      if (!cryptoRepo_.verifyKey_AES_GCM(cipherFile.string(), keyAES))
+         throw std::runtime_error("The AES key does not match the protected repository " + fullAlias);
+
+      // 8. Envolver la clave con la clave pública del nuevo usuario y guardar la fila con su algoritmo
+      const std::string &publicKey = wrapPublicKey(*grantee, algorithm);
+      std::string wrapped = ecies ? cryptoRepo_.cipher_ECIES(keyAES, publicKey) : cryptoRepo_.cipher_RSA_OAEP(keyAES, publicKey);
+      if (wrapped.empty())
+         throw std::runtime_error("Error ciphering the AES key for user " + granteeEmail);
+
+      if (!DBProjectRepository.addPassword_repo_user(grantee->idUser, projectOpt->idProject, wrapped, fullAlias, algorithm, generation))
+         throw std::runtime_error("Error storing the ciphered AES key for user " + granteeEmail + " in DB");
+
+      return wrapped;
+   }
+
+   // El líder owner del proyecto o un senior quita la copia de la clave de un usuario (sin re-cifrar)
+   void revoke(const Principal &revoker, const std::string &repoName, const std::string &projectAlias,
+               const std::string &targetEmail) {
+      std::string fullAlias = repoName + "_" + projectAlias;
+      AliasLocks::Guard aliasLock = aliasLocks_.exclusive(fullAlias);
+      int targetId = checkRevoke(revoker, repoName, projectAlias, targetEmail, "");
+
+      if (!DBProjectRepository.removeKeyHolder(fullAlias, targetId))
+         throw std::runtime_error("Error removing the key of user " + targetEmail + " from DB");
+   }
+
+   // Las mismas verificaciones que revokeAndReencrypt (incluida la clave actual) sin cambiar nada:
+   // para responder los errores antes de encolar el trabajo
+   void checkRevokeAndReencrypt(const Principal &revoker, const std::string &repoName, const std::string &projectAlias,
+                                const std::string &targetEmail, const std::string &keyAES) {
+      AliasLocks::Guard aliasLock = aliasLocks_.shared(repoName + "_" + projectAlias);
+      checkRevoke(revoker, repoName, projectAlias, targetEmail, keyAES);
+   }
+
+   // Quita el acceso y cambia la clave del alias en un solo paso: la cadena completa (base, deltas y
+   // manifiesto) se escribe con la clave nueva en la generacion siguiente; al confirmar en DB la fila del
+   // usuario se borra en la misma transaccion que activa esa generacion. Hasta entonces los archivos de la
+   // generacion activa y la fila siguen intactos. Devuelve la nueva clave envuelta de quien revoca ("" si no tiene copia)
+   std::string revokeAndReencrypt(const Principal &revoker, const std::string &repoName, const std::string &projectAlias,
+                                  const std::string &targetEmail, const std::string &keyAES) {
+
+      // 1. Verificaciones de revoke (otra vez: el estado pudo cambiar mientras el trabajo esperaba)
+      std::string fullAlias = repoName + "_" + projectAlias;
+      AliasLocks::Guard aliasLock = aliasLocks_.exclusive(fullAlias);
+      int targetId = checkRevoke(revoker, repoName, projectAlias, targetEmail, keyAES);
+
+      std::uint32_t generation = activeGeneration(fullAlias);
+
+      // 2. Usuarios que conservan acceso; cada uno conserva el algoritmo con el que se le envolvio la clave
+      std::vector<WrappedKey> rows;
+      for (WrappedKey &holder : DBProjectRepository.findKeyHolders(fullAlias))
+         if (holder.idUser != targetId) rows.push_back(std::move(holder));
+      if (rows.empty())
+         throw std::runtime_error("The protected repository " + fullAlias + " has no key holders");
+
+      std::vector<std::string> rsaKeys, ecKeys;
+      std::vector<std::size_t> rsaRows, ecRows;
+      for (std::size_t i = 0; i < rows.size(); ++i) {
+         auto userOpt = userRepository_.findById(rows[i].idUser);
+         if (!userOpt.has_value() || wrapPublicKey(*userOpt, rows[i].algorithm) == "NULL")
+            throw std::runtime_error("Key holder " + std::to_string(rows[i].idUser) + " has no " +
+                                     wrapAlgorithmName(rows[i].algorithm) + " public key");
+         bool ecies = rows[i].algorithm == WrapAlgorithm::ECIES_P256;
+         (ecies ? ecKeys : rsaKeys).push_back(wrapPublicKey(*userOpt, rows[i].algorithm));
+         (ecies ? ecRows : rsaRows).push_back(i);
+      }
+
+      // 3. Nueva clave, envuelta para todos en paralelo (un lote por algoritmo)
+      std::string newKeyAES = cryptoRepo_.gen_b64_AES_GCM_Key();
+      std::vector<std::string> rsaWrapped = cryptoRepo_.cipher_RSA_OAEP_many(newKeyAES, rsaKeys);
+      std::vector<std::string> ecWrapped = cryptoRepo_.cipher_ECIES_many(newKeyAES, ecKeys);
+      for (std::size_t j = 0; j < rsaRows.size(); ++j) rows[rsaRows[j]].rsaAes = rsaWrapped[j];
+      for (std::size_t j = 0; j < ecRows.size(); ++j) rows[ecRows[j]].rsaAes = ecWrapped[j];
+
+      std::string revokerKey;
+      for (const WrappedKey &row : rows) {
+         if (row.rsaAes.empty())
+            throw std::runtime_error("Error ciphering the AES key for user " + std::to_string(row.idUser));
+         if (row.idUser == revoker.idUser) revokerKey = row.rsaAes;
+      }
+
+      // 4. Re-cifrar cada archivo de la cadena a la generacion siguiente (lo que haya quedado de un
+      //    re-cifrado interrumpido se descarta antes)
+      std::uint32_t next = generation + 1;
+      repositoryStore_.discardGeneration(repoName, projectAlias, next);
+
+      std::vector<std::pair<std::filesystem::path, std::filesystem::path>> files;
+      std::uint32_t last = repositoryStore_.lastSnapshot(repoName, projectAlias, generation);
+      for (std::uint32_t snapshot = 0; snapshot <= last; ++snapshot)
+         files.emplace_back(repositoryStore_.snapshotFilePath(repoName, projectAlias, generation, snapshot),
+                            repositoryStore_.snapshotFilePath(repoName, projectAlias, next, snapshot));
+      std::filesystem::path manifestPath = repositoryStore_.manifestFilePath(repoName, projectAlias, generation);
+      if (std::filesystem::exists(manifestPath))
+         files.emplace_back(manifestPath, repositoryStore_.manifestFilePath(repoName, projectAlias, next));
+
+      for (const auto &file : files) {
+         if (!cryptoRepo_.rekey_AES_GCM(file.first.string(), file.second.string(), keyAES, newKeyAES)) {
+            repositoryStore_.discardGeneration(repoName, projectAlias, next);
+            throw std::runtime_error("Error re-encrypting the protected repository " + fullAlias);
+         }
+      }
+
+      // 5. Activar la generacion nueva: las filas cambian de clave y de generacion y la del usuario
+      //    revocado se borra, en una sola transaccion
+      if (!DBProjectRepository.rewrapPasswords_repo_users(fullAlias, next, rows, targetId)) {
+         repositoryStore_.discardGeneration(repoName, projectAlias, next);
+         throw std::runtime_error("Error storing the re-wrapped AES keys in DB");
+      }
+
+      // 6. La generacion anterior ya no la usa nadie (si esto no llega a correr, la borra recoverInterruptedRekeys)
+      repositoryStore_.discardGeneration(repoName, projectAlias, generation);
+
+      return revokerKey;
+   }
+
+   // Al arrancar (antes de atender peticiones): termina o deshace los re-cifrados que se cortaron.
+   // La generacion activa es la de las filas en DB; la anterior quedo si se corto despues del commit
+   // y la siguiente si se corto antes. Devuelve cuantos archivos borro
+   std::size_t recoverInterruptedRekeys() {
+      std::size_t removed = 0;
+      for (const ProtectedAlias &alias : DBProjectRepository.findProtectedAliases()) {
+         AliasLocks::Guard aliasLock = aliasLocks_.exclusive(alias.repoName + "_" + alias.projectAlias);
+         if (alias.generation > 0)
+            removed += repositoryStore_.discardGeneration(alias.repoName, alias.projectAlias, alias.generation - 1);
+         removed += repositoryStore_.discardGeneration(alias.repoName, alias.projectAlias, alias.generation + 1);
+      }
+      return removed;
+   }
+
+private:
+   IRepositoryStore  &repositoryStore_;
+   IProjectRepositoryDB &DBProjectRepository;
+   IUserRepository  &userRepository_;
+   IProtectRepoCryptoRepository &cryptoRepo_;
+   AliasLocks &aliasLocks_;
+
+   // Verificaciones de revoke (quien llama tiene el lock del alias). Con keyAES verifica ademas la
+   // clave actual. Devuelve el id del usuario al que se le quita el acceso
+   int checkRevoke(const Principal &revoker, const std::string &repoName, const std::string &projectAlias,
+                   const std::string &targetEmail, const std::string &keyAES) {
+
+      // 1. Ambos usuarios en una sola consulta
+      const UserSnapshot users = userRepository_.loadSnapshot({revoker.email, targetEmail});
+
+      // 2. Verificar que quien quita el acceso esté activo y verificado
+      if (!users.isActive(revoker.email) || !users.isVerified(revoker.email))
+         throw std::runtime_error("User with email " + revoker.email + " is not verified or not active");
+
+      // 3. Verificar que el proyecto exista y que quien quita el acceso sea su owner o un senior
+      auto projectOpt = DBProjectRepository.findByName(repoName);
+      if (!projectOpt.has_value())
+         throw std::runtime_error("Repository with name " + repoName + " does not exist in DB");
+
+      if (projectOpt->ownerId != revoker.idUser && !users.isSenior(revoker.email))
+         throw std::runtime_error("User " + revoker.email + " is not authorized to revoke access to " + repoName);
+
+      // 4. Verificar que el usuario tenga una copia y que no sea la ultima
+      const User *target = users.find(targetEmail);
+      if (target == nullptr)
+         throw std::runtime_error("User with email " + targetEmail + " does not exist");
+
+      std::string fullAlias = repoName + "_" + projectAlias;
+      std::vector<WrappedKey> holders = DBProjectRepository.findKeyHolders(fullAlias);
+      bool isHolder = false;
+      for (const WrappedKey &holder : holders) isHolder = isHolder || holder.idUser == target->idUser;
+      if (!isHolder)
+         throw std::runtime_error("User " + targetEmail + " has no key for the protected repository " + fullAlias);
+      if (holders.size() < 2)
+         throw std::runtime_error("Cannot revoke the last key of the protected repository " + fullAlias);
+
+      // 5. Con re-cifrado: la clave actual debe ser la del archivo de la generacion activa
+      if (!keyAES.empty()) {
+         std::filesystem::path cipherFile =
+            repositoryStore_.cipherFilePath(repoName, projectAlias, activeGeneration(fullAlias));
+         if (!std::filesystem::is_regular_file(cipherFile))
+            throw std::runtime_error("Protected repository " + fullAlias + " does not exist in storage");
+         if (!cryptoRepo_.verifyKey_AES_GCM(cipherFile.string(), keyAES))
+            throw std::runtime_error("The AES key does not match the protected repository " + fullAlias);
+      }
+
+      return target->idUser;
+   }
+
+
+   std::uint32_t activeGeneration(const std::string &fullAlias) {
+      auto generation = DBProjectRepository.findKeyGeneration(fullAlias);
+      if (!generation.has_value())
+         throw std::runtime_error("The protected repository " + fullAlias + " has no key holders");
+      return *generation;
+   }
+};
@@ -5,33 +5,31 @@
 // Caso de uso para usuarios en ls base de datos
 // #include "../domain/entities/User.entity.hpp"
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
 
 class SavePublicKeyECDSAUseCase {
 public:
    explicit SavePublicKeyECDSAUseCase(IUserRepository &userRepository)
       : userRepository_(userRepository) {}
 
-   bool execute(const std::string &email, const std::string &publicKey, const std::string &password) {
+   bool execute(const Principal &user, const std::string &publicKey) {
       
-      // Verificar que el usuario exista
-      auto existing = userRepository_.findByEmail(email);
-      if (!existing.has_value())
-         throw std::runtime_error("User with email " + email + " does not exist");
+      // El usuario ya se autentico con su token de sesion
+      const std::string &email = user.email;
+
+      // Datos del usuario en una sola consulta; todas las verificaciones se hacen sobre esta copia
+      const UserSnapshot users = userRepository_.loadSnapshot({email});
 
       // Validar que el status del usuario sea activo (esta trabajando actualmente)
-      if (!userRepository_.isStatusActive(email))
+      if (!users.isActive(email))
          throw std::runtime_error("User: " + email + " is not active");
 
       // Verificar que el usuario esté verificado
-      if (!userRepository_.isVerifiedUser(email))
+      if (!users.isVerified(email))
          throw std::runtime_error("User with email " + email + " is not verified");
 
-      // Verificar que el password sea correcto
-      if (!userRepository_.isValidPassword(email, password))
-         throw std::runtime_error("Invalid password for user: " + email);
-
       // Regla de negocio: solo se puede agregar si no hay clave ECDSA previa
-      if (!userRepository_.notECDSAKeyAdded(email))
+      if (users.hasECDSAKey(email))
          throw std::runtime_error("User with email " + email + " already has an ECDSA public key added");
          
       // Guardar la clave publica ECDSA
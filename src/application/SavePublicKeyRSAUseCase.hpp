@@ -4,38 +4,42 @@
 
 // Caso de uso para usuarios en ls base de datos
 #include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/repositories/IProtectRepoCrypto.repository.hpp"
+#include "../domain/entities/Principal.entity.hpp"
 
 class SavePublicKeyRSAUseCase {
 public:
-   explicit SavePublicKeyRSAUseCase(IUserRepository &userRepository)
-      : userRepository_(userRepository) {}
+   explicit SavePublicKeyRSAUseCase(IUserRepository &userRepository, IProtectRepoCryptoRepository &cryptoRepo)
+      : userRepository_(userRepository), cryptoRepo_(cryptoRepo) {}
 
-   bool execute(const std::string &email, const std::string &publicKey, const std::string &password) {
+   bool execute(const Principal &user, const std::string &publicKey) {
       
-      // Verificar que el usuario exista
-      auto existing = userRepository_.findByEmail(email);
-      if (!existing.has_value())
-         throw std::runtime_error("User with email " + email + " does not exist");
+      // El usuario ya se autentico con su token de sesion
+      const std::string &email = user.email;
+
+      // Datos del usuario en una sola consulta; todas las verificaciones se hacen sobre esta copia
+      const UserSnapshot users = userRepository_.loadSnapshot({email});
 
       // Validar que el status del usuario sea activo (esta trabajando actualmente)
-      if (!userRepository_.isStatusActive(email))
+      if (!users.isActive(email))
          throw std::runtime_error("User: " + email + " is not active");
 
       // Verificar que el usuario esté verificado
-      if (!userRepository_.isVerifiedUser(email))
+      if (!users.isVerified(email))
          throw std::runtime_error("User with email " + email + " is not verified");
 
-      // Verificar que el password sea correcto
-      if (!userRepository_.isValidPassword(email, password))
-         throw std::runtime_error("Invalid password for user: " + email);
-
       // Regla de negocio: solo se puede agregar si no hay clave RSA previa
-      if (!userRepository_.notRSAKeyAdded(email))
+      if (users.hasRSAKey(email))
          throw std::runtime_error("User with email " + email + " already has an RSA public key added");
+
+      // Validar la clave una sola vez, aqui: al cifrar repos ya no se vuelve a validar en cada uso
+      if (!cryptoRepo_.validate_RSA_PublicKey(publicKey))
+         throw std::runtime_error("Invalid RSA public key: expected a Base64 DER (X.509 SubjectPublicKeyInfo) RSA key");
          
       // Guardar la clave publica RSA
       return userRepository_.addPublicKeyRSA(email, publicKey);
    }
 private:
    IUserRepository  &userRepository_;
+   IProtectRepoCryptoRepository &cryptoRepo_;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include <optional>
+
+#include "../domain/repositories/IUser.repository.hpp"
+#include "../domain/repositories/ISessionToken.repository.hpp"
+#include "../domain/repositories/IPasswordHash.repository.hpp"
+
+
+// Inicio y cierre de sesion. El password se verifica (contra el hash guardado) solo al hacer login;
+// despues cada peticion se autentica con el token (en memoria, sin consultas).
+class SessionUseCase {
+public:
+   explicit SessionUseCase(IUserRepository &userRepository, ISessionTokenRepository &sessionTokens,
+                           IPasswordHashRepository &passwordHasher)
+      : userRepository_(userRepository), sessionTokens_(sessionTokens), passwordHasher_(passwordHasher),
+        dummyHash_(passwordHasher.hash("unknown-email-dummy-password")) {}
+
+   SessionToken login(const std::string &email, const std::string &password) {
+
+      // 1. Verificar que el usuario exista y que el password sea correcto (el hash se compara en proceso,
+      //    en el pool de hashing; mismo mensaje en ambos casos para no revelar que emails estan registrados).
+      //    Con un email desconocido se verifica igual contra un hash de relleno con el mismo costo,
+      //    para que el tiempo de respuesta tampoco lo revele
+      auto storedHash = userRepository_.findPasswordHash(email);
+      if (!storedHash.has_value()) {
+         passwordHasher_.verify(password, dummyHash_);
+         throw std::runtime_error("Invalid email or password");
+      }
+      if (!passwordHasher_.verify(password, *storedHash))
+         throw std::runtime_error("Invalid email or password");
+
+      auto userOpt = userRepository_.findByEmail(email);
+      if (!userOpt.has_value())
+         throw std::runtime_error("Invalid email or password");
+
+      User user = userOpt.value();
+
+      // 2. Verificar que el usuario esté verificado y activo
+      if (user.verify == 0 || user.status == 0)
+         throw std::runtime_error("User with email " + email + " is not verified or not active");
+
+      // 3. Filas con el password en claro o con menos iteraciones que las configuradas:
+      //    se reemplazan por un hash actual aprovechando que se conoce el password
+      //    (si el pool de hashing esta saturado se deja para el siguiente login)
+      if (passwordHasher_.needsRehash(*storedHash)) {
+         try {
+            userRepository_.updatePasswordHash(email, passwordHasher_.hash(password));
+         } catch (const IPasswordHashRepository::Busy &) {}
+      }
+
+      // 4. Emitir el token de sesion
+      return sessionTokens_.issue(Principal{user.idUser, user.email, user.role});
+   }
+
+   // Usuario del token, o nullopt si no es valido, vencio o se cerro la sesion
+   std::optional<Principal> authenticate(const std::string &token) {
+      return sessionTokens_.resolve(token);
+   }
+
+   bool logout(const std::string &token) {
+      return sessionTokens_.revoke(token);
+   }
+
+private:
+   IUserRepository         &userRepository_;
+   ISessionTokenRepository &sessionTokens_;
+   IPasswordHashRepository &passwordHasher_;
+   const std::string        dummyHash_;  // hash con el costo configurado, para emails desconocidos
+};
@@ -0,0 +1,85 @@
+// Benchmark de compresion de repositorios: MB/s de `tar -czf` (ruta anterior),
+// tar.gz en proceso con un hilo y tar.gz en paralelo por bloques.
+//
+// g++ -O2 -std=c++17 src/benchmarks/CompressBenchmark.cpp -o compress_bench -lz -pthread
+// ./compress_bench <carpeta_repo> [hilos] [tamaño_bloque]
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include "../infrastructure/storage/TarWriter.hpp"
+#include "../infrastructure/storage/GzipWriter.hpp"
+#include "../infrastructure/storage/ParallelGzipWriter.hpp"
+
+namespace {
+   std::uintmax_t folderSize(const std::filesystem::path &dir) {
+      std::uintmax_t total = 0;
+      for (const auto &entry : std::filesystem::recursive_directory_iterator(dir)) {
+         if (entry.is_regular_file()) total += entry.file_size();
+      }
+      return total;
+   }
+
+   template <class F>
+   double seconds(F &&run) {
+      auto start = std::chrono::steady_clock::now();
+      run();
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+
+   void report(const std::string &name, double secs, std::uintmax_t inBytes, std::uintmax_t outBytes) {
+      std::cout << name << ": " << (inBytes / 1e6) / secs << " MB/s"
+                << "  (" << secs << " s, ratio " << (inBytes ? double(outBytes) / inBytes : 0.0) << ")" << std::endl;
+   }
+}
+
+int main(int argc, char **argv) {
+   if (argc < 2) {
+      std::cerr << "Uso: " << argv[0] << " <carpeta_repo> [hilos] [tamaño_bloque]" << std::endl;
+      return 1;
+   }
+
+   std::filesystem::path repo = std::filesystem::absolute(argv[1]);
+   std::size_t threads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+   std::size_t blockSize = argc > 3 ? std::stoul(argv[3]) : 1 << 20;
+   std::uintmax_t inBytes = folderSize(repo);
+   std::filesystem::path out = std::filesystem::temp_directory_path() / "orca_compress_bench.tar.gz";
+
+   std::cout << "Repositorio: " << repo << " (" << inBytes / 1e6 << " MB), hilos: " << threads
+             << ", bloque: " << blockSize << " bytes" << std::endl;
+
+   // 1. Ruta anterior: tar -czf por std::system
+   std::string command = "tar -czf \"" + out.string() + "\" -C \"" + repo.parent_path().string() + "\" \"" + repo.filename().string() + "\"";
+   double tarSecs = seconds([&] {
+      if (std::system(command.c_str()) != 0) throw std::runtime_error("tar failed");
+   });
+   report("tar -czf          ", tarSecs, inBytes, std::filesystem::file_size(out));
+
+   // 2. En proceso, un hilo
+   std::uintmax_t singleOut = 0;
+   double singleSecs = seconds([&] {
+      GzipWriter gzip([&](const char *, std::size_t size) { singleOut += size; });
+      TarWriter tar(gzip.sink());
+      tar.addDirectoryTree(repo, repo.filename().string());
+      tar.finish();
+      gzip.finish();
+   });
+   report("GzipWriter (1 hilo)", singleSecs, inBytes, singleOut);
+
+   // 3. En proceso, en paralelo
+   ThreadPool pool(threads);
+   std::uintmax_t parallelOut = 0;
+   double parallelSecs = seconds([&] {
+      ParallelGzipWriter gzip([&](const char *, std::size_t size) { parallelOut += size; }, pool, blockSize);
+      TarWriter tar(gzip.sink());
+      tar.addDirectoryTree(repo, repo.filename().string());
+      tar.finish();
+      gzip.finish();
+   });
+   report("ParallelGzipWriter ", parallelSecs, inBytes, parallelOut);
+
+   std::filesystem::remove(out);
+   return 0;
+}
@@ -0,0 +1,92 @@
+// Benchmark de las envolturas de la clave AES de un repo: RSA-2048 y RSA-4096 OAEP frente a ECIES P-256
+// (ECDH + HKDF + AES-GCM). Mide envolturas/s con las claves ya cargadas (como en un protect con muchos
+// destinatarios), validaciones/s de una clave nueva (al subirla / primera carga) y el tamaño de la envoltura.
+//
+// g++ -O2 -std=c++17 src/benchmarks/KeyWrapBenchmark.cpp -o key_wrap_bench -lcryptopp -pthread
+// ./key_wrap_bench [envolturas] [validaciones]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cryptopp/base64.h>
+#include <cryptopp/eccrypto.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/oids.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/rsa.h>
+#include "../infrastructure/concurrency/ThreadPool.hpp"
+#include "../infrastructure/crypto/ProtectRepo.hpp"
+
+namespace {
+   template <class Key>
+   std::string toBase64Der(const Key &publicKey) {
+      std::string b64;
+      CryptoPP::Base64Encoder encoder(new CryptoPP::StringSink(b64), false);
+      publicKey.DEREncode(encoder);
+      encoder.MessageEnd();
+      return b64;
+   }
+
+   // Clave publica RSA en Base64 DER, como se guarda en users.kpubrsa
+   std::string rsaPublicKey(CryptoPP::RandomNumberGenerator &rng, unsigned int bits) {
+      CryptoPP::RSA::PrivateKey privateKey;
+      privateKey.GenerateRandomWithKeySize(rng, bits);
+      return toBase64Der(CryptoPP::RSA::PublicKey(privateKey));
+   }
+
+   // Clave publica EC P-256 en Base64 DER, como se guarda en users.kpubecdsa
+   std::string ecPublicKey(CryptoPP::RandomNumberGenerator &rng) {
+      CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PrivateKey privateKey;
+      privateKey.Initialize(rng, CryptoPP::ASN1::secp256r1());
+      CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PublicKey publicKey;
+      privateKey.MakePublicKey(publicKey);
+      return toBase64Der(publicKey);
+   }
+
+   template <class F>
+   double perSecond(std::size_t count, F &&op) {
+      auto start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < count; ++i) {
+         if (!op()) throw std::runtime_error("operation failed");
+      }
+      double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return count / secs;
+   }
+
+   template <class Wrap, class Validate>
+   void report(const std::string &name, std::size_t wraps, std::size_t validations, Wrap &&wrap, Validate &&validate) {
+      std::size_t wrappedSize = wrap().size();
+      double wrapRate = perSecond(wraps, [&] { return !wrap().empty(); });
+      double validateRate = perSecond(validations, validate);
+      std::cout << name << ": " << wrapRate << " envolturas/s, " << validateRate << " validaciones/s, "
+                << wrappedSize << " caracteres Base64 por fila" << std::endl;
+   }
+}
+
+int main(int argc, char **argv) {
+   std::size_t wraps = argc > 1 ? std::stoul(argv[1]) : 2000;
+   std::size_t validations = argc > 2 ? std::stoul(argv[2]) : 200;
+
+   CryptoPP::AutoSeededRandomPool rng;
+   std::string rsa2048 = rsaPublicKey(rng, 2048);
+   std::string rsa4096 = rsaPublicKey(rng, 4096);
+   std::string p256 = ecPublicKey(rng);
+
+   ThreadPool pool{1};
+   SecureRandom random;
+   ProtectRepoCrypto crypto{pool, random};
+   std::string aesKeyB64 = crypto.gen_b64_AES_GCM_Key();
+
+   std::cout << "envolturas: " << wraps << ", validaciones: " << validations << " (un hilo)" << std::endl;
+
+   report("RSA-2048 OAEP-SHA256", wraps, validations,
+          [&] { return crypto.cipher_RSA_OAEP(aesKeyB64, rsa2048); },
+          [&] { return crypto.validate_RSA_PublicKey(rsa2048); });
+   report("RSA-4096 OAEP-SHA256", wraps, validations,
+          [&] { return crypto.cipher_RSA_OAEP(aesKeyB64, rsa4096); },
+          [&] { return crypto.validate_RSA_PublicKey(rsa4096); });
+   report("ECIES P-256         ", wraps, validations,
+          [&] { return crypto.cipher_ECIES(aesKeyB64, p256); },
+          [&] { return EciesKeyWrap::isValid(p256); });
+   return 0;
+}
@@ -0,0 +1,48 @@
+// Benchmark del hash de passwords: hashes/s con 1..N hilos y hashes/s por nucleo,
+// para elegir PASSWORD_HASH_ITERATIONS y PASSWORD_HASH_THREADS.
+// Referencia: un login deberia costar del orden de 50-250 ms de CPU.
+//
+// g++ -O2 -std=c++17 src/benchmarks/PasswordHashBenchmark.cpp -o password_hash_bench -lcryptopp -pthread
+// ./password_hash_bench [iteraciones] [hilos_max] [hashes_por_hilo]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../infrastructure/crypto/PasswordHasher.hpp"
+
+int main(int argc, char **argv) {
+   unsigned int iterations = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 600000;
+   std::size_t maxThreads = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+   std::size_t perThread = argc > 3 ? std::stoul(argv[3]) : 8;
+
+   std::cout << "PBKDF2-HMAC-SHA256, iteraciones: " << iterations << ", hashes por hilo: " << perThread << std::endl;
+
+   // 1, 2, 4, ... y hilos_max
+   std::vector<std::size_t> threadCounts;
+   for (std::size_t threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+   threadCounts.push_back(maxThreads);
+
+   const std::string salt(16, 's');
+   for (std::size_t threads : threadCounts) {
+      auto start = std::chrono::steady_clock::now();
+
+      std::vector<std::thread> workers;
+      for (std::size_t t = 0; t < threads; ++t) {
+         workers.emplace_back([&, t] {
+            for (std::size_t i = 0; i < perThread; ++i)
+               PasswordHasher::derive("password-" + std::to_string(t) + "-" + std::to_string(i), salt, iterations);
+         });
+      }
+      for (auto &worker : workers) worker.join();
+
+      double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      double hashesPerSec = (threads * perThread) / secs;
+      std::cout << threads << " hilo(s): " << hashesPerSec << " hashes/s, "
+                << hashesPerSec / threads << " hashes/s por nucleo, "
+                << 1000.0 * secs / perThread << " ms por hash" << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,65 @@
+// Benchmark de generacion de claves AES-256 + prefijos de nonce bajo concurrencia (como muchos
+// /repo/protect a la vez): AutoSeededRandomPool nuevo por llamada (ruta anterior) contra el
+// generador por hilo de SecureRandom.
+//
+// g++ -O2 -std=c++17 src/benchmarks/RandomBenchmark.cpp -o random_bench -lcryptopp -pthread
+// ./random_bench [hilos_max] [claves_por_hilo]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cryptopp/osrng.h>
+#include "../infrastructure/crypto/SecureRandom.hpp"
+
+namespace {
+   constexpr std::size_t KEY_SIZE = 32;     // AES-256
+   constexpr std::size_t NONCE_SIZE = 12;   // IV de GCM
+
+   // claves/s con `threads` hilos generando `perThread` (clave, nonce) cada uno
+   template <class MakeKey>
+   double keysPerSecond(std::size_t threads, std::size_t perThread, MakeKey makeKey) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> workers;
+      for (std::size_t t = 0; t < threads; ++t) {
+         workers.emplace_back([&] {
+            CryptoPP::byte key[KEY_SIZE], nonce[NONCE_SIZE];
+            for (std::size_t i = 0; i < perThread; ++i) makeKey(key, nonce);
+         });
+      }
+      for (auto &worker : workers) worker.join();
+      double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return (threads * perThread) / secs;
+   }
+}
+
+int main(int argc, char **argv) {
+   std::size_t maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+   std::size_t perThread = argc > 2 ? std::stoul(argv[2]) : 20000;
+
+   std::cout << "clave AES-256 + nonce de 12 bytes, por hilo: " << perThread << std::endl;
+
+   // 1, 2, 4, ... y hilos_max
+   std::vector<std::size_t> threadCounts;
+   for (std::size_t threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+   threadCounts.push_back(maxThreads);
+
+   SecureRandom random;
+   for (std::size_t threads : threadCounts) {
+      double before = keysPerSecond(threads, perThread, [](CryptoPP::byte *key, CryptoPP::byte *nonce) {
+         CryptoPP::AutoSeededRandomPool rng;
+         rng.GenerateBlock(key, KEY_SIZE);
+         rng.GenerateBlock(nonce, NONCE_SIZE);
+      });
+      double after = keysPerSecond(threads, perThread, [&random](CryptoPP::byte *key, CryptoPP::byte *nonce) {
+         random.generator().GenerateBlock(key, KEY_SIZE);
+         random.generator().GenerateBlock(nonce, NONCE_SIZE);
+      });
+      std::cout << threads << " hilo(s): AutoSeededRandomPool por llamada " << before << " claves/s, "
+                << "SecureRandom " << after << " claves/s (" << after / before << "x)" << std::endl;
+   }
+   std::cout << "re-siembras de SecureRandom: " << random.reseeds() << std::endl;
+   return 0;
+}
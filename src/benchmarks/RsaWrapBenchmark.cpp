@@ -0,0 +1,83 @@
+// Benchmark de la envoltura RSA-OAEP de la clave AES de un repo: envolturas/s con la ruta
+// anterior (Base64 -> DER -> Load -> Validate(3) -> cifrar en cada llamada) y con la cache
+// de claves ya cargadas de ProtectRepoCrypto (solo cifrar).
+//
+// g++ -O2 -std=c++17 src/benchmarks/RsaWrapBenchmark.cpp -o rsa_wrap_bench -lcryptopp -pthread
+// ./rsa_wrap_bench [bits_rsa] [envolturas]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cryptopp/base64.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/rsa.h>
+#include "../infrastructure/concurrency/ThreadPool.hpp"
+#include "../infrastructure/crypto/ProtectRepo.hpp"
+
+namespace {
+   // Ruta anterior de cipher_RSA_OAEP
+   std::string wrapUncached(const std::string &plainText, const std::string &publicKeyRSA) {
+      CryptoPP::AutoSeededRandomPool rng;
+
+      std::string publicKeyDER;
+      CryptoPP::StringSource ssKey(publicKeyRSA, true,
+         new CryptoPP::Base64Decoder(new CryptoPP::StringSink(publicKeyDER)));
+
+      CryptoPP::RSA::PublicKey publicKey;
+      CryptoPP::StringSource ssLoad(publicKeyDER, true);
+      publicKey.Load(ssLoad);
+      if (!publicKey.Validate(rng, 3))
+         throw std::runtime_error("Invalid RSA public key");
+
+      CryptoPP::RSAES<CryptoPP::OAEP<CryptoPP::SHA256>>::Encryptor encryptor(publicKey);
+      std::string cipherText;
+      CryptoPP::StringSource ssPlain(plainText, true,
+         new CryptoPP::PK_EncryptorFilter(rng, encryptor, new CryptoPP::StringSink(cipherText)));
+
+      std::string cipherTextBase64;
+      CryptoPP::StringSource ssCipher(cipherText, true,
+         new CryptoPP::Base64Encoder(new CryptoPP::StringSink(cipherTextBase64), false));
+      return cipherTextBase64;
+   }
+
+   template <class F>
+   double wrapsPerSecond(std::size_t wraps, F &&wrap) {
+      auto start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < wraps; ++i) {
+         if (wrap().empty()) throw std::runtime_error("wrap failed");
+      }
+      double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      return wraps / secs;
+   }
+}
+
+int main(int argc, char **argv) {
+   unsigned int bits = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 2048;
+   std::size_t wraps = argc > 2 ? std::stoul(argv[2]) : 2000;
+
+   // Par de claves de prueba (la publica en Base64 DER, como se guarda en users.kpubrsa)
+   CryptoPP::AutoSeededRandomPool rng;
+   CryptoPP::RSA::PrivateKey privateKey;
+   privateKey.GenerateRandomWithKeySize(rng, bits);
+   CryptoPP::RSA::PublicKey publicKey(privateKey);
+   std::string publicKeyB64;
+   CryptoPP::Base64Encoder encoder(new CryptoPP::StringSink(publicKeyB64), false);
+   publicKey.DEREncode(encoder);
+   encoder.MessageEnd();
+
+   ThreadPool pool{1};
+   SecureRandom random;
+   ProtectRepoCrypto crypto{pool, random};
+   std::string aesKeyB64 = crypto.gen_b64_AES_GCM_Key();
+
+   std::cout << "RSA-" << bits << " OAEP-SHA256, envolturas: " << wraps << std::endl;
+
+   double before = wrapsPerSecond(wraps, [&] { return wrapUncached(aesKeyB64, publicKeyB64); });
+   std::cout << "sin cache (Load + Validate por llamada): " << before << " envolturas/s" << std::endl;
+
+   double after = wrapsPerSecond(wraps, [&] { return crypto.cipher_RSA_OAEP(aesKeyB64, publicKeyB64); });
+   std::cout << "con cache de claves cargadas:          " << after << " envolturas/s ("
+             << after / before << "x)" << std::endl;
+   return 0;
+}
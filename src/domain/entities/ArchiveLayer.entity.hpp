@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "../utils/ByteStream.hpp"
+
+// Una capa de la cadena de snapshots de un alias protegido: el tar.gz (archivo base o delta)
+// y las rutas que el delta borra despues de extraerlo (vacio en el archivo base)
+struct ArchiveLayer {
+   ByteProducer tarGz;
+   std::vector<std::string> deleted;
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Ubicacion de un archivo dentro de un repositorio protegido (.tar.enc),
+// obtenida del indice que se guarda junto a los datos
+struct ArchiveMember {
+   std::string path;                // ruta relativa a la carpeta del repositorio
+   std::uint64_t size;              // bytes del archivo
+   std::uint64_t compressedOffset;  // inicio del primer bloque gzip que contiene al archivo
+   std::uint64_t compressedLength;  // bytes comprimidos (bloques completos) que lo cubren
+   std::uint64_t skip;              // bytes a descartar al descomprimir el primer bloque
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+// Usuario ya autenticado (por token de sesion); lo reciben los casos de uso en lugar de email + password.
+// Solo identifica: permisos, status y verificacion se siguen consultando en cada caso de uso
+struct Principal {
+   int idUser;
+   std::string email;
+   int role;      // rol al iniciar sesion (1: Developer, 2: Leader, 3: Senior)
+};
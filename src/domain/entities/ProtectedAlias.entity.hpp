@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Alias protegido con filas en repo_protect y la generacion de clave activa (ver IRepositoryStore)
+struct ProtectedAlias {
+   std::string repoName;
+   std::string projectAlias;   // sin el prefijo <repo>_
+   std::uint32_t generation = 0;
+};
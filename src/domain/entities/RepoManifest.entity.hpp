@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Estado de un archivo del repositorio dentro de un snapshot protegido
+struct ManifestEntry {
+   std::uint64_t size = 0;
+   std::int64_t mtimeNs = 0;   // st_mtim en nanosegundos
+   std::string sha256;         // hash (hex) del contenido, o del destino si es un enlace simbolico
+   bool symlink = false;
+};
+
+// Manifiesto de un alias protegido: ultimo snapshot de la cadena y los archivos que contiene.
+// Se guarda cifrado con la clave del alias junto al .tar.enc (<repo>_<alias>.manifest.enc)
+struct RepoManifest {
+   std::uint32_t snapshot = 0;                    // 0 = archivo base, N = delta N
+   std::map<std::string, ManifestEntry> files;    // ruta relativa a la carpeta → estado
+};
+
+// Lo que cambia entre dos snapshots: lo que se escribe en un delta
+struct ManifestDiff {
+   std::vector<std::string> changed;   // archivos nuevos o con otro contenido
+   std::vector<std::string> deleted;   // tombstones: ya no existen
+
+   bool empty() const { return changed.empty() && deleted.empty(); }
+};
+
+// Solo cuenta el contenido: un archivo con otro mtime pero el mismo hash no va en el delta
+inline ManifestDiff diffManifests(const RepoManifest &previous, const RepoManifest &current) {
+   ManifestDiff diff;
+   for (const auto &[path, entry] : current.files) {
+      auto found = previous.files.find(path);
+      if (found == previous.files.end() || found->second.sha256 != entry.sha256 || found->second.symlink != entry.symlink)
+         diff.changed.push_back(path);
+   }
+   for (const auto &[path, entry] : previous.files) {
+      if (current.files.find(path) == current.files.end()) diff.deleted.push_back(path);
+   }
+   return diff;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+struct SessionToken {
+   std::string token;        // se envia como "Authorization: Bearer <token>"
+   std::int64_t expiresAt;   // segundos unix
+   int ttlSeconds;
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Archivo recibido por streaming y guardado en un temporal, antes de extraerlo al repositorio
+struct StagedUpload {
+   std::filesystem::path path;   // temporal dentro de REPOSITORIES_ROOT
+   std::uint64_t size;           // bytes recibidos
+   std::string sha256;           // hash (hex) calculado mientras se recibia
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cctype>
+#include <string>
+#include <utility>
+#include <vector>
+#include "User.entity.hpp"
+
+// Usuarios que intervienen en una peticion (actor, objetivo...), leidos en una sola consulta.
+// Inmutable: los casos de uso evaluan todas sus reglas sobre esta copia en lugar de consultar
+// la BDD por cada verificacion. Un email que no aparece es un usuario que no existe.
+class UserSnapshot {
+public:
+   explicit UserSnapshot(std::vector<User> users) : users_(std::move(users)) {}
+
+   const User *find(const std::string &email) const {
+      for (const User &user : users_) {   // pocos usuarios por peticion: busqueda lineal
+         if (sameEmail(user.email, email)) return &user;
+      }
+      return nullptr;
+   }
+
+   bool exists(const std::string &email) const { return find(email) != nullptr; }
+
+   bool isActive(const std::string &email) const { return check(email, [](const User &u) { return u.status == 1; }); }
+   bool isVerified(const std::string &email) const { return check(email, [](const User &u) { return u.verify == 1; }); }
+
+   bool isDeveloper(const std::string &email) const { return check(email, [](const User &u) { return u.role == 1; }); }
+   bool isLeader(const std::string &email) const { return check(email, [](const User &u) { return u.role == 2; }); }
+   bool isSenior(const std::string &email) const { return check(email, [](const User &u) { return u.role == 3; }); }
+
+   // Las columnas de claves en NULL llegan como "NULL" (ver DBUserRepository)
+   bool hasECDSAKey(const std::string &email) const { return check(email, [](const User &u) { return u.publicKeyECDSA != "NULL"; }); }
+   bool hasRSAKey(const std::string &email) const { return check(email, [](const User &u) { return u.publicKeyRSA != "NULL"; }); }
+
+private:
+   const std::vector<User> users_;
+
+   // La columna email compara sin distinguir mayusculas (collation de MariaDB, igual que UserCache::normalize)
+   static bool sameEmail(const std::string &a, const std::string &b) {
+      if (a.size() != b.size()) return false;
+      for (std::size_t i = 0; i < a.size(); ++i) {
+         if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+            return false;
+      }
+      return true;
+   }
+
+   template <class Predicate>
+   bool check(const std::string &email, Predicate predicate) const {
+      const User *user = find(email);
+      return user != nullptr && predicate(*user);
+   }
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <optional>
+#include <string>
+#include "User.entity.hpp"
+
+// Como se envolvio la clave AES de una fila de repo_protect (columna wrap_alg)
+//   RSA_OAEP:   RSA-OAEP(SHA-256) con users.kpubrsa
+//   ECIES_P256: ECDH P-256 efimero + HKDF-SHA256 + AES-256-GCM con users.kpubecdsa (ver EciesKeyWrap)
+enum class WrapAlgorithm { RSA_OAEP, ECIES_P256 };
+
+inline std::string wrapAlgorithmName(WrapAlgorithm algorithm) {
+   return algorithm == WrapAlgorithm::ECIES_P256 ? "ecies-p256" : "rsa-oaep";
+}
+
+inline std::optional<WrapAlgorithm> parseWrapAlgorithm(const std::string &name) {
+   if (name == "rsa-oaep") return WrapAlgorithm::RSA_OAEP;
+   if (name == "ecies-p256") return WrapAlgorithm::ECIES_P256;
+   return std::nullopt;
+}
+
+// Clave publica del usuario con la que se envuelve para el algoritmo ("NULL" si no la subio)
+inline const std::string &wrapPublicKey(const User &user, WrapAlgorithm algorithm) {
+   return algorithm == WrapAlgorithm::ECIES_P256 ? user.publicKeyECDSA : user.publicKeyRSA;
+}
+
+// Clave AES de un repo cifrado envuelta para un usuario (una fila de repo_protect)
+struct WrappedKey {
+   int idUser;
+   std::string rsaAes;   // clave AES envuelta con la clave publica del usuario (Base64); la columna conserva el nombre rsa_aes
+   WrapAlgorithm algorithm = WrapAlgorithm::RSA_OAEP;
+};
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class IMetricsRepository {
+public:
+   virtual ~IMetricsRepository() = default;
+
+   // Registrar la duracion (us) de una etapa interna de un caso de uso (ej. "protect_tar").
+   // Las etapas se dan de alta al arrancar; una etapa desconocida se ignora
+   virtual void observeStage(const std::string &stage, std::uint64_t micros) = 0;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+class IPasswordHashRepository {
+public:
+   // El pool de hashing esta saturado (la API responde 503)
+   class Busy : public std::runtime_error {
+   public:
+      using std::runtime_error::runtime_error;
+   };
+
+   virtual ~IPasswordHashRepository() = default;
+
+   // Hash con sal para guardar en users.password (incluye algoritmo y parametros)
+   virtual std::string hash(const std::string &password) = 0;
+
+   // Comparar un password contra lo guardado; acepta filas antiguas con el password en claro
+   virtual bool verify(const std::string &password, const std::string &stored) = 0;
+
+   // Lo guardado es texto plano o usa parametros mas debiles que los actuales
+   virtual bool needsRehash(const std::string &stored) const = 0;
+};
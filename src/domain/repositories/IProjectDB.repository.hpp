@@ -1,7 +1,11 @@
 #pragma once
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 #include "../entities/Repository.entity.hpp"
+#include "../entities/WrappedKey.entity.hpp"
+#include "../entities/ProtectedAlias.entity.hpp"
 
 class IProjectRepositoryDB {
 public:
@@ -22,8 +26,35 @@ public:
    virtual bool addUserToProject(int idProject, int idUser) = 0;
 
    /************* Tabla de passwords/usuarios para repositorios cifrados *************/
-   virtual bool addPassword_repo_user(int idUser, int idproject, std::string password, std::string projectAlias) = 0;
+   // keyGeneration: generacion activa del alias (la de las demas filas)
+   virtual bool addPassword_repo_user(int idUser, int idproject, std::string password, std::string projectAlias,
+                                      WrapAlgorithm algorithm = WrapAlgorithm::RSA_OAEP, std::uint32_t keyGeneration = 0) = 0;
+
+   // Todas las filas del alias en un solo INSERT dentro de una transaccion: o quedan todas o ninguna
+   virtual bool addPasswords_repo_users(int idproject, const std::string &projectAlias, const std::vector<WrappedKey> &wrappedKeys) = 0;
 
    virtual bool existsRepoAlias(const std::string &projectAlias) = 0;
 
+   // El usuario tiene una copia envuelta de la clave AES del alias (fila en repo_protect)
+   virtual bool existsKeyHolder(const std::string &projectAlias, int idUser) = 0;
+
+   // Filas del alias: usuario, clave envuelta y algoritmo con el que se envolvio
+   virtual std::vector<WrappedKey> findKeyHolders(const std::string &projectAlias) = 0;
+
+   virtual bool removeKeyHolder(const std::string &projectAlias, int idUser) = 0;
+
+   // Generacion de clave activa del alias (nullopt si no tiene filas)
+   virtual std::optional<std::uint32_t> findKeyGeneration(const std::string &projectAlias) = 0;
+
+   // Alias con filas en repo_protect y su generacion activa (recuperacion de re-cifrados interrumpidos)
+   virtual std::vector<ProtectedAlias> findProtectedAliases() = 0;
+
+   // Tras re-cifrar con otra clave: actualiza la clave envuelta y la generacion de cada fila que sigue
+   // existiendo (UPDATE por usuario en una transaccion, sin insertar). El commit es el que activa la
+   // generacion nueva. revokedUser (0 = ninguno) se borra en la misma transaccion: el acceso se quita
+   // justo cuando la clave cambia. Falla si el alias tiene otra fila que no esta en wrappedKeys: se
+   // quedaria con la clave anterior
+   virtual bool rewrapPasswords_repo_users(const std::string &projectAlias, std::uint32_t keyGeneration,
+                                           const std::vector<WrappedKey> &wrappedKeys, int revokedUser = 0) = 0;
+
 };
@@ -1,6 +1,9 @@
 #pragma once
 #include <optional>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include "../utils/ByteStream.hpp"
 
 class IProtectRepoCryptoRepository {
 public:
@@ -10,9 +13,53 @@ public:
 
    virtual bool cipher_AES_GCM(const std::string &filePath, const std::string &fileOutPath, const std::string &keyAES) = 0;
 
-   // esta probablemente no se use y la quite
+   // Cifra lo que escriba el productor directamente a fileOutPath (mismo formato que cipher_AES_GCM)
+   virtual bool cipherStream_AES_GCM(const ByteProducer &producer, const std::string &fileOutPath, const std::string &keyAES) = 0;
+
+   // Igual que cipherStream_AES_GCM, pero guarda cifrado dentro del archivo el indice que devuelve el productor
+   virtual bool cipherStreamIndexed_AES_GCM(const IndexedByteProducer &producer, const std::string &fileOutPath, const std::string &keyAES) = 0;
+
+   // Descifra y verifica solo el indice guardado en el archivo
+   virtual std::string readIndex_AES_GCM(const std::string &filePath, const std::string &keyAES) = 0;
+
+   // Emite los bytes [offset, offset + length) del contenido descifrado, descifrando solo los segmentos que los cubren
+   virtual void decipherRange_AES_GCM(const std::string &filePath, const std::string &keyAES,
+                                      std::uint64_t offset, std::uint64_t length, const ByteSink &out) = 0;
+
+   // Verdadero si el archivo guarda una lista de chunks en lugar del contenido (solo lee la cabecera, sin clave)
+   virtual bool isChunkList_AES_GCM(const std::string &filePath) = 0;
+
+   // Archivo segmentado normal reconstruido a partir de una lista de chunks (mismo contenido e indice, misma
+   // clave): su tamaño y sus bytes [offset, offset + length). Cada llamada reconstruye los mismos bytes
+   virtual std::uint64_t rebuiltSize_AES_GCM(const std::string &filePath, const std::string &keyAES) = 0;
+   virtual void readRebuilt_AES_GCM(const std::string &filePath, const std::string &keyAES,
+                                    std::uint64_t offset, std::uint64_t length, const ByteSink &out) = 0;
+
+   // Emite todo el contenido descifrado al sink, segmento a segmento y solo ya autenticado (formato segmentado)
+   virtual void decipherStream_AES_GCM(const std::string &filePath, const std::string &keyAES, const ByteSink &out) = 0;
+
+   // Verifica que la clave sea la del archivo descifrando solo el primer segmento (formato segmentado)
+   virtual bool verifyKey_AES_GCM(const std::string &filePath, const std::string &keyAES) = 0;
+
+   // Re-cifra el archivo con otra clave (conserva el indice) y escribe el resultado en fileOutPath
+   virtual bool rekey_AES_GCM(const std::string &filePath, const std::string &fileOutPath,
+                              const std::string &oldKeyAES, const std::string &newKeyAES) = 0;
+
+   // Acepta el formato segmentado y el formato anterior de un solo IV
    virtual bool decipher_AES_GCM(const std::string &filePath, const std::string &fileOutPath, const std::string &keyAES) = 0;
 
    virtual std::string cipher_RSA_OAEP(const std::string &plainText, const std::string &publicKeyRSA) = 0;
 
+   // El mismo texto para varias claves publicas, en paralelo; resultado en el orden de las claves ("" si una falla)
+   virtual std::vector<std::string> cipher_RSA_OAEP_many(const std::string &plainText, const std::vector<std::string> &publicKeysRSA) = 0;
+
+   // Validacion completa de una clave publica RSA (DER en Base64); se hace una vez, al subirla
+   virtual bool validate_RSA_PublicKey(const std::string &publicKeyRSA) = 0;
+
+   // ECIES: ECDH P-256 efimero + HKDF-SHA256 + AES-256-GCM con la clave publica EC del usuario (DER en Base64); "" si falla
+   virtual std::string cipher_ECIES(const std::string &plainText, const std::string &publicKeyEC) = 0;
+
+   // Como cipher_RSA_OAEP_many, con ECIES
+   virtual std::vector<std::string> cipher_ECIES_many(const std::string &plainText, const std::vector<std::string> &publicKeysEC) = 0;
+
 };
\ No newline at end of file
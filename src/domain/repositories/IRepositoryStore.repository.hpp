@@ -2,7 +2,14 @@
 #include <optional>
 #include <string>
 #include <filesystem>
+#include <cstdint>
+#include <vector>
 #include "../entities/Repository.entity.hpp"
+#include "../entities/ArchiveMember.entity.hpp"
+#include "../entities/StagedUpload.entity.hpp"
+#include "../entities/RepoManifest.entity.hpp"
+#include "../entities/ArchiveLayer.entity.hpp"
+#include "../utils/ByteStream.hpp"
 
 class IRepositoryStore {
 public:
@@ -22,6 +29,71 @@ public:
 
    virtual std::filesystem::path folderToTar(const std::string &name, const std::string &projectAlias) = 0;
 
+   // Escribe el tar.gz de la carpeta del repositorio directamente en el sink (sin archivos intermedios).
+   // Devuelve el indice de archivos (ruta → ubicacion en el tar.gz) serializado
+   virtual std::string folderToTarStream(const std::string &name, const ByteSink &out) = 0;
+
+   // Busca un archivo en un indice generado por folderToTarStream
+   virtual std::optional<ArchiveMember> findArchiveMember(const std::string &index, const std::string &path) = 0;
+
+   // Descomprime un archivo a partir de los bytes del tar.gz que lo cubren (compressedOffset, compressedLength)
+   virtual void inflateArchiveMember(const ArchiveMember &member, const ByteProducer &compressed, const ByteSink &out) = 0;
+
+   /****** Archivos de un alias protegido por generacion de clave (repo_protect.key_generation) ******/
+   // Cada re-cifrado escribe la cadena completa en la generacion siguiente y la activa al confirmar las
+   // filas en DB; la generacion 0 conserva los nombres sin sufijo: <repo>_<alias>.tar.enc, etc.
+
+   // Ruta del archivo cifrado <repo>_<alias>[.g<G>].tar.enc dentro de la carpeta de cifrados
+   virtual std::filesystem::path cipherFilePath(const std::string &name, const std::string &projectAlias, std::uint32_t generation) = 0;
+
+   /****** Snapshots incrementales: archivo base (snapshot 0) + deltas 1..N + manifiesto ******/
+
+   // Snapshot 0 es cipherFilePath; el delta N es <repo>_<alias>[.g<G>].d<N>.tar.enc
+   virtual std::filesystem::path snapshotFilePath(const std::string &name, const std::string &projectAlias,
+                                                  std::uint32_t generation, std::uint32_t snapshot) = 0;
+
+   // Ultimo delta presente en disco (0 si solo existe el archivo base)
+   virtual std::uint32_t lastSnapshot(const std::string &name, const std::string &projectAlias, std::uint32_t generation) = 0;
+
+   // <repo>_<alias>[.g<G>].manifest.enc (cifrado con la clave del alias)
+   virtual std::filesystem::path manifestFilePath(const std::string &name, const std::string &projectAlias, std::uint32_t generation) = 0;
+
+   // Borra los archivos de una generacion (base, deltas, manifiesto y temporales); devuelve cuantos borro
+   virtual std::size_t discardGeneration(const std::string &name, const std::string &projectAlias, std::uint32_t generation) = 0;
+
+   // Manifiesto actual de la carpeta. Solo se hashean los archivos cuyo tamaño o mtime no coinciden con
+   // `previous`; el resto conserva su hash (el costo depende de lo que cambio, no del tamaño del repo)
+   virtual RepoManifest scanRepository(const std::string &name, const RepoManifest &previous) = 0;
+
+   virtual std::string serializeManifest(const RepoManifest &manifest) = 0;
+
+   virtual RepoManifest parseManifest(const std::string &serialized) = 0;
+
+   // Como folderToTarStream, pero solo con las rutas de diff.changed; el indice devuelto agrega el numero
+   // de snapshot, el padre y los tombstones (diff.deleted)
+   virtual std::string deltaToTarStream(const std::string &name, const ManifestDiff &diff, std::uint32_t snapshot, const ByteSink &out) = 0;
+
+   // Tombstones del indice de un snapshot; lanza si el indice no es el del snapshot esperado
+   // (un delta renombrado o fuera de orden)
+   virtual std::vector<std::string> snapshotTombstones(const std::string &index, std::uint32_t snapshot) = 0;
+
+   // Emite los bytes [offset, offset + length) de un archivo cifrado, leyendo en bloques acotados
+   virtual void readCipherRange(const std::filesystem::path &cipherFile, std::uint64_t offset, std::uint64_t length, const ByteSink &out) = 0;
+
+   // Guarda en un temporal el tar.gz que emite el productor (subida por streaming) y calcula su SHA-256
+   virtual StagedUpload stageUpload(const std::string &name, const ByteProducer &producer) = 0;
+
+   // Extrae el tar.gz en una carpeta temporal y la intercambia de forma atomica con la del repositorio
+   virtual void replaceFolderFromArchive(const std::string &name, const std::filesystem::path &archivePath) = 0;
+
+   // Extrae en proceso los tar.gz de las capas (ej. descifrados en streaming), en orden y aplicando los
+   // tombstones de cada una, en una carpeta temporal que se instala de forma atomica como <root>/<name>;
+   // si algun productor falla no queda nada
+   virtual void extractArchiveStream(const std::string &name, const std::vector<ArchiveLayer> &layers) = 0;
+
+   // Elimina un temporal de subida
+   virtual void discardUpload(const StagedUpload &upload) = 0;
+
    virtual std::filesystem::path tarToFolder(const std::filesystem::path &tarPath) = 0;
 
 };
@@ -0,0 +1,19 @@
+#pragma once
+#include <optional>
+#include <string>
+#include "../entities/Principal.entity.hpp"
+#include "../entities/SessionToken.entity.hpp"
+
+class ISessionTokenRepository {
+public:
+   virtual ~ISessionTokenRepository() = default;
+
+   // Emitir un token de sesion para un usuario cuyo password ya se verifico
+   virtual SessionToken issue(const Principal &principal) = 0;
+
+   // Usuario de un token valido (firma correcta, sin expirar ni revocado); sin acceso a la BDD
+   virtual std::optional<Principal> resolve(const std::string &token) = 0;
+
+   // Cerrar la sesion del token; false si no existia
+   virtual bool revoke(const std::string &token) = 0;
+};
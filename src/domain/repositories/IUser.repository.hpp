@@ -1,13 +1,16 @@
 #pragma once
 #include <optional>
 #include <string>
+#include <vector>
 #include "../entities/User.entity.hpp"
+#include "../entities/UserSnapshot.entity.hpp"
+#include "../entities/WrappedKey.entity.hpp"
 
 class IUserRepository {
 public:
    virtual ~IUserRepository() = default;
 
-   virtual bool create(const std::string &name, const std::string &email, const std::string &password) = 0;
+   virtual bool create(const std::string &name, const std::string &email, const std::string &passwordHash) = 0;
 
    virtual bool addPublicKeyECDSA(const std::string &email, const std::string &publicKey) = 0;
 
@@ -17,7 +20,16 @@ public:
 
    virtual std::optional<User> findById(int idUser) = 0;
 
-   virtual bool isValidPassword(const std::string &email, const std::string &password) = 0;
+   // Todos los usuarios pedidos en una sola consulta; las reglas de un caso de uso se evaluan sobre el snapshot
+   virtual UserSnapshot loadSnapshot(const std::vector<std::string> &emails) = 0;
+
+   // Miembros del proyecto (users_has_projects) activos, verificados y con la clave publica del algoritmo (RSA o EC)
+   virtual std::vector<User> findProjectMembersWithWrapKey(int idProject, WrapAlgorithm algorithm) = 0;
+
+   // Lo guardado en users.password (hash; texto plano en filas anteriores al hash), nullopt si no existe el usuario
+   virtual std::optional<std::string> findPasswordHash(const std::string &email) = 0;
+
+   virtual bool updatePasswordHash(const std::string &email, const std::string &passwordHash) = 0;
 
    virtual bool isVerifiedUser(const std::string &email) = 0;
 
@@ -0,0 +1,83 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+// Un lock de lectura/escritura por alias protegido (<repo>_<alias>), compartido por los casos de uso
+// que tocan sus archivos cifrados o sus filas de repo_protect:
+//   exclusivo:  protect (completo e incremental), grant, revoke y revoke con re-cifrado
+//   compartido: lecturas que recorren la cadena de snapshots (extraer un archivo, descifrar la carpeta)
+//               y las verificaciones previas a encolar un re-cifrado
+// Las entradas se crean al pedir el lock y se borran cuando nadie lo tiene ni lo espera.
+class AliasLocks {
+   struct Entry {
+      std::shared_mutex mutex;
+      std::size_t users = 0;   // guards vivos o esperando (protegido por mutex_)
+   };
+
+public:
+   // Mantiene el lock mientras vive
+   class Guard {
+   public:
+      Guard(Guard &&other) noexcept
+         : locks_(other.locks_), alias_(std::move(other.alias_)), entry_(other.entry_), shared_(other.shared_) {
+         other.entry_ = nullptr;
+      }
+      Guard(const Guard &) = delete;
+      Guard &operator=(const Guard &) = delete;
+      Guard &operator=(Guard &&) = delete;
+
+      ~Guard() {
+         if (entry_ == nullptr) return;
+         if (shared_) entry_->mutex.unlock_shared();
+         else entry_->mutex.unlock();
+         locks_.release(alias_);
+      }
+
+   private:
+      friend class AliasLocks;
+      Guard(AliasLocks &locks, std::string alias, Entry *entry, bool shared)
+         : locks_(locks), alias_(std::move(alias)), entry_(entry), shared_(shared) {}
+
+      AliasLocks &locks_;
+      std::string alias_;
+      Entry *entry_;
+      bool shared_;
+   };
+
+   AliasLocks() = default;
+   AliasLocks(const AliasLocks &) = delete;
+   AliasLocks &operator=(const AliasLocks &) = delete;
+
+   Guard exclusive(const std::string &alias) {
+      Entry *entry = acquire(alias);
+      entry->mutex.lock();
+      return Guard(*this, alias, entry, false);
+   }
+
+   Guard shared(const std::string &alias) {
+      Entry *entry = acquire(alias);
+      entry->mutex.lock_shared();
+      return Guard(*this, alias, entry, true);
+   }
+
+private:
+   std::mutex mutex_;
+   std::map<std::string, std::unique_ptr<Entry>> entries_;
+
+   Entry *acquire(const std::string &alias) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::unique_ptr<Entry> &entry = entries_[alias];
+      if (!entry) entry = std::make_unique<Entry>();
+      entry->users++;
+      return entry.get();
+   }
+
+   void release(const std::string &alias) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = entries_.find(alias);
+      if (found != entries_.end() && --found->second->users == 0) entries_.erase(found);
+   }
+};
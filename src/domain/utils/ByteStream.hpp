@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Destino de bytes en streaming: recibe bloques conforme se producen
+using ByteSink = std::function<void(const char *data, std::size_t size)>;
+
+// Productor de bytes: escribe todo su contenido en el sink que recibe
+using ByteProducer = std::function<void(const ByteSink &sink)>;
+
+// Productor que ademas devuelve metadatos opacos al terminar (ej. indice de archivos)
+using IndexedByteProducer = std::function<std::string(const ByteSink &sink)>;
@@ -0,0 +1,235 @@
+// infrastructure/auth/SessionTokenStore.hpp
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <cryptopp/hmac.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/misc.h>
+#include "../../domain/repositories/ISessionToken.repository.hpp"
+
+// Sesiones en memoria con tokens firmados.
+//
+// Token: <id 32 hex>.<expira en segundos unix>.<HMAC-SHA256(id.expira) 64 hex>
+// La firma descarta tokens inventados o alterados sin tocar el mapa; la sesion viva (revocable)
+// se busca en un shard elegido por el id, cada uno con su mutex, para que las peticiones
+// concurrentes no compitan por un solo lock.
+//
+// Expiracion: cada shard tiene una rueda de tiempo (un slot por segundo). Un hilo de fondo
+// visita el slot del segundo actual y borra las sesiones vencidas; las que vencen en otra vuelta
+// de la rueda se quedan en el slot. La busqueda tambien compara la expiracion, asi que un token
+// vencido nunca se acepta aunque el barrido vaya atrasado.
+//
+// Las sesiones no sobreviven a un reinicio: con signingKey vacia se genera una clave por proceso.
+class SessionTokenStore : public ISessionTokenRepository {
+public:
+   SessionTokenStore(int ttlSeconds, std::size_t shards, const std::string &signingKey = "")
+      : ttlSeconds_(ttlSeconds), shards_(shards > 0 ? shards : 1) {
+      if (ttlSeconds_ <= 0)
+         throw std::runtime_error("Session TTL must be positive");
+
+      if (signingKey.empty()) {
+         key_.resize(KEY_SIZE);
+         CryptoPP::AutoSeededRandomPool rng;
+         rng.GenerateBlock(reinterpret_cast<CryptoPP::byte *>(&key_[0]), key_.size());
+      } else {
+         key_ = signingKey;
+      }
+
+      lastTick_ = nowSeconds();
+      sweeper_ = std::thread([this] { sweepLoop(); });
+   }
+
+   SessionTokenStore(const SessionTokenStore &) = delete;
+   SessionTokenStore &operator=(const SessionTokenStore &) = delete;
+
+   ~SessionTokenStore() override {
+      {
+         std::lock_guard<std::mutex> lock(stopMutex_);
+         stopping_ = true;
+      }
+      stopCv_.notify_all();
+      sweeper_.join();
+   }
+
+   SessionToken issue(const Principal &principal) override {
+      std::string id = randomId();
+      std::int64_t expiresAt = nowSeconds() + ttlSeconds_;
+      std::string payload = id + "." + std::to_string(expiresAt);
+
+      Shard &shard = shardFor(id);
+      {
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         shard.sessions[id] = Session{principal, expiresAt};
+         shard.wheel[slotOf(expiresAt)].push_back(id);
+      }
+      active_.fetch_add(1, std::memory_order_relaxed);
+
+      return SessionToken{payload + "." + sign(payload), expiresAt, ttlSeconds_};
+   }
+
+   std::optional<Principal> resolve(const std::string &token) override {
+      std::optional<Parsed> parsed = parse(token);
+      if (!parsed.has_value() || parsed->expiresAt <= nowSeconds())
+         return std::nullopt;
+
+      Shard &shard = shardFor(parsed->id);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto found = shard.sessions.find(parsed->id);
+      if (found == shard.sessions.end() || found->second.expiresAt <= nowSeconds())
+         return std::nullopt;
+      return found->second.principal;
+   }
+
+   bool revoke(const std::string &token) override {
+      std::optional<Parsed> parsed = parse(token);
+      if (!parsed.has_value())
+         return false;
+
+      // el id queda en su slot de la rueda; el barrido lo ignora al no encontrarlo
+      Shard &shard = shardFor(parsed->id);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (shard.sessions.erase(parsed->id) == 0)
+         return false;
+      active_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+   }
+
+   std::size_t activeSessions() const { return active_.load(std::memory_order_relaxed); }
+
+private:
+   static constexpr std::size_t KEY_SIZE = 32;
+   static constexpr std::size_t ID_SIZE = 16;
+   static constexpr std::size_t WHEEL_SLOTS = 512;   // un slot por segundo
+
+   struct Session {
+      Principal principal;
+      std::int64_t expiresAt;
+   };
+
+   struct Shard {
+      std::mutex mutex;
+      std::unordered_map<std::string, Session> sessions;
+      std::array<std::vector<std::string>, WHEEL_SLOTS> wheel;
+   };
+
+   struct Parsed {
+      std::string id;
+      std::int64_t expiresAt;
+   };
+
+   int ttlSeconds_;
+   std::vector<Shard> shards_;
+   std::string key_;
+   std::atomic<std::size_t> active_{0};
+
+   std::int64_t lastTick_;                 // ultimo segundo barrido (solo lo usa el hilo de fondo)
+   std::mutex stopMutex_;
+   std::condition_variable stopCv_;
+   bool stopping_ = false;
+   std::thread sweeper_;
+
+   static std::int64_t nowSeconds() {
+      return std::chrono::duration_cast<std::chrono::seconds>(
+         std::chrono::system_clock::now().time_since_epoch()).count();
+   }
+
+   static std::size_t slotOf(std::int64_t second) {
+      return static_cast<std::size_t>(second) % WHEEL_SLOTS;
+   }
+
+   Shard &shardFor(const std::string &id) {
+      // el id es aleatorio: sus primeros hex ya reparten uniforme
+      return shards_[std::stoul(id.substr(0, 8), nullptr, 16) % shards_.size()];
+   }
+
+   static std::string toHex(const unsigned char *data, std::size_t size) {
+      static const char digits[] = "0123456789abcdef";
+      std::string out(size * 2, '0');
+      for (std::size_t i = 0; i < size; ++i) {
+         out[2 * i] = digits[data[i] >> 4];
+         out[2 * i + 1] = digits[data[i] & 0x0f];
+      }
+      return out;
+   }
+
+   static std::string randomId() {
+      thread_local CryptoPP::AutoSeededRandomPool rng;
+      unsigned char bytes[ID_SIZE];
+      rng.GenerateBlock(bytes, sizeof(bytes));
+      return toHex(bytes, sizeof(bytes));
+   }
+
+   std::string sign(const std::string &payload) const {
+      CryptoPP::HMAC<CryptoPP::SHA256> hmac(reinterpret_cast<const CryptoPP::byte *>(key_.data()), key_.size());
+      unsigned char mac[CryptoPP::SHA256::DIGESTSIZE];
+      hmac.CalculateDigest(mac, reinterpret_cast<const CryptoPP::byte *>(payload.data()), payload.size());
+      return toHex(mac, sizeof(mac));
+   }
+
+   // Separa y verifica la firma (comparacion en tiempo constante); nullopt si el formato no es valido
+   std::optional<Parsed> parse(const std::string &token) const {
+      std::size_t firstDot = token.find('.');
+      std::size_t secondDot = firstDot == std::string::npos ? std::string::npos : token.find('.', firstDot + 1);
+      if (firstDot != ID_SIZE * 2 || secondDot == std::string::npos || secondDot - firstDot < 2 || secondDot - firstDot > 20)
+         return std::nullopt;
+
+      std::string payload = token.substr(0, secondDot);
+      std::string mac = token.substr(secondDot + 1);
+      std::string expected = sign(payload);
+      if (mac.size() != expected.size() ||
+          !CryptoPP::VerifyBufsEqual(reinterpret_cast<const CryptoPP::byte *>(mac.data()),
+                                     reinterpret_cast<const CryptoPP::byte *>(expected.data()), mac.size()))
+         return std::nullopt;
+
+      // con la firma valida el formato ya lo genero issue()
+      Parsed parsed;
+      parsed.id = token.substr(0, firstDot);
+      parsed.expiresAt = std::stoll(token.substr(firstDot + 1, secondDot - firstDot - 1));
+      return parsed;
+   }
+
+   void sweepLoop() {
+      std::unique_lock<std::mutex> lock(stopMutex_);
+      while (!stopCv_.wait_for(lock, std::chrono::seconds(1), [this] { return stopping_; })) {
+         lock.unlock();
+         // recuperar los segundos perdidos si el hilo se atraso (como mucho una vuelta de la rueda)
+         std::int64_t now = nowSeconds();
+         std::int64_t from = std::max(lastTick_ + 1, now - static_cast<std::int64_t>(WHEEL_SLOTS) + 1);
+         for (std::int64_t tick = from; tick <= now; ++tick) sweepSlot(tick, now);
+         lastTick_ = now;
+         lock.lock();
+      }
+   }
+
+   void sweepSlot(std::int64_t tick, std::int64_t now) {
+      for (Shard &shard : shards_) {
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         std::vector<std::string> &slot = shard.wheel[slotOf(tick)];
+         std::vector<std::string> pending;
+         for (std::string &id : slot) {
+            auto found = shard.sessions.find(id);
+            if (found == shard.sessions.end()) continue;   // revocada
+            if (found->second.expiresAt <= now) {
+               shard.sessions.erase(found);
+               active_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+               pending.push_back(std::move(id));            // vence en otra vuelta de la rueda
+            }
+         }
+         slot.swap(pending);
+      }
+   }
+};
@@ -0,0 +1,150 @@
+// infrastructure/cache/ShardedLruCache.hpp
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Cache LRU acotada, con vigencia (TTL) y repartida en shards con su propio mutex,
+// para que las busquedas concurrentes no compitan por un solo lock.
+//
+// Capacidad total = capacity (se reparte entre los shards); capacity 0 desactiva la cache
+// (get siempre falla, put no guarda). Las entradas vencidas se descartan al buscarlas.
+//
+// Lecturas a traves de la cache (read-through) sin carreras con las escrituras:
+//    auto ticket = cache.ticket(key);      // antes de leer la fuente
+//    Value value = load(key);
+//    cache.put(key, value, ticket);        // se descarta si hubo un erase() del shard entre medio
+// asi un valor leido antes de una escritura no reemplaza a la invalidacion que la siguio.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+   using Clock = std::chrono::steady_clock;
+
+   ShardedLruCache(std::size_t capacity, std::size_t shards, std::chrono::milliseconds ttl)
+      : shards_(shards > 0 ? shards : 1), ttl_(ttl) {
+      perShard_ = capacity == 0 ? 0 : std::max<std::size_t>(1, capacity / shards_.size());
+   }
+
+   ShardedLruCache(const ShardedLruCache &) = delete;
+   ShardedLruCache &operator=(const ShardedLruCache &) = delete;
+
+   bool enabled() const { return perShard_ > 0; }
+
+   std::optional<Value> get(const Key &key) {
+      if (!enabled()) return std::nullopt;
+
+      Shard &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto found = shard.index.find(key);
+      if (found == shard.index.end()) {
+         misses_.fetch_add(1, std::memory_order_relaxed);
+         return std::nullopt;
+      }
+      if (found->second->expiresAt <= Clock::now()) {
+         shard.lru.erase(found->second);
+         shard.index.erase(found);
+         misses_.fetch_add(1, std::memory_order_relaxed);
+         return std::nullopt;
+      }
+      // mas reciente al frente
+      shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return found->second->value;
+   }
+
+   // Generacion del shard de la clave; se pasa a put() despues de leer la fuente
+   std::uint64_t ticket(const Key &key) {
+      Shard &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      return shard.generation;
+   }
+
+   // Guarda el valor si el shard no se invalido desde ticket(); true si quedo guardado
+   bool put(const Key &key, Value value, std::uint64_t ticket) {
+      if (!enabled()) return false;
+
+      Shard &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (shard.generation != ticket) return false;
+
+      Clock::time_point expiresAt = Clock::now() + ttl_;
+      auto found = shard.index.find(key);
+      if (found != shard.index.end()) {
+         found->second->value = std::move(value);
+         found->second->expiresAt = expiresAt;
+         shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+         return true;
+      }
+
+      shard.lru.push_front(Entry{key, std::move(value), expiresAt});
+      shard.index.emplace(key, shard.lru.begin());
+      if (shard.lru.size() > perShard_) {
+         shard.index.erase(shard.lru.back().key);   // la menos usada
+         shard.lru.pop_back();
+         evictions_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return true;
+   }
+
+   // Guarda sin control de generacion (valores que no dependen de escrituras concurrentes)
+   bool put(const Key &key, Value value) {
+      return put(key, std::move(value), ticket(key));
+   }
+
+   // Invalida la clave; las lecturas en curso del mismo shard no la vuelven a guardar
+   void erase(const Key &key) {
+      Shard &shard = shardFor(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      ++shard.generation;
+      auto found = shard.index.find(key);
+      if (found == shard.index.end()) return;
+      shard.lru.erase(found->second);
+      shard.index.erase(found);
+   }
+
+   std::size_t size() const {
+      std::size_t total = 0;
+      for (const Shard &shard : shards_) {
+         std::lock_guard<std::mutex> lock(shard.mutex);
+         total += shard.lru.size();
+      }
+      return total;
+   }
+
+   std::uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+   std::uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+   std::uint64_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+
+private:
+   struct Entry {
+      Key key;
+      Value value;
+      Clock::time_point expiresAt;
+   };
+
+   struct Shard {
+      mutable std::mutex mutex;
+      std::list<Entry> lru;                                                   // frente: mas reciente
+      std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+      std::uint64_t generation = 0;                                           // sube con cada erase()
+   };
+
+   std::vector<Shard> shards_;
+   std::size_t perShard_;
+   Clock::duration ttl_;
+   std::atomic<std::uint64_t> hits_{0};
+   std::atomic<std::uint64_t> misses_{0};
+   std::atomic<std::uint64_t> evictions_{0};
+
+   Shard &shardFor(const Key &key) {
+      return shards_[Hash{}(key) % shards_.size()];
+   }
+};
@@ -0,0 +1,158 @@
+// infrastructure/concurrency/JobQueue.hpp
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "ThreadPool.hpp"
+
+// Cola de trabajos en segundo plano con estado consultable (para operaciones largas como /repo/protect).
+// - Los trabajos corren en un ThreadPool propio, separado de los workers HTTP.
+// - Como mucho maxQueued trabajos esperando: enqueue() devuelve nullopt si la cola esta llena.
+// - El estado de un trabajo terminado se conserva resultTtl para que el cliente lo consulte;
+//   los vencidos se purgan en cada enqueue()/status().
+class JobQueue {
+public:
+   enum class State { Queued, Running, Done, Failed };
+
+   struct Status {
+      std::string id;
+      State state;
+      std::string result;   // valor devuelto por el trabajo (si Done)
+      std::string error;    // mensaje de la excepcion (si Failed)
+   };
+
+   JobQueue(std::size_t workers, std::size_t maxQueued, std::chrono::seconds resultTtl)
+      : maxQueued_(maxQueued ? maxQueued : 1), resultTtl_(resultTtl), pool_(workers) {}
+
+   JobQueue(const JobQueue &) = delete;
+   JobQueue &operator=(const JobQueue &) = delete;
+
+   // Encolar un trabajo; devuelve su id o nullopt si la cola esta llena
+   std::optional<std::string> enqueue(std::function<std::string()> task) {
+      std::string id;
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         purgeExpired(Clock::now());
+         if (queued_ >= maxQueued_) return std::nullopt;
+
+         id = newId();
+         jobs_[id] = Job{State::Queued, "", "", Clock::time_point{}};
+         ++queued_;
+      }
+
+      try {
+         pool_.submit([this, id, task = std::move(task)] { run(id, task); });
+      } catch (...) {
+         std::lock_guard<std::mutex> lock(mutex_);
+         jobs_.erase(id);
+         --queued_;
+         throw;
+      }
+      return id;
+   }
+
+   // Estado de un trabajo; nullopt si no existe o ya vencio
+   std::optional<Status> status(const std::string &id) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      purgeExpired(Clock::now());
+
+      auto found = jobs_.find(id);
+      if (found == jobs_.end()) return std::nullopt;
+      return Status{id, found->second.state, found->second.result, found->second.error};
+   }
+
+   // Trabajos esperando un hilo
+   std::size_t queued() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return queued_;
+   }
+
+   static const char *stateName(State state) {
+      switch (state) {
+         case State::Queued:  return "queued";
+         case State::Running: return "running";
+         case State::Done:    return "done";
+         case State::Failed:  return "failed";
+      }
+      return "unknown";
+   }
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Job {
+      State state;
+      std::string result;
+      std::string error;
+      Clock::time_point finishedAt;
+   };
+
+   std::size_t maxQueued_;
+   std::chrono::seconds resultTtl_;
+
+   mutable std::mutex mutex_;
+   std::unordered_map<std::string, Job> jobs_;
+   std::size_t queued_ = 0;
+   std::random_device idSource_;
+
+   // Declarado al final: se destruye primero y espera a los trabajos en curso
+   ThreadPool pool_;
+
+   void run(const std::string &id, const std::function<std::string()> &task) {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         --queued_;
+         jobs_[id].state = State::Running;
+      }
+
+      State state = State::Done;
+      std::string result, error;
+      try {
+         result = task();
+      } catch (const std::exception &e) {
+         state = State::Failed;
+         error = e.what();
+      } catch (...) {
+         state = State::Failed;
+         error = "Unknown error";
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      Job &job = jobs_[id];
+      job.state = state;
+      job.result = std::move(result);
+      job.error = std::move(error);
+      job.finishedAt = Clock::now();
+   }
+
+   void purgeExpired(Clock::time_point now) {
+      for (auto it = jobs_.begin(); it != jobs_.end();) {
+         bool finished = it->second.state == State::Done || it->second.state == State::Failed;
+         if (finished && now - it->second.finishedAt > resultTtl_) it = jobs_.erase(it);
+         else ++it;
+      }
+   }
+
+   // Id de 128 bits en hex tomados de std::random_device (entropia del sistema): no es predecible
+   // a partir de otros ids, asi que solo quien encolo el trabajo puede consultar su resultado
+   std::string newId() {
+      static const char hex[] = "0123456789abcdef";
+      std::string id;
+      do {
+         id.clear();
+         for (int part = 0; part < 4; ++part) {
+            std::uint32_t value = idSource_();
+            for (int i = 0; i < 8; ++i) {
+               id += hex[value & 0xF];
+               value >>= 4;
+            }
+         }
+      } while (jobs_.count(id));
+      return id;
+   }
+};
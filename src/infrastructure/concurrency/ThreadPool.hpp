@@ -0,0 +1,76 @@
+// infrastructure/concurrency/ThreadPool.hpp
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Pool de hilos de tamaño fijo para trabajo CPU (compresion, cifrado...).
+// submit() devuelve un std::future con el resultado (o la excepcion) de la tarea.
+class ThreadPool {
+public:
+   explicit ThreadPool(std::size_t threads) {
+      if (threads == 0) threads = 1;
+      workers_.reserve(threads);
+      for (std::size_t i = 0; i < threads; ++i) {
+         workers_.emplace_back([this] { workerLoop(); });
+      }
+   }
+
+   ThreadPool(const ThreadPool &) = delete;
+   ThreadPool &operator=(const ThreadPool &) = delete;
+
+   ~ThreadPool() {
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         stopping_ = true;
+      }
+      cv_.notify_all();
+      for (auto &worker : workers_) worker.join();
+   }
+
+   template <class F>
+   auto submit(F &&task) -> std::future<typename std::invoke_result<F>::type> {
+      using Result = typename std::invoke_result<F>::type;
+
+      auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+      std::future<Result> result = packaged->get_future();
+      {
+         std::lock_guard<std::mutex> lock(mutex_);
+         if (stopping_)
+            throw std::runtime_error("ThreadPool is shutting down");
+         tasks_.emplace_back([packaged] { (*packaged)(); });
+      }
+      cv_.notify_one();
+      return result;
+   }
+
+   std::size_t size() const { return workers_.size(); }
+
+private:
+   std::vector<std::thread> workers_;
+   std::deque<std::function<void()>> tasks_;
+   std::mutex mutex_;
+   std::condition_variable cv_;
+   bool stopping_ = false;
+
+   void workerLoop() {
+      for (;;) {
+         std::function<void()> task;
+         {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+         }
+         task();
+      }
+   }
+};
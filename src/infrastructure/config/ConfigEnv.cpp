@@ -5,17 +5,20 @@
 
 namespace {
    std::string getEnvOrThrow(const char *name, const std::string &def = "") {
-      const char *value = dotenv::getenv(name, def).c_str();
-      if (!value) {
-         throw std::runtime_error(std::string("Missing env variable: ") + name);
-      }
-      return std::string(value);
+      // Copiar el valor antes de usarlo (c_str() de un temporal queda colgando)
+      std::string value = dotenv::getenv(name, def);
+      return value;
    }
 
    int getEnvIntOrThrow(const char *name, const std::string &def = "") {
       auto s = getEnvOrThrow(name, def);
       return std::stoi(s);
    }
+
+   std::uint64_t getEnvSizeOrThrow(const char *name, const std::string &def = "") {
+      auto s = getEnvOrThrow(name, def);
+      return std::stoull(s);
+   }
 }
 
 ConfigEnv loadConfigFromEnv() {
@@ -36,6 +39,42 @@ ConfigEnv loadConfigFromEnv() {
 
    cfg.repositoriesRoot = getEnvOrThrow("REPOSITORIES_ROOT");
    cfg.repositoriesCipher = getEnvOrThrow("REPOSITORIES_CIPHER");
+   cfg.cipherBufferSize = static_cast<std::size_t>(getEnvIntOrThrow("CIPHER_BUFFER_SIZE", "1048576"));
+   cfg.cipherSegmentSize = static_cast<std::size_t>(getEnvIntOrThrow("CIPHER_SEGMENT_SIZE", "1048576"));
+   cfg.cipherThreads = getEnvIntOrThrow("CIPHER_THREADS", "0");
+   cfg.cipherSuite = getEnvOrThrow("CIPHER_SUITE", "auto");
+   cfg.cipherSelfTestBytes = static_cast<std::size_t>(getEnvSizeOrThrow("CIPHER_SELFTEST_BYTES", "67108864"));
+   cfg.chunkStoreEnabled = getEnvIntOrThrow("CHUNK_STORE_ENABLED", "0") != 0;
+   cfg.chunkStoreKey = getEnvOrThrow("CHUNK_STORE_KEY", "");
+   cfg.chunkAvgSize = static_cast<std::size_t>(getEnvSizeOrThrow("CHUNK_AVG_SIZE", "65536"));
+   cfg.randomReseedBytes = getEnvSizeOrThrow("RANDOM_RESEED_BYTES", "1048576");
+   cfg.randomReseedSeconds = getEnvIntOrThrow("RANDOM_RESEED_SECONDS", "60");
+   cfg.compressThreads = getEnvIntOrThrow("COMPRESS_THREADS", "0");
+   cfg.compressBlockSize = static_cast<std::size_t>(getEnvIntOrThrow("COMPRESS_BLOCK_SIZE", "1048576"));
+   cfg.pushMaxBytes = getEnvSizeOrThrow("PUSH_MAX_BYTES", "1073741824");
+   cfg.protectWorkers = getEnvIntOrThrow("PROTECT_WORKERS", "1");
+   cfg.protectQueueMax = getEnvIntOrThrow("PROTECT_QUEUE_MAX", "16");
+   cfg.protectJobTtlSeconds = getEnvIntOrThrow("PROTECT_JOB_TTL_SECONDS", "3600");
+
+   // Hash de passwords
+   cfg.passwordHashIterations = getEnvIntOrThrow("PASSWORD_HASH_ITERATIONS", "600000");
+   cfg.passwordHashThreads = getEnvIntOrThrow("PASSWORD_HASH_THREADS", "2");
+   cfg.passwordHashQueueMax = getEnvIntOrThrow("PASSWORD_HASH_QUEUE_MAX", "64");
+
+   // Sesiones
+   cfg.sessionTtlSeconds = getEnvIntOrThrow("SESSION_TTL_SECONDS", "900");
+   cfg.sessionStoreShards = getEnvIntOrThrow("SESSION_STORE_SHARDS", "16");
+   cfg.sessionSigningKey = getEnvOrThrow("SESSION_SIGNING_KEY", "");
+
+   // Cache de usuarios
+   cfg.userCacheCapacity = getEnvIntOrThrow("USER_CACHE_CAPACITY", "10000");
+   cfg.userCacheShards = getEnvIntOrThrow("USER_CACHE_SHARDS", "16");
+   cfg.userCacheTtlSeconds = getEnvIntOrThrow("USER_CACHE_TTL_SECONDS", "30");
+
+   // Logger
+   cfg.logLevel = getEnvOrThrow("LOG_LEVEL", "info");
+   cfg.logRingSize = static_cast<std::size_t>(getEnvIntOrThrow("LOG_RING_SIZE", "4096"));
+   cfg.logOverflow = getEnvOrThrow("LOG_OVERFLOW", "drop");
 
    // Configuracion de la base de datos
    cfg.dbHost = getEnvOrThrow("DB_HOST");
@@ -44,5 +83,9 @@ ConfigEnv loadConfigFromEnv() {
    cfg.dbUser = getEnvOrThrow("DB_USER");
    cfg.dbPassword = getEnvOrThrow("DB_PASSWORD");
 
+   // Pool de sesiones SOCI
+   cfg.dbPoolSize = getEnvIntOrThrow("DB_POOL_SIZE", "8");
+   cfg.dbPoolTimeoutMs = getEnvIntOrThrow("DB_POOL_TIMEOUT_MS", "5000");
+
    return cfg;
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <cstddef>
+#include <cstdint>
 
 struct ConfigEnv {
 
@@ -15,12 +17,72 @@ struct ConfigEnv {
    std::string repositoriesRoot;
    std::string repositoriesCipher;
 
+   // Tamaño del bloque (bytes) para cifrar/descifrar archivos por streaming
+   std::size_t cipherBufferSize;
+
+   // Formato segmentado de los .tar.enc: bytes por segmento e hilos para cifrar (0 = nucleos disponibles)
+   std::size_t cipherSegmentSize;
+   int cipherThreads;
+
+   // Suite de los .tar.enc nuevos (auto | aes-256-gcm | chacha20-poly1305) y bytes que se cifran
+   // al arrancar para medir su rendimiento en el log (0 = no medir)
+   std::string cipherSuite;
+   std::size_t cipherSelfTestBytes;
+
+   // Almacen deduplicado de chunks para los .tar.enc (0 = archivos completos), clave para ids y
+   // claves de chunk (vacia = una por proceso, sin deduplicar entre reinicios) y tamaño promedio de chunk
+   bool chunkStoreEnabled;
+   std::string chunkStoreKey;
+   std::size_t chunkAvgSize;
+
+   // Generador aleatorio por hilo: se vuelve a sembrar desde el SO cada tantos bytes o segundos
+   std::uint64_t randomReseedBytes;
+   int randomReseedSeconds;
+
+   // Compresion de los tar: hilos (0 = nucleos disponibles) y tamaño de bloque en bytes
+   int compressThreads;
+   std::size_t compressBlockSize;
+
+   // Tamaño maximo (bytes) de un push de repositorio por streaming
+   std::uint64_t pushMaxBytes;
+
+   // Cola de trabajos de /repo/protect: hilos, trabajos en espera y segundos que se conserva el resultado
+   int protectWorkers;
+   int protectQueueMax;
+   int protectJobTtlSeconds;
+
+   // Hash de passwords (PBKDF2-HMAC-SHA256): iteraciones, hilos del pool de hashing y tareas en espera
+   int passwordHashIterations;
+   int passwordHashThreads;
+   int passwordHashQueueMax;
+
+   // Sesiones: vigencia del token, shards del almacen en memoria y clave HMAC
+   // (vacia = clave aleatoria por proceso; los tokens no sobreviven a un reinicio)
+   int sessionTtlSeconds;
+   int sessionStoreShards;
+   std::string sessionSigningKey;
+
+   // Cache de usuarios de DBUserRepository: entradas maximas (0 = sin cache), shards y vigencia
+   int userCacheCapacity;
+   int userCacheShards;
+   int userCacheTtlSeconds;
+
+   // Logger asincrono: nivel minimo (debug|info|warn|error), registros por ring de hilo
+   // y que hacer con el ring lleno (drop: descartar, block: esperar)
+   std::string logLevel;
+   std::size_t logRingSize;
+   std::string logOverflow;
+
    // Configuracion de la base de datos
    std::string dbHost;
    int dbPort;
    std::string dbName;
    std::string dbUser;
    std::string dbPassword;
+
+   // Pool de sesiones de la base de datos (dimensionar contra los workers de httplib)
+   int dbPoolSize;
+   int dbPoolTimeoutMs;
 };
 
 // Función que lee desde variables de entorno
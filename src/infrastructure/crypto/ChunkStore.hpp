@@ -0,0 +1,453 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <unistd.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/hmac.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/sha.h>
+#include "SegmentedAead.hpp"
+#include "../concurrency/ThreadPool.hpp"
+#include "../logging/Log.hpp"
+#include "../storage/FastCdc.hpp"
+#include "../storage/FileSync.hpp"
+#include "../../domain/utils/ByteStream.hpp"
+
+// Almacen de chunks por contenido para los .tar.enc (CHUNK_STORE_ENABLED).
+// Los cortes se hacen antes de comprimir: FilesystemStorage parte el tar sin comprimir con FastCDC
+// y comprime cada tramo como un bloque gzip independiente (ver ParallelGzipWriter), que llega en
+// una sola escritura. Cada escritura es un chunk, asi que un mismo tramo del tar da el mismo chunk
+// en cualquier alias o snapshot y una insercion solo cambia los chunks vecinos. Cada chunk distinto
+// se cifra y se escribe una sola vez en <root>/<2 hex>/<id>. El .tar.enc
+// queda como un archivo segmentado con FLAG_CHUNKS cuyo texto plano (sellado con la clave del
+// alias) es la lista de chunks: registros de RECORD_SIZE bytes id (32) | clave (32) | tamaño (4, BE).
+//
+//   h     = SHA-256(chunk)
+//   id    = HMAC-SHA256(secreto, "chunk-id"  || h)   nombre del archivo
+//   clave = HMAC-SHA256(secreto, "chunk-key" || h)   solo aparece dentro de las listas selladas
+//
+// La clave sale del contenido, asi que el mismo chunk se cifra igual en todos los alias (eso es
+// lo que permite deduplicar) y cada clave cifra un solo texto: el nonce fijo en ceros no se
+// reutiliza con otro mensaje. El secreto evita que alguien con acceso al disco confirme si un
+// contenido que adivina esta guardado. Sin la lista (clave del alias) los chunks no se descifran.
+//
+// Archivo de un chunk: cabecera segmentada (prefijo de nonce en ceros, tamaño de segmento = tamaño
+// del chunk) || un segmento sellado con indice 0 y final = 1.
+class ChunkStore {
+   // Registro de lista de un chunk y si hubo que escribirlo (ver put)
+   struct StoredChunk {
+      std::string record;
+      bool written = false;
+      std::uint64_t fileSize = 0;
+   };
+
+public:
+   static constexpr std::size_t ID_SIZE = 32;
+   static constexpr std::size_t KEY_SIZE = 32;
+   static constexpr std::size_t RECORD_SIZE = ID_SIZE + KEY_SIZE + 4;
+
+   struct Stats {
+      std::uint64_t storedChunks;       // archivos de chunk en el almacen
+      std::uint64_t storedBytes;        // bytes en disco del almacen
+      std::uint64_t chunksWritten;      // desde el arranque: chunks nuevos
+      std::uint64_t chunksDeduplicated; // desde el arranque: chunks que ya estaban
+      std::uint64_t logicalBytes;       // desde el arranque: bytes de tar.gz recibidos
+      std::uint64_t writtenBytes;       // desde el arranque: bytes escritos al almacen
+      double dedupRatio;                // logicalBytes / writtenBytes (1 sin escrituras)
+   };
+
+   // Resultado de un stream (un snapshot)
+   struct Summary {
+      std::uint64_t chunks = 0;
+      std::uint64_t newChunks = 0;
+      std::uint64_t logicalBytes = 0;
+      std::uint64_t writtenBytes = 0;
+   };
+
+   // root: directorio de los chunks (se crea si no existe)
+   // secret: clave para ids y claves de chunk; vacia = una aleatoria por proceso (los chunks
+   //         siguen leyendose tras un reinicio, pero no se deduplican con los escritos antes)
+   // averageSize: tamaño promedio de chunk (ver FastCdc)
+   // suite: AEAD de los chunks nuevos (ver CipherSuite::select); se leen ambas suites
+   ChunkStore(const std::string &root, const std::string &secret, std::size_t averageSize, bool enabled,
+              ThreadPool &pool, std::uint8_t suite = SegmentedAead::SUITE_AES_256_GCM)
+      : root_(root), cdc_(averageSize), enabled_(enabled), pool_(pool), suite_(suite) {
+      if (!SegmentedAead::isSupportedSuite(suite_))
+         throw std::runtime_error("Unsupported cipher suite: " + std::to_string(suite_));
+
+      if (secret.empty()) {
+         secret_.resize(KEY_SIZE);
+         CryptoPP::AutoSeededRandomPool rng;
+         rng.GenerateBlock(reinterpret_cast<CryptoPP::byte *>(&secret_[0]), secret_.size());
+         if (enabled_)
+            Log::warn("CHUNK_STORE_KEY is empty: chunks are not deduplicated across restarts");
+      } else {
+         secret_ = secret;
+      }
+
+      if (enabled_) {
+         std::filesystem::create_directories(root_);
+         scan();
+      }
+   }
+
+   ChunkStore(const ChunkStore &) = delete;
+   ChunkStore &operator=(const ChunkStore &) = delete;
+
+   bool enabled() const { return enabled_; }
+
+
+   // Cada escritura es un chunk (una escritura mas grande que el maximo de FastCdc se parte por
+   // contenido); guarda los que faltan (en paralelo en el pool) y escribe al sink los registros de
+   // la lista en orden. Como mucho 2*hilos+1 chunks en memoria
+   class Writer {
+   public:
+      Writer(ChunkStore &store, ByteSink recipe)
+         : store_(store), recipe_(std::move(recipe)), maxInFlight_(2 * store.pool_.size() + 1) {}
+
+      Writer(const Writer &) = delete;
+      Writer &operator=(const Writer &) = delete;
+
+      ~Writer() {
+         for (auto &pending : inFlight_) {
+            if (pending.valid()) pending.wait();
+         }
+      }
+
+      void write(const char *data, std::size_t size) {
+         if (finished_)
+            throw std::runtime_error("Chunk stream already finished");
+         while (size > 0) {
+            std::size_t length = size > store_.cdc_.maxSize() ? store_.cdc_.cut(data, size) : size;
+            emitChunk(data, length);
+            data += length;
+            size -= length;
+         }
+      }
+
+      Summary finish() {
+         if (finished_)
+            throw std::runtime_error("Chunk stream already finished");
+         while (!inFlight_.empty()) emitOldest();
+         finished_ = true;
+         return summary_;
+      }
+
+      ByteSink sink() {
+         return [this](const char *data, std::size_t size) { write(data, size); };
+      }
+
+   private:
+      ChunkStore &store_;
+      ByteSink recipe_;
+      std::size_t maxInFlight_;
+      std::deque<std::future<StoredChunk>> inFlight_;
+      Summary summary_;
+      bool finished_ = false;
+
+      void emitChunk(const char *data, std::size_t length) {
+         auto chunk = std::make_shared<std::string>(data, length);
+
+         ChunkStore *store = &store_;
+         inFlight_.push_back(store_.pool_.submit([store, chunk] { return store->put(*chunk); }));
+         while (inFlight_.size() >= maxInFlight_) emitOldest();
+      }
+
+      void emitOldest() {
+         StoredChunk stored = inFlight_.front().get();
+         inFlight_.pop_front();
+         recipe_(stored.record.data(), stored.record.size());
+
+         std::uint64_t size = recordSize(stored.record.data());
+         summary_.chunks++;
+         summary_.logicalBytes += size;
+         if (stored.written) {
+            summary_.newChunks++;
+            summary_.writtenBytes += stored.fileSize;
+         }
+      }
+   };
+
+
+   // Tamaño del texto plano que describe una lista
+   static std::uint64_t logicalSize(const std::string &recipe) {
+      checkRecipe(recipe);
+      std::uint64_t total = 0;
+      for (std::size_t pos = 0; pos < recipe.size(); pos += RECORD_SIZE)
+         total += recordSize(recipe.data() + pos);
+      return total;
+   }
+
+   // Emite [offset, offset + length) del texto plano de una lista: solo se leen los chunks que
+   // cubren el rango, en paralelo en el pool y en orden al sink
+   void read(const std::string &recipe, std::uint64_t offset, std::uint64_t length, const ByteSink &out) {
+      checkRecipe(recipe);
+      if (length == 0) return;
+
+      std::deque<std::future<std::string>> inFlight;
+      std::uint64_t chunkStart = 0;
+      std::uint64_t end = offset + length;
+      std::uint64_t emitted = 0;
+      std::uint64_t skip = 0;  // bytes del primer chunk antes de offset
+      std::size_t maxInFlight = 2 * pool_.size() + 1;
+
+      auto emitOldest = [&] {
+         std::string plain = inFlight.front().get();
+         inFlight.pop_front();
+         if (skip > plain.size())
+            throw std::runtime_error("Corrupted chunk list");
+         std::uint64_t take = std::min<std::uint64_t>(plain.size() - skip, length - emitted);
+         out(plain.data() + skip, static_cast<std::size_t>(take));
+         emitted += take;
+         skip = 0;
+      };
+
+      try {
+         for (std::size_t pos = 0; pos < recipe.size() && chunkStart < end; pos += RECORD_SIZE) {
+            std::uint64_t size = recordSize(recipe.data() + pos);
+            if (chunkStart + size > offset) {
+               if (inFlight.empty() && emitted == 0) skip = offset - chunkStart;
+               auto record = std::make_shared<std::string>(recipe, pos, RECORD_SIZE);
+               inFlight.push_back(pool_.submit([this, record] { return load(*record); }));
+               while (inFlight.size() >= maxInFlight) emitOldest();
+            }
+            chunkStart += size;
+         }
+         while (!inFlight.empty()) emitOldest();
+      } catch (...) {
+         for (auto &pending : inFlight) pending.wait();
+         throw;
+      }
+
+      if (emitted < length)
+         throw std::runtime_error("Requested range is past the end of the chunk list");
+   }
+
+   Stats stats() const {
+      Stats s{};
+      s.storedChunks = storedChunks_.load();
+      s.storedBytes = storedBytes_.load();
+      s.chunksWritten = chunksWritten_.load();
+      s.chunksDeduplicated = chunksDeduplicated_.load();
+      s.logicalBytes = logicalBytes_.load();
+      s.writtenBytes = writtenBytes_.load();
+      s.dedupRatio = s.writtenBytes > 0 ? static_cast<double>(s.logicalBytes) / static_cast<double>(s.writtenBytes) : 1.0;
+      return s;
+   }
+
+   // Formato de exposicion de Prometheus (se agrega a /metrics con MetricsRegistry::addCollector)
+   std::string renderPrometheus() const {
+      Stats s = stats();
+      std::string out;
+      out += "# HELP chunk_store_chunks Chunk files in the deduplicated store.\n";
+      out += "# TYPE chunk_store_chunks gauge\n";
+      out += "chunk_store_chunks " + std::to_string(s.storedChunks) + "\n";
+      out += "# HELP chunk_store_bytes Bytes on disk used by the deduplicated store.\n";
+      out += "# TYPE chunk_store_bytes gauge\n";
+      out += "chunk_store_bytes " + std::to_string(s.storedBytes) + "\n";
+      out += "# HELP chunk_store_chunks_total Chunks received by result.\n";
+      out += "# TYPE chunk_store_chunks_total counter\n";
+      out += "chunk_store_chunks_total{result=\"written\"} " + std::to_string(s.chunksWritten) + "\n";
+      out += "chunk_store_chunks_total{result=\"deduplicated\"} " + std::to_string(s.chunksDeduplicated) + "\n";
+      out += "# HELP chunk_store_logical_bytes_total Archive bytes received by the store.\n";
+      out += "# TYPE chunk_store_logical_bytes_total counter\n";
+      out += "chunk_store_logical_bytes_total " + std::to_string(s.logicalBytes) + "\n";
+      out += "# HELP chunk_store_written_bytes_total Bytes written for new chunks.\n";
+      out += "# TYPE chunk_store_written_bytes_total counter\n";
+      out += "chunk_store_written_bytes_total " + std::to_string(s.writtenBytes) + "\n";
+      out += "# HELP chunk_store_dedup_ratio Archive bytes received per byte written since start.\n";
+      out += "# TYPE chunk_store_dedup_ratio gauge\n";
+      out += "chunk_store_dedup_ratio " + std::to_string(s.dedupRatio) + "\n";
+      return out;
+   }
+
+private:
+   std::filesystem::path root_;
+   std::string secret_;
+   FastCdc cdc_;
+   bool enabled_;
+   ThreadPool &pool_;
+   std::uint8_t suite_;
+   std::atomic<std::uint64_t> tempCounter_{0};
+   std::mutex repairMutex_;
+
+   std::atomic<std::uint64_t> storedChunks_{0};
+   std::atomic<std::uint64_t> storedBytes_{0};
+   std::atomic<std::uint64_t> chunksWritten_{0};
+   std::atomic<std::uint64_t> chunksDeduplicated_{0};
+   std::atomic<std::uint64_t> logicalBytes_{0};
+   std::atomic<std::uint64_t> writtenBytes_{0};
+
+   static void checkRecipe(const std::string &recipe) {
+      if (recipe.size() % RECORD_SIZE != 0)
+         throw std::runtime_error("Corrupted chunk list");
+   }
+
+   static std::uint64_t recordSize(const char *record) {
+      const auto *bytes = reinterpret_cast<const unsigned char*>(record + ID_SIZE + KEY_SIZE);
+      return (std::uint64_t(bytes[0]) << 24) | (std::uint64_t(bytes[1]) << 16) |
+             (std::uint64_t(bytes[2]) << 8) | std::uint64_t(bytes[3]);
+   }
+
+   std::string mac(const char *label, const CryptoPP::byte *digest) const {
+      CryptoPP::HMAC<CryptoPP::SHA256> hmac(reinterpret_cast<const CryptoPP::byte *>(secret_.data()), secret_.size());
+      hmac.Update(reinterpret_cast<const CryptoPP::byte *>(label), std::strlen(label));
+      hmac.Update(digest, CryptoPP::SHA256::DIGESTSIZE);
+      std::string out(CryptoPP::SHA256::DIGESTSIZE, '\0');
+      hmac.Final(reinterpret_cast<CryptoPP::byte *>(&out[0]));
+      return out;
+   }
+
+   std::filesystem::path chunkPath(const std::string &id) const {
+      std::string hex;
+      CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte *>(id.data()), id.size(), true,
+         new CryptoPP::HexEncoder(new CryptoPP::StringSink(hex), false));
+      return root_ / hex.substr(0, 2) / hex;
+   }
+
+   static SegmentedAead::Context chunkContext(std::uint8_t suite, std::size_t size, const std::string &key) {
+      SegmentedAead::Context ctx;
+      ctx.header.suite = suite;
+      ctx.header.segmentSize = static_cast<std::uint32_t>(size);
+      ctx.encodedHeader = ctx.header.encode();
+      ctx.key = key;
+      return ctx;
+   }
+
+   // Guarda un chunk si no existe; devuelve su registro para la lista (tarea del pool)
+   StoredChunk put(const std::string &chunk) {
+      CryptoPP::byte digest[CryptoPP::SHA256::DIGESTSIZE];
+      CryptoPP::SHA256().CalculateDigest(digest, reinterpret_cast<const CryptoPP::byte *>(chunk.data()), chunk.size());
+      std::string id = mac("chunk-id", digest);
+      std::string key = mac("chunk-key", digest);
+
+      StoredChunk stored;
+      stored.record = id + key;
+      std::uint32_t size = static_cast<std::uint32_t>(chunk.size());
+      for (int i = 0; i < 4; ++i)
+         stored.record.push_back(static_cast<char>((size >> (24 - 8 * i)) & 0xFF));
+      logicalBytes_ += chunk.size();
+
+      // Un archivo con el tamaño esperado esta completo: solo se publica despues de fsync
+      std::filesystem::path path = chunkPath(id);
+      const std::uint64_t fileSize = SegmentedAead::HEADER_SIZE + chunk.size() + SegmentedAead::TAG_SIZE;
+      std::error_code ec;
+      if (std::filesystem::file_size(path, ec) == fileSize && !ec) {
+         chunksDeduplicated_++;
+         return stored;
+      }
+
+      SegmentedAead::Context ctx = chunkContext(suite_, chunk.size(), key);
+      std::string sealed = SegmentedAead::sealSegment(ctx, 0, true, chunk);
+
+      // temporal propio + fsync; se publica con link (falla si otro hilo u otro alias ya publico el
+      // mismo chunk, que tiene los mismos bytes: clave y nonce salen del contenido)
+      std::filesystem::create_directories(path.parent_path());
+      std::filesystem::path partPath = path;
+      partPath += "." + std::to_string(tempCounter_++) + ".part";
+      try {
+         {
+            std::ofstream outFile(partPath, std::ios::binary);
+            outFile.write(ctx.encodedHeader.data(), SegmentedAead::HEADER_SIZE);
+            outFile.write(sealed.data(), static_cast<std::streamsize>(sealed.size()));
+            outFile.close();
+            if (!outFile)
+               throw std::runtime_error("Could not write chunk file: " + partPath.string());
+         }
+         fsyncPath(partPath.string());
+         stored.written = publish(partPath, path, fileSize);
+         fsyncPath(path.parent_path().string());
+      } catch (...) {
+         std::filesystem::remove(partPath, ec);
+         throw;
+      }
+      std::filesystem::remove(partPath, ec);
+
+      if (!stored.written) {
+         chunksDeduplicated_++;
+         return stored;
+      }
+      stored.fileSize = fileSize;
+      chunksWritten_++;
+      writtenBytes_ += fileSize;
+      return stored;
+   }
+
+   // Publica partPath como path. Devuelve false si otro ya publico el chunk completo. Un archivo
+   // de otro tamaño (escrito sin fsync por una version anterior y cortado) se reemplaza con rename
+   bool publish(const std::filesystem::path &partPath, const std::filesystem::path &path, std::uint64_t fileSize) {
+      if (::link(partPath.c_str(), path.c_str()) == 0) {
+         storedChunks_++;
+         storedBytes_ += fileSize;
+         return true;
+      }
+      if (errno != EEXIST)
+         throw std::runtime_error("Could not publish chunk file: " + path.string());
+
+      std::lock_guard<std::mutex> lock(repairMutex_);
+      std::uint64_t existing = std::filesystem::file_size(path);
+      if (existing == fileSize) return false;
+
+      std::filesystem::rename(partPath, path);
+      storedBytes_ += fileSize;
+      storedBytes_ -= existing;
+      Log::warn("Replaced a truncated chunk file", {{"file", path.string()}});
+      return true;
+   }
+
+   // Lee y verifica un chunk (tarea del pool)
+   std::string load(const std::string &record) const {
+      std::string id = record.substr(0, ID_SIZE);
+      std::string key = record.substr(ID_SIZE, KEY_SIZE);
+      std::uint64_t size = recordSize(record.data());
+
+      std::filesystem::path path = chunkPath(id);
+      std::ifstream inFile(path, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Missing chunk: " + path.string());
+
+      std::string raw((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+      SegmentedAead::Context ctx;
+      if (!SegmentedAead::Header::decode(raw.data(), raw.size(), ctx.header) ||
+          !SegmentedAead::isSupportedSuite(ctx.header.suite) || ctx.header.segmentSize != size)
+         throw std::runtime_error("Corrupted chunk: " + path.string());
+      std::memcpy(ctx.encodedHeader.data(), raw.data(), SegmentedAead::HEADER_SIZE);
+      ctx.key = key;
+
+      std::string plain = SegmentedAead::openSegment(ctx, 0, true, raw.substr(SegmentedAead::HEADER_SIZE));
+      if (plain.size() != size)
+         throw std::runtime_error("Corrupted chunk: " + path.string());
+      return plain;
+   }
+
+   // Totales del almacen al arrancar; los temporales de una escritura interrumpida se borran
+   void scan() {
+      std::error_code ec;
+      std::vector<std::filesystem::path> parts;
+      for (auto it = std::filesystem::recursive_directory_iterator(root_, ec);
+           !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+         if (!it->is_regular_file()) continue;
+         if (it->path().extension() == ".part") {
+            parts.push_back(it->path());
+            continue;
+         }
+         storedChunks_++;
+         storedBytes_ += it->file_size();
+      }
+      for (const std::filesystem::path &part : parts) std::filesystem::remove(part, ec);
+   }
+};
@@ -0,0 +1,152 @@
+// infrastructure/crypto/EciesKeyWrap.hpp
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cryptopp/aes.h>
+#include <cryptopp/base64.h>
+#include <cryptopp/eccrypto.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/gcm.h>
+#include <cryptopp/hkdf.h>
+#include <cryptopp/oids.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/secblock.h>
+#include <cryptopp/sha.h>
+#include "RsaPublicKeyCache.hpp"
+#include "../cache/ShardedLruCache.hpp"
+
+// Envoltura ECIES de la clave AES de un repo con la clave publica EC del usuario (users.kpubecdsa, DER X.509 en Base64).
+//
+// Por destinatario: par efimero P-256, ECDH con su punto publico, HKDF-SHA256 y AES-256-GCM.
+//   salida  = Base64(VERSION || punto efimero sin comprimir (65 bytes) || cifrado || tag (16 bytes))
+//   clave   = HKDF-SHA256(ikm = secreto ECDH, salt = punto efimero || punto del destinatario, info = INFO), 32 bytes
+//   GCM     = nonce de 12 bytes en cero (cada clave derivada cifra un solo mensaje), AAD = VERSION
+// El cliente lo abre con su clave privada: ECDH(privada, punto efimero) y la misma derivacion.
+//
+// Una envoltura cuesta dos multiplicaciones escalares (par efimero y acuerdo) frente a la
+// exponenciacion RSA, y validar una clave EC es comprobar que el punto esta en la curva,
+// no probar la primalidad de un modulo. Los puntos ya validados se guardan por huella del DER.
+class EciesKeyWrap {
+public:
+   static constexpr CryptoPP::byte VERSION = 0x01;
+   static constexpr std::size_t POINT_SIZE = 65;
+   static constexpr std::size_t TAG_SIZE = 16;
+
+   explicit EciesKeyWrap(std::size_t capacity = 1024, std::size_t shards = 8)
+      : points_(capacity, shards, std::chrono::hours(24)) {}
+
+   // Envuelve plainText para la clave publica; lanza std::runtime_error si la clave no es P-256 valida
+   std::string wrap(CryptoPP::RandomNumberGenerator &rng, const std::string &plainText, const std::string &publicKeyB64) {
+      std::shared_ptr<const std::string> recipient = point(publicKeyB64);
+      const Domain &ecdh = domain();
+
+      // 1. Par efimero y secreto compartido (el punto del destinatario ya se valido al cargarlo)
+      CryptoPP::SecByteBlock ephemeralPrivate(ecdh.PrivateKeyLength());
+      CryptoPP::SecByteBlock ephemeralPublic(ecdh.PublicKeyLength());
+      ecdh.GenerateKeyPair(rng, ephemeralPrivate, ephemeralPublic);
+
+      CryptoPP::SecByteBlock shared(ecdh.AgreedValueLength());
+      if (!ecdh.Agree(shared, ephemeralPrivate, reinterpret_cast<const CryptoPP::byte *>(recipient->data()), false))
+         throw std::runtime_error("ECDH agreement failed");
+
+      // 2. Clave de envoltura ligada a ambos puntos
+      std::string salt(reinterpret_cast<const char *>(ephemeralPublic.data()), ephemeralPublic.size());
+      salt += *recipient;
+      CryptoPP::SecByteBlock wrapKey(CryptoPP::AES::MAX_KEYLENGTH);
+      CryptoPP::HKDF<CryptoPP::SHA256> hkdf;
+      hkdf.DeriveKey(wrapKey, wrapKey.size(), shared, shared.size(),
+                     reinterpret_cast<const CryptoPP::byte *>(salt.data()), salt.size(),
+                     reinterpret_cast<const CryptoPP::byte *>(INFO), sizeof(INFO) - 1);
+
+      // 3. VERSION || punto efimero || cifrado || tag
+      std::string out(1 + POINT_SIZE + plainText.size() + TAG_SIZE, '\0');
+      CryptoPP::byte *bytes = reinterpret_cast<CryptoPP::byte *>(&out[0]);
+      bytes[0] = VERSION;
+      std::copy(ephemeralPublic.begin(), ephemeralPublic.begin() + POINT_SIZE, bytes + 1);
+
+      const CryptoPP::byte nonce[12] = {0};
+      CryptoPP::GCM<CryptoPP::AES>::Encryption gcm;
+      gcm.SetKeyWithIV(wrapKey, wrapKey.size(), nonce, sizeof(nonce));
+      gcm.EncryptAndAuthenticate(bytes + 1 + POINT_SIZE, bytes + 1 + POINT_SIZE + plainText.size(), TAG_SIZE,
+                                 nonce, sizeof(nonce), &VERSION, 1,
+                                 reinterpret_cast<const CryptoPP::byte *>(plainText.data()), plainText.size());
+
+      std::string b64;
+      CryptoPP::StringSource ss(out, true, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(b64), false));
+      return b64;
+   }
+
+   // Validacion sin pasar por la cache (al subir la clave): DER X.509 de una clave publica P-256
+   static bool isValid(const std::string &publicKeyB64) {
+      try {
+         load(decodeBase64(publicKeyB64));
+         return true;
+      } catch (const std::exception &) {
+         return false;
+      }
+   }
+
+   // Texto Prometheus para /metrics
+   std::string renderPrometheus() const {
+      std::string out;
+      out += "# HELP ec_key_cache_requests_total Validated EC public key lookups by result.\n";
+      out += "# TYPE ec_key_cache_requests_total counter\n";
+      out += "ec_key_cache_requests_total{result=\"hit\"} " + std::to_string(points_.hits()) + "\n";
+      out += "ec_key_cache_requests_total{result=\"miss\"} " + std::to_string(points_.misses()) + "\n";
+      return out;
+   }
+
+private:
+   using Domain = CryptoPP::ECDH<CryptoPP::ECP>::Domain;
+   using PublicKey = CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>::PublicKey;
+
+   static constexpr char INFO[] = "repo-protect ecies-p256 v1";
+
+   // punto publico sin comprimir, por huella del DER
+   ShardedLruCache<std::string, std::shared_ptr<const std::string>> points_;
+
+   // El dominio guarda precalculos del generador: uno por hilo
+   static const Domain &domain() {
+      thread_local const Domain ecdh(CryptoPP::ASN1::secp256r1());
+      return ecdh;
+   }
+
+   std::shared_ptr<const std::string> point(const std::string &publicKeyB64) {
+      std::string der = decodeBase64(publicKeyB64);
+      std::string print = RsaPublicKeyCache::fingerprint(der);
+
+      if (auto cached = points_.get(print)) return *cached;
+
+      auto loaded = std::make_shared<const std::string>(load(der));
+      points_.put(print, loaded);
+      return loaded;
+   }
+
+   static std::string decodeBase64(const std::string &b64) {
+      std::string der;
+      CryptoPP::StringSource ss(b64, true, new CryptoPP::Base64Decoder(new CryptoPP::StringSink(der)));
+      return der;
+   }
+
+   // Carga el DER, exige la curva P-256 y valida el punto; devuelve el punto sin comprimir
+   static std::string load(const std::string &der) {
+      PublicKey publicKey;
+      CryptoPP::StringSource ssLoad(der, true);
+      publicKey.Load(ssLoad);
+
+      const CryptoPP::DL_GroupParameters_EC<CryptoPP::ECP> p256(CryptoPP::ASN1::secp256r1());
+      if (!(publicKey.GetGroupParameters() == p256))
+         throw std::runtime_error("EC public key is not on the P-256 curve");
+
+      CryptoPP::AutoSeededRandomPool rng;
+      if (!publicKey.Validate(rng, 3))
+         throw std::runtime_error("Invalid EC public key");
+
+      std::string encoded(POINT_SIZE, '\0');
+      p256.EncodeElement(true, publicKey.GetPublicElement(), reinterpret_cast<CryptoPP::byte *>(&encoded[0]));
+      return encoded;
+   }
+};
@@ -0,0 +1,141 @@
+// infrastructure/crypto/PasswordHasher.hpp
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <cryptopp/pwdbased.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/base64.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/misc.h>
+#include "../concurrency/ThreadPool.hpp"
+#include "../../domain/repositories/IPasswordHash.repository.hpp"
+
+// Hash de passwords con PBKDF2-HMAC-SHA256 (Argon2id no esta disponible en Crypto++).
+// Formato guardado: pbkdf2-sha256$<iteraciones>$<sal base64>$<hash base64>
+//
+// Cada hash cuesta decenas de ms de CPU a proposito: se calcula en un pool propio de tamaño fijo
+// y con un maximo de tareas en espera, para que una rafaga de logins o altas no ocupe todos los
+// workers de httplib ni crezca sin limite (al superarlo se lanza Busy y la API responde 503).
+class PasswordHasher : public IPasswordHashRepository {
+public:
+   PasswordHasher(ThreadPool &pool, unsigned int iterations, std::size_t maxPending)
+      : pool_(pool), iterations_(iterations), maxPending_(maxPending > 0 ? maxPending : 1) {
+      if (iterations_ == 0)
+         throw std::runtime_error("Password hash iterations must be positive");
+   }
+
+   std::string hash(const std::string &password) override {
+      return onPool([this, &password] {
+         std::string salt(SALT_SIZE, '\0');
+         CryptoPP::AutoSeededRandomPool rng;
+         rng.GenerateBlock(reinterpret_cast<CryptoPP::byte *>(&salt[0]), salt.size());
+
+         std::string derived = derive(password, salt, iterations_);
+         return std::string(PREFIX) + "$" + std::to_string(iterations_) + "$" + toBase64(salt) + "$" + toBase64(derived);
+      });
+   }
+
+   bool verify(const std::string &password, const std::string &stored) override {
+      Parsed parsed;
+      if (!parse(stored, parsed)) {
+         // fila anterior al hash: password en claro (needsRehash la marca para rehashear)
+         return constantTimeEquals(password, stored);
+      }
+      return onPool([&password, &parsed] {
+         return constantTimeEquals(derive(password, parsed.salt, parsed.iterations), parsed.hash);
+      });
+   }
+
+   bool needsRehash(const std::string &stored) const override {
+      Parsed parsed;
+      return !parse(stored, parsed) || parsed.iterations < iterations_;
+   }
+
+   unsigned int iterations() const { return iterations_; }
+
+   // PBKDF2 directo en el hilo que llama (para el benchmark)
+   static std::string derive(const std::string &password, const std::string &salt, unsigned int iterations) {
+      std::string derived(HASH_SIZE, '\0');
+      CryptoPP::PKCS5_PBKDF2_HMAC<CryptoPP::SHA256> pbkdf2;
+      pbkdf2.DeriveKey(reinterpret_cast<CryptoPP::byte *>(&derived[0]), derived.size(), 0,
+                       reinterpret_cast<const CryptoPP::byte *>(password.data()), password.size(),
+                       reinterpret_cast<const CryptoPP::byte *>(salt.data()), salt.size(),
+                       iterations);
+      return derived;
+   }
+
+private:
+   static constexpr const char *PREFIX = "pbkdf2-sha256";
+   static constexpr std::size_t SALT_SIZE = 16;
+   static constexpr std::size_t HASH_SIZE = 32;
+
+   struct Parsed {
+      unsigned int iterations = 0;
+      std::string salt;
+      std::string hash;
+   };
+
+   ThreadPool &pool_;
+   unsigned int iterations_;
+   std::size_t maxPending_;
+   std::atomic<std::size_t> pending_{0};
+
+   // Ejecuta en el pool de hashing y espera el resultado; rechaza si ya hay demasiadas en cola
+   template <class F>
+   auto onPool(F &&task) -> decltype(task()) {
+      if (pending_.fetch_add(1, std::memory_order_acq_rel) >= maxPending_) {
+         pending_.fetch_sub(1, std::memory_order_acq_rel);
+         throw Busy("Too many password hashing requests in progress, try again later");
+      }
+      try {
+         auto result = pool_.submit(std::forward<F>(task)).get();
+         pending_.fetch_sub(1, std::memory_order_acq_rel);
+         return result;
+      } catch (...) {
+         pending_.fetch_sub(1, std::memory_order_acq_rel);
+         throw;
+      }
+   }
+
+   static bool parse(const std::string &stored, Parsed &out) {
+      std::string prefix = std::string(PREFIX) + "$";
+      if (stored.compare(0, prefix.size(), prefix) != 0) return false;
+
+      std::size_t iterEnd = stored.find('$', prefix.size());
+      if (iterEnd == std::string::npos) return false;
+      std::size_t saltEnd = stored.find('$', iterEnd + 1);
+      if (saltEnd == std::string::npos) return false;
+
+      try {
+         out.iterations = static_cast<unsigned int>(std::stoul(stored.substr(prefix.size(), iterEnd - prefix.size())));
+      } catch (const std::exception &) {
+         return false;
+      }
+      out.salt = fromBase64(stored.substr(iterEnd + 1, saltEnd - iterEnd - 1));
+      out.hash = fromBase64(stored.substr(saltEnd + 1));
+      return out.iterations > 0 && out.salt.size() == SALT_SIZE && out.hash.size() == HASH_SIZE;
+   }
+
+   static bool constantTimeEquals(const std::string &a, const std::string &b) {
+      if (a.size() != b.size()) return false;
+      return CryptoPP::VerifyBufsEqual(reinterpret_cast<const CryptoPP::byte *>(a.data()),
+                                       reinterpret_cast<const CryptoPP::byte *>(b.data()), a.size());
+   }
+
+   static std::string toBase64(const std::string &raw) {
+      std::string encoded;
+      CryptoPP::StringSource(raw, true,
+         new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded), false));
+      return encoded;
+   }
+
+   static std::string fromBase64(const std::string &encoded) {
+      std::string raw;
+      CryptoPP::StringSource(encoded, true,
+         new CryptoPP::Base64Decoder(new CryptoPP::StringSink(raw)));
+      return raw;
+   }
+};
@@ -3,6 +3,10 @@
 #include <string>
 #include <stdexcept>
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <cryptopp/aes.h>
 #include <cryptopp/gcm.h>
 #include <cryptopp/osrng.h>
@@ -10,17 +14,51 @@
 #include <cryptopp/filters.h>
 #include <cryptopp/base64.h>
 #include <cryptopp/rsa.h>
+#include <cryptopp/hmac.h>
+#include <cryptopp/sha.h>
+#include <vector>
+#include <functional>
+#include <future>
+#include <memory>
+#include "RsaPublicKeyCache.hpp"
+#include "EciesKeyWrap.hpp"
+#include "SecureRandom.hpp"
+#include "SegmentedAead.hpp"
+#include "ChunkStore.hpp"
+#include "../storage/FileSync.hpp"
+#include "../concurrency/ThreadPool.hpp"
+#include "../logging/Log.hpp"
 #include "../../domain/repositories/IProtectRepoCrypto.repository.hpp"
 
 class ProtectRepoCrypto : public IProtectRepoCryptoRepository {
 public:
-   explicit ProtectRepoCrypto() = default;
+   // cryptoPool: hilos para sellar/abrir segmentos en paralelo
+   // random: generador por hilo para claves, IVs y OAEP (ver SecureRandom)
+   // streamBufferSize: bytes que se leen por iteracion al procesar archivos
+   // segmentSize: bytes de texto plano por segmento en el formato segmentado
+   // rsaKeyCacheCapacity: claves publicas RSA (y puntos EC) ya cargadas que se conservan (0 = sin cache)
+   // cipherSuite: AEAD de los archivos que se escriben (ver CipherSuite::select); se leen ambas suites
+   // chunkStore: almacen deduplicado para los archivos con indice (si esta habilitado) y para leer
+   //             los .tar.enc que son listas de chunks (nullptr = sin almacen)
+   explicit ProtectRepoCrypto(ThreadPool &cryptoPool, SecureRandom &random, std::size_t streamBufferSize = 1 << 20, std::uint32_t segmentSize = 1 << 20,
+                              std::size_t rsaKeyCacheCapacity = 1024, std::uint8_t cipherSuite = SegmentedAead::SUITE_AES_256_GCM,
+                              ChunkStore *chunkStore = nullptr)
+      : cryptoPool_(cryptoPool),
+        random_(random),
+        streamBufferSize_(streamBufferSize ? streamBufferSize : 1 << 20),
+        segmentSize_(segmentSize ? segmentSize : 1 << 20),
+        rsaKeys_(rsaKeyCacheCapacity),
+        ecKeys_(rsaKeyCacheCapacity),
+        cipherSuite_(cipherSuite),
+        chunkStore_(chunkStore) {
+      if (!SegmentedAead::isSupportedSuite(cipherSuite_))
+         throw std::runtime_error("Unsupported cipher suite: " + std::to_string(cipherSuite_));
+   }
 
    std::string gen_b64_AES_GCM_Key() override {
-      CryptoPP::AutoSeededRandomPool prng;
       // Generar clave AES de 32 bytes (256 bits)
       CryptoPP::SecByteBlock key(CryptoPP::AES::MAX_KEYLENGTH);
-      prng.GenerateBlock(key, key.size());
+      random_.generator().GenerateBlock(key, key.size());
 
       // Codificar la clave en Base64
       std::string keyb64;
@@ -33,161 +71,249 @@ public:
       return keyb64;
    }
 
-   // Cifrar archivo (IV se guarda al inicio del archivo cifrado)
+   // Cifrar archivo con el formato segmentado (ver SegmentedAead.hpp).
+   // El archivo se lee por bloques de streamBufferSize_ bytes y los segmentos se sellan en paralelo
    bool cipher_AES_GCM(const std::string &filePath, const std::string &fileOutPath, const std::string &keyAES) override {      
-      try {
-         CryptoPP::AutoSeededRandomPool rng;
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile) {
+         Log::error("Error during AES-GCM encryption: could not open input file", {{"file", filePath}});
+         return false;
+      }
 
-         // Decodificar clave desde Base64
-         std::string decodedKey;
-         CryptoPP::StringSource ssKey(keyAES, true,
-               new CryptoPP::Base64Decoder(
-                  new CryptoPP::StringSink(decodedKey)
-               )
-         );
+      std::size_t bufferSize = streamBufferSize_;
+      return cipherStream_AES_GCM(
+         [&inFile, bufferSize](const ByteSink &sink) {
+            std::vector<char> buffer(bufferSize);
+            while (inFile) {
+               inFile.read(buffer.data(), buffer.size());
+               if (inFile.gcount() > 0) sink(buffer.data(), static_cast<std::size_t>(inFile.gcount()));
+            }
+            if (inFile.bad())
+               throw std::runtime_error("Could not read input file");
+         },
+         fileOutPath, keyAES);
+   }
 
-         // Generar IV aleatorio de 12 bytes
-         CryptoPP::SecByteBlock iv(12);
-         rng.GenerateBlock(iv, iv.size());
 
-         // leer el archivo original
-         std::ifstream inFile(filePath, std::ios::binary);
-         if (!inFile)
-               throw std::runtime_error("Could not open input file: " + filePath);
-
-         std::string plainText((std::istreambuf_iterator<char>(inFile)),
-                              std::istreambuf_iterator<char>());
-         inFile.close();
-
-         // configurar cifrador AES-GCM
-         CryptoPP::GCM<CryptoPP::AES>::Encryption encryptor;
-         encryptor.SetKeyWithIV(
-               reinterpret_cast<const CryptoPP::byte*>(decodedKey.data()),
-               decodedKey.size(),
-               iv, iv.size()
-         );
+   // Cifrar un flujo de bytes (ej. tar.gz generado en proceso) directo al archivo de salida.
+   // El productor escribe al cifrador segmentado conforme genera datos: no hay archivo intermedio
+   // ni se carga el contenido en memoria (como mucho 2*hilos+1 segmentos en vuelo).
+   bool cipherStream_AES_GCM(const ByteProducer &producer, const std::string &fileOutPath, const std::string &keyAES) override {
+      return cipherToFile(fileOutPath, keyAES, false, false, [&producer](SegmentedAead::Writer &writer) {
+         producer(writer.sink());
+         writer.finish();
+      });
+   }
 
-         // cifrar el texto plano
-         std::string cipherText;
-         CryptoPP::StringSource ssPlain(plainText, true,
-               new CryptoPP::AuthenticatedEncryptionFilter(encryptor,
-                  new CryptoPP::StringSink(cipherText)
-               )
-         );
 
-         // escribir IV + texto cifrado en el archivo de salida
-         std::ofstream outFile(fileOutPath, std::ios::binary);
-         if (!outFile)
-               throw std::runtime_error("Could not open output file: " + fileOutPath);
+   // Igual que cipherStream_AES_GCM; el indice que devuelve el productor se sella al final del archivo.
+   // Con el almacen de chunks habilitado el contenido va al almacen y el archivo guarda la lista
+   bool cipherStreamIndexed_AES_GCM(const IndexedByteProducer &producer, const std::string &fileOutPath, const std::string &keyAES) override {
+      if (chunkStore_ && chunkStore_->enabled()) {
+         return cipherToFile(fileOutPath, keyAES, true, true, [this, &producer, &fileOutPath](SegmentedAead::Writer &writer) {
+            ChunkStore::Writer chunks(*chunkStore_, writer.sink());
+            std::string index = producer(chunks.sink());
+            ChunkStore::Summary summary = chunks.finish();
+            writer.finish(index);
+
+            double ratio = summary.writtenBytes > 0
+               ? static_cast<double>(summary.logicalBytes) / static_cast<double>(summary.writtenBytes) : 0.0;
+            Log::info("Archive stored as chunks", {{"file", fileOutPath},
+                                                   {"chunks", summary.chunks},
+                                                   {"new_chunks", summary.newChunks},
+                                                   {"logical_bytes", summary.logicalBytes},
+                                                   {"written_bytes", summary.writtenBytes},
+                                                   {"dedup_ratio", ratio}});
+         });
+      }
 
-         // escribir IV (12 bytes) al inicio
-         outFile.write(reinterpret_cast<const char*>(iv.data()), iv.size());
-         // escribir texto cifrado
-         outFile.write(cipherText.data(), cipherText.size());
-         outFile.close();
+      return cipherToFile(fileOutPath, keyAES, true, false, [&producer](SegmentedAead::Writer &writer) {
+         std::string index = producer(writer.sink());
+         writer.finish(index);
+      });
+   }
+
+
+   std::string readIndex_AES_GCM(const std::string &filePath, const std::string &keyAES) override {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      if (!SegmentedAead::Reader::isSegmented(inFile))
+         throw std::runtime_error("Cipher file has no index (legacy format): " + filePath);
+
+      SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodeKey(keyAES), cryptoPool_);
+      return reader.readIndex();
+   }
+
+
+   void decipherRange_AES_GCM(const std::string &filePath, const std::string &keyAES,
+                              std::uint64_t offset, std::uint64_t length, const ByteSink &out) override {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      if (!SegmentedAead::Reader::isSegmented(inFile))
+         throw std::runtime_error("Partial decryption needs the segmented format: " + filePath);
+
+      SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodeKey(keyAES), cryptoPool_);
+      if (reader.isChunkList())
+         chunkStore().read(readChunkList(reader), offset, length, out);
+      else
+         reader.decryptRange(offset, length, out);
+   }
+
+
+   bool isChunkList_AES_GCM(const std::string &filePath) override {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      char raw[SegmentedAead::HEADER_SIZE];
+      inFile.read(raw, SegmentedAead::HEADER_SIZE);
+      SegmentedAead::Header header;
+      return SegmentedAead::Header::decode(raw, static_cast<std::size_t>(inFile.gcount()), header) &&
+             (header.flags & SegmentedAead::FLAG_CHUNKS) != 0;
+   }
 
+
+   std::uint64_t rebuiltSize_AES_GCM(const std::string &filePath, const std::string &keyAES) override {
+      return rebuiltView(filePath, keyAES).size();
+   }
+
+
+   void readRebuilt_AES_GCM(const std::string &filePath, const std::string &keyAES,
+                            std::uint64_t offset, std::uint64_t length, const ByteSink &out) override {
+      rebuiltView(filePath, keyAES).emit(offset, length, out);
+   }
+
+
+   // Sin temporal: cada segmento se verifica antes de llegar al sink; un tag invalido lanza a la mitad
+   // y quien consume debe descartar lo que ya recibio (ver FilesystemStorage::extractArchiveStream)
+   void decipherStream_AES_GCM(const std::string &filePath, const std::string &keyAES, const ByteSink &out) override {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      if (!SegmentedAead::Reader::isSegmented(inFile))
+         throw std::runtime_error("Streaming decryption needs the segmented format: " + filePath);
+
+      SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodeKey(keyAES), cryptoPool_);
+      if (reader.isChunkList())
+         decipherChunks(reader, out);
+      else
+         reader.decryptAll(out);
+   }
+
+
+   bool verifyKey_AES_GCM(const std::string &filePath, const std::string &keyAES) override {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      if (!SegmentedAead::Reader::isSegmented(inFile))
+         throw std::runtime_error("Key verification needs the segmented format: " + filePath);
+
+      // un tag invalido (o una clave de otro tamaño) lanza: la clave no es la del archivo
+      try {
+         SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodeKey(keyAES), cryptoPool_);
+         reader.decrypt(0, 1, [](const char *, std::size_t) {});
          return true;
       } catch (const std::exception &e) {
-         std::cerr << "Error during AES-GCM encryption: " << e.what() << std::endl;
+         Log::warn("AES key verification failed", {{"file", filePath}, {"error", e.what()}});
+         return false;
+      }
+   }
+
+
+   // Descifra segmento a segmento con la clave anterior y sella con la nueva en la misma pasada
+   // (el indice se copia tal cual, la suite pasa a ser la configurada); fileOutPath se escribe via temporal + rename.
+   // En una lista de chunks solo se vuelve a sellar la lista: los chunks no dependen de la clave del alias
+   bool rekey_AES_GCM(const std::string &filePath, const std::string &fileOutPath,
+                      const std::string &oldKeyAES, const std::string &newKeyAES) override {
+      try {
+         std::ifstream inFile(filePath, std::ios::binary);
+         if (!inFile)
+            throw std::runtime_error("Could not open input file: " + filePath);
+         if (!SegmentedAead::Reader::isSegmented(inFile))
+            throw std::runtime_error("Re-encryption needs the segmented format: " + filePath);
+
+         SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodeKey(oldKeyAES), cryptoPool_);
+         bool withIndex = reader.hasIndex();
+         std::string index = withIndex ? reader.readIndex() : std::string();
+
+         return cipherToFile(fileOutPath, newKeyAES, withIndex, reader.isChunkList(), [&reader, withIndex, &index](SegmentedAead::Writer &writer) {
+            reader.decryptAll(writer.sink());
+            if (withIndex) writer.finish(index);
+            else writer.finish();
+         });
+      } catch (const std::exception &e) {
+         Log::error("Error during AES-GCM re-encryption", {{"error", e.what()}});
          return false;
       }
    }
 
 
-   // Probablemente no se use y la quite
-   // descifrar archivo (IV se lee del inicio del archivo cifrado)
+   // descifrar archivo: acepta el formato segmentado y el formato anterior (IV || texto cifrado || tag).
+   // El texto plano se escribe a un temporal y solo se renombra a fileOutPath si todo verifica.
    bool decipher_AES_GCM(const std::string &filePath, const std::string &fileOutPath, const std::string &keyAES) override {
+      std::string partPath = fileOutPath + ".part";
       try {
          // Decodificar clave desde Base64
-         std::string decodedKey;
-         CryptoPP::StringSource ssKey(keyAES, true,
-            new CryptoPP::Base64Decoder(
-               new CryptoPP::StringSink(decodedKey)
-            )
-         );
+         std::string decodedKey = decodeKey(keyAES);
 
-         // Leer archivo cifrado
+         // Abrir archivo cifrado
          std::ifstream inFile(filePath, std::ios::binary);
          if (!inFile)
             throw std::runtime_error("Could not open input file: " + filePath);
+         std::uintmax_t fileSize = std::filesystem::file_size(filePath);
 
-         // Extraer IV (primeros 12 bytes)
-         CryptoPP::SecByteBlock iv(12);
-         inFile.read(reinterpret_cast<char*>(iv.data()), iv.size());
-
-         // Leer el resto (texto cifrado + tag)
-         std::string cipherText((std::istreambuf_iterator<char>(inFile)),
-                              std::istreambuf_iterator<char>());
-         inFile.close();
-
-         // Configurar descifrador AES-GCM
-         CryptoPP::GCM<CryptoPP::AES>::Decryption decryptor;
-         decryptor.SetKeyWithIV(
-            reinterpret_cast<const CryptoPP::byte*>(decodedKey.data()),
-            decodedKey.size(),
-            iv, iv.size()
-         );
-
-         // Descifrar el texto cifrado
-         std::string plainText;
-         CryptoPP::StringSource ssCipher(cipherText, true,
-            new CryptoPP::AuthenticatedDecryptionFilter(decryptor,
-               new CryptoPP::StringSink(plainText)
-            )
-         );
-
-         // Escribir archivo descifrado
-         std::ofstream outFile(fileOutPath, std::ios::binary);
+         std::ofstream outFile(partPath, std::ios::binary);
          if (!outFile)
-            throw std::runtime_error("Could not open output file: " + fileOutPath);
+            throw std::runtime_error("Could not open output file: " + partPath);
+
+         if (SegmentedAead::Reader::isSegmented(inFile)) {
+            SegmentedAead::Reader reader(inFile, fileSize, decodedKey, cryptoPool_);
+            ByteSink sink = [&outFile](const char *data, std::size_t size) {
+               outFile.write(data, size);
+            };
+            if (reader.isChunkList())
+               decipherChunks(reader, sink);
+            else
+               reader.decryptAll(sink);
+         } else {
+            decipherLegacy(inFile, fileSize, decodedKey, outFile);
+         }
 
-         outFile.write(plainText.data(), plainText.size());
          outFile.close();
+         if (!outFile)
+            throw std::runtime_error("Could not write output file: " + partPath);
 
+         std::filesystem::rename(partPath, fileOutPath);
          return true;
       } catch (const std::exception &e) {
-         std::cerr << "Error during AES-GCM decryption: " << e.what() << std::endl;
+         std::error_code ec;
+         std::filesystem::remove(partPath, ec);
+         Log::error("Error during AES-GCM decryption", {{"error", e.what()}});
          return false;
       }
    }
 
 
 
-   // Cifrar texto con RSA-OAEP
+   // Cifrar texto con RSA-OAEP. La clave se decodifica, carga y valida solo la primera vez
+   // (ver RsaPublicKeyCache); despues es solo el cifrado
    std::string cipher_RSA_OAEP(const std::string &plainText, const std::string &publicKeyRSA) override {
       try {
-         CryptoPP::AutoSeededRandomPool rng;
-
-         // Decodificar clave pública desde Base64
-         std::string publicKeyDER;
-         CryptoPP::StringSource ssKey(publicKeyRSA, true,
-               new CryptoPP::Base64Decoder(
-                  new CryptoPP::StringSink(publicKeyDER)
-               )
-         );
-
-         // Cargar clave pública RSA
-         CryptoPP::RSA::PublicKey publicKey;
-         CryptoPP::StringSource ssLoad(publicKeyDER, true);
-         publicKey.Load(ssLoad);
-
-         // Validar clave pública
-         if (!publicKey.Validate(rng, 3)) {
-               throw std::runtime_error("Invalid RSA public key");
-         }
-
-         // Configurar cifrador RSA-OAEP con SHA-256
-         // CryptoPP::RSAES_OAEP_SHA_Encryptor encryptor(publicKey);
-         CryptoPP::RSAES<CryptoPP::OAEP<CryptoPP::SHA256>>::Encryptor encryptor(publicKey);
+         std::shared_ptr<const RsaPublicKeyCache::Encryptor> encryptor = rsaKeys_.encryptor(publicKeyRSA);
 
+         if (plainText.size() > encryptor->FixedMaxPlaintextLength())
+            throw std::runtime_error("Plain text too long for the RSA key");
 
          // Cifrar el texto plano
-         std::string cipherText;
-         CryptoPP::StringSource ssPlain(plainText, true,
-               new CryptoPP::PK_EncryptorFilter(rng, encryptor,
-                  new CryptoPP::StringSink(cipherText)
-               )
-         );
+         std::string cipherText(encryptor->FixedCiphertextLength(), '\0');
+         encryptor->Encrypt(random_.generator(), reinterpret_cast<const CryptoPP::byte *>(plainText.data()), plainText.size(),
+                            reinterpret_cast<CryptoPP::byte *>(&cipherText[0]));
 
          // Codificar resultado en Base64
          std::string cipherTextBase64;
@@ -201,11 +327,214 @@ public:
          return cipherTextBase64;
 
       } catch (const std::exception &e) {
-         std::cerr << "Error during RSA-OAEP encryption: " << e.what() << std::endl;
+         Log::error("Error during RSA-OAEP encryption", {{"error", e.what()}});
+         return "";
+      }
+   }
+
+   // Un lote de claves por hilo del pool de cifrado (no llamar desde una tarea de ese mismo pool).
+   // Con las claves en cache cada envoltura es una exponenciacion: 200 destinatarios cuestan
+   // del orden de lo que cuestan 2 en un solo hilo
+   std::vector<std::string> cipher_RSA_OAEP_many(const std::string &plainText, const std::vector<std::string> &publicKeysRSA) override {
+      return wrapMany(publicKeysRSA, [this, &plainText](const std::string &publicKey) { return cipher_RSA_OAEP(plainText, publicKey); });
+   }
+
+   bool validate_RSA_PublicKey(const std::string &publicKeyRSA) override {
+      return RsaPublicKeyCache::isValid(publicKeyRSA);
+   }
+
+   // Envoltura ECIES P-256 (ver EciesKeyWrap); el punto de cada clave se valida solo la primera vez
+   std::string cipher_ECIES(const std::string &plainText, const std::string &publicKeyEC) override {
+      try {
+         return ecKeys_.wrap(random_.generator(), plainText, publicKeyEC);
+      } catch (const std::exception &e) {
+         Log::error("Error during ECIES encryption", {{"error", e.what()}});
          return "";
       }
    }
 
+   std::vector<std::string> cipher_ECIES_many(const std::string &plainText, const std::vector<std::string> &publicKeysEC) override {
+      return wrapMany(publicKeysEC, [this, &plainText](const std::string &publicKey) { return cipher_ECIES(plainText, publicKey); });
+   }
+
+   const RsaPublicKeyCache &rsaKeyCache() const { return rsaKeys_; }
+   const EciesKeyWrap &ecKeyCache() const { return ecKeys_; }
+   std::uint8_t cipherSuite() const { return cipherSuite_; }
+
 private:
-   // Aquí puedes agregar métodos privados para ayudar en la implementación
+   ThreadPool &cryptoPool_;
+   SecureRandom &random_;
+   std::size_t streamBufferSize_;
+   std::uint32_t segmentSize_;
+   RsaPublicKeyCache rsaKeys_;
+   EciesKeyWrap ecKeys_;
+   std::uint8_t cipherSuite_;
+   ChunkStore *chunkStore_;
+
+   // Reparte las claves en un lote por hilo del pool de cifrado; resultado en el orden de las claves
+   template <class Wrap>
+   std::vector<std::string> wrapMany(const std::vector<std::string> &publicKeys, Wrap wrap) {
+      std::vector<std::string> wrapped(publicKeys.size());
+      std::size_t batches = std::min(publicKeys.size(), cryptoPool_.size());
+      if (batches <= 1) {
+         for (std::size_t i = 0; i < publicKeys.size(); ++i) wrapped[i] = wrap(publicKeys[i]);
+         return wrapped;
+      }
+
+      std::vector<std::future<void>> pending;
+      pending.reserve(batches);
+      for (std::size_t b = 0; b < batches; ++b) {
+         pending.push_back(cryptoPool_.submit([b, batches, &wrap, &publicKeys, &wrapped] {
+            for (std::size_t i = b; i < publicKeys.size(); i += batches)
+               wrapped[i] = wrap(publicKeys[i]);
+         }));
+      }
+      for (auto &batch : pending) batch.get();
+      return wrapped;
+   }
+
+   static std::string decodeKey(const std::string &keyAES) {
+      std::string decodedKey;
+      CryptoPP::StringSource ssKey(keyAES, true,
+         new CryptoPP::Base64Decoder(
+            new CryptoPP::StringSink(decodedKey)
+         )
+      );
+      return decodedKey;
+   }
+
+   ChunkStore &chunkStore() {
+      if (!chunkStore_)
+         throw std::runtime_error("Cipher file is a chunk list but there is no chunk store");
+      return *chunkStore_;
+   }
+
+   // La lista es el texto plano del archivo (verificada como cualquier otro contenido)
+   static std::string readChunkList(SegmentedAead::Reader &reader) {
+      std::string recipe;
+      reader.decryptAll([&recipe](const char *data, std::size_t size) { recipe.append(data, size); });
+      return recipe;
+   }
+
+   void decipherChunks(SegmentedAead::Reader &reader, const ByteSink &out) {
+      std::string recipe = readChunkList(reader);
+      chunkStore().read(recipe, 0, ChunkStore::logicalSize(recipe), out);
+   }
+
+   // Archivo segmentado equivalente a una lista de chunks: mismo contenido, indice, suite y tamaño de
+   // segmento, sellado con la misma clave. El prefijo de nonce es un HMAC (con la clave) de la lista y el
+   // indice: cada peticion reconstruye los mismos bytes y un nonce solo se repite con el mismo texto plano.
+   SegmentedAead::SealedView rebuiltView(const std::string &filePath, const std::string &keyAES) {
+      std::ifstream inFile(filePath, std::ios::binary);
+      if (!inFile)
+         throw std::runtime_error("Could not open input file: " + filePath);
+
+      if (!SegmentedAead::Reader::isSegmented(inFile))
+         throw std::runtime_error("Cipher file is not a chunk list: " + filePath);
+
+      std::string decodedKey = decodeKey(keyAES);
+      SegmentedAead::Reader reader(inFile, std::filesystem::file_size(filePath), decodedKey, cryptoPool_);
+      if (!reader.isChunkList())
+         throw std::runtime_error("Cipher file is not a chunk list: " + filePath);
+
+      std::string recipe = readChunkList(reader);
+      std::string index = reader.hasIndex() ? reader.readIndex() : "";
+
+      auto ctx = std::make_shared<SegmentedAead::Context>();
+      ctx->header.suite = reader.suite();
+      ctx->header.segmentSize = reader.segmentSize();
+      ctx->header.flags = reader.hasIndex() ? SegmentedAead::FLAG_INDEX : 0;
+
+      std::string material = std::to_string(recipe.size()) + ":" + recipe + index;
+      CryptoPP::HMAC<CryptoPP::SHA256> hmac(reinterpret_cast<const CryptoPP::byte *>(decodedKey.data()), decodedKey.size());
+      CryptoPP::byte mac[CryptoPP::SHA256::DIGESTSIZE];
+      hmac.CalculateDigest(mac, reinterpret_cast<const CryptoPP::byte *>(material.data()), material.size());
+      std::memcpy(ctx->header.noncePrefix.data(), mac, SegmentedAead::NONCE_PREFIX_SIZE);
+
+      ctx->encodedHeader = ctx->header.encode();
+      ctx->key = decodedKey;
+
+      ChunkStore &store = chunkStore();
+      std::uint64_t plainSize = ChunkStore::logicalSize(recipe);
+      return SegmentedAead::SealedView(ctx, plainSize,
+         [&store, recipe](std::uint64_t offset, std::uint64_t length, const ByteSink &out) {
+            store.read(recipe, offset, length, out);
+         },
+         cryptoPool_, index);
+   }
+
+   // Escribe un archivo segmentado en un temporal y lo renombra solo si todo salio bien
+   bool cipherToFile(const std::string &fileOutPath, const std::string &keyAES, bool withIndex, bool chunkList,
+                     const std::function<void(SegmentedAead::Writer &)> &body) {
+      std::string partPath = fileOutPath + ".part";
+      try {
+         // Decodificar clave desde Base64
+         std::string decodedKey = decodeKey(keyAES);
+
+         std::ofstream outFile(partPath, std::ios::binary);
+         if (!outFile)
+               throw std::runtime_error("Could not open output file: " + partPath);
+
+         {
+            SegmentedAead::Writer writer(decodedKey, segmentSize_, cryptoPool_, random_.generator(),
+               [&outFile](const char *data, std::size_t size) {
+                  outFile.write(data, size);
+               },
+               withIndex, cipherSuite_, chunkList);
+            body(writer);
+         }
+
+         outFile.close();
+         if (!outFile)
+               throw std::runtime_error("Could not write output file: " + partPath);
+
+         // Contenido en disco antes del rename y el rename antes de volver: quien llama puede confirmar
+         // en DB (p. ej. activar una generacion de clave) sin que un corte deje el archivo a medias
+         fsyncPath(partPath);
+         std::filesystem::rename(partPath, fileOutPath);
+         fsyncPath(std::filesystem::path(fileOutPath).parent_path().string());
+         return true;
+      } catch (const std::exception &e) {
+         std::error_code ec;
+         std::filesystem::remove(partPath, ec);
+         Log::error("Error during AES-GCM stream encryption", {{"error", e.what()}});
+         return false;
+      }
+   }
+
+   // Formato anterior: IV (12 bytes) || texto cifrado || tag (16 bytes), un solo mensaje GCM
+   void decipherLegacy(std::ifstream &inFile, std::uintmax_t fileSize, const std::string &decodedKey, std::ofstream &outFile) const {
+      // Extraer IV (primeros 12 bytes)
+      CryptoPP::SecByteBlock iv(12);
+      inFile.read(reinterpret_cast<char*>(iv.data()), iv.size());
+      if (inFile.gcount() != static_cast<std::streamsize>(iv.size()))
+         throw std::runtime_error("Cipher file is too short");
+
+      // Configurar descifrador AES-GCM
+      CryptoPP::GCM<CryptoPP::AES>::Decryption decryptor;
+      decryptor.SetKeyWithIV(
+         reinterpret_cast<const CryptoPP::byte*>(decodedKey.data()),
+         decodedKey.size(),
+         iv, iv.size()
+      );
+
+      // Descifrar el resto (texto cifrado + tag); lanza excepcion si el tag no coincide
+      CryptoPP::FileSource source(inFile, false,
+         new CryptoPP::AuthenticatedDecryptionFilter(decryptor,
+            new CryptoPP::FileSink(outFile)
+         )
+      );
+      pumpInChunks(source, fileSize - iv.size());
+   }
+
+   // Bombear la fuente en bloques acotados y cerrar el mensaje (el filtro GCM emite/verifica el tag en MessageEnd)
+   void pumpInChunks(CryptoPP::FileSource &source, std::uintmax_t totalBytes) const {
+      std::uintmax_t remaining = totalBytes;
+      while (remaining > 0 && !source.SourceExhausted()) {
+         std::uintmax_t chunk = std::min<std::uintmax_t>(remaining, streamBufferSize_);
+         source.Pump(chunk);
+         remaining -= chunk;
+      }
+      source.PumpAll();
+   }
 };
\ No newline at end of file
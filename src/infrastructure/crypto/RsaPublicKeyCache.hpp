@@ -0,0 +1,92 @@
+// infrastructure/crypto/RsaPublicKeyCache.hpp
+#pragma once
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cryptopp/base64.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/osrng.h>
+#include <cryptopp/rsa.h>
+#include <cryptopp/sha.h>
+#include "../cache/ShardedLruCache.hpp"
+
+// Cifradores RSA-OAEP(SHA-256) ya cargados, por huella de la clave publica (SHA-256 del DER).
+//
+// Decodificar el Base64, cargar el DER y validar la clave cuesta mucho mas que el propio
+// cifrado (una exponenciacion con e = 65537); con la cache cada envoltura de una clave AES
+// ya vista es solo el cifrado. La validacion completa (nivel 3) se hace al subir la clave
+// (SavePublicKeyRSAUseCase) y una vez mas la primera vez que se carga cada clave, asi las
+// claves guardadas antes de validar al subir tambien se revisan.
+class RsaPublicKeyCache {
+public:
+   using Encryptor = CryptoPP::RSAES<CryptoPP::OAEP<CryptoPP::SHA256>>::Encryptor;
+
+   // Las claves no cambian para una huella dada: el TTL solo limita cuanto vive una clave que ya nadie usa
+   explicit RsaPublicKeyCache(std::size_t capacity = 1024, std::size_t shards = 8)
+      : encryptors_(capacity, shards, std::chrono::hours(24)) {}
+
+   // Cifrador para la clave (DER en Base64); lanza std::runtime_error si la clave no es valida.
+   // El cifrador es inmutable: se puede usar desde varios hilos a la vez
+   std::shared_ptr<const Encryptor> encryptor(const std::string &publicKeyB64) {
+      std::string der = decodeBase64(publicKeyB64);
+      std::string print = fingerprint(der);
+
+      if (auto cached = encryptors_.get(print)) return *cached;
+
+      auto loaded = std::make_shared<const Encryptor>(load(der));
+      encryptors_.put(print, loaded);
+      return loaded;
+   }
+
+   // Validacion completa sin pasar por la cache (al subir la clave)
+   static bool isValid(const std::string &publicKeyB64) {
+      try {
+         load(decodeBase64(publicKeyB64));
+         return true;
+      } catch (const std::exception &) {
+         return false;
+      }
+   }
+
+   // Huella hex de la clave: SHA-256 del DER
+   static std::string fingerprint(const std::string &der) {
+      std::string print;
+      CryptoPP::SHA256 sha;
+      CryptoPP::StringSource ss(der, true,
+         new CryptoPP::HashFilter(sha,
+            new CryptoPP::HexEncoder(new CryptoPP::StringSink(print), false)));
+      return print;
+   }
+
+   // Texto Prometheus para /metrics
+   std::string renderPrometheus() const {
+      std::string out;
+      out += "# HELP rsa_key_cache_requests_total Parsed RSA public key lookups by result.\n";
+      out += "# TYPE rsa_key_cache_requests_total counter\n";
+      out += "rsa_key_cache_requests_total{result=\"hit\"} " + std::to_string(encryptors_.hits()) + "\n";
+      out += "rsa_key_cache_requests_total{result=\"miss\"} " + std::to_string(encryptors_.misses()) + "\n";
+      return out;
+   }
+
+private:
+   ShardedLruCache<std::string, std::shared_ptr<const Encryptor>> encryptors_;
+
+   static std::string decodeBase64(const std::string &b64) {
+      std::string der;
+      CryptoPP::StringSource ss(b64, true, new CryptoPP::Base64Decoder(new CryptoPP::StringSink(der)));
+      return der;
+   }
+
+   static CryptoPP::RSA::PublicKey load(const std::string &der) {
+      CryptoPP::RSA::PublicKey publicKey;
+      CryptoPP::StringSource ssLoad(der, true);
+      publicKey.Load(ssLoad);
+
+      CryptoPP::AutoSeededRandomPool rng;
+      if (!publicKey.Validate(rng, 3))
+         throw std::runtime_error("Invalid RSA public key");
+      return publicKey;
+   }
+};
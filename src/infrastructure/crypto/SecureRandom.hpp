@@ -0,0 +1,88 @@
+// infrastructure/crypto/SecureRandom.hpp
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <pthread.h>
+#include <cryptopp/osrng.h>
+
+// Generador criptografico para claves, IVs y relleno OAEP.
+//
+// AutoSeededRandomPool lee 32 bytes del sistema operativo al construirse; crear uno por llamada
+// (como se hacia en ProtectRepoCrypto) es una llamada al sistema y un rekey de AES en cada clave.
+// Aqui cada hilo tiene su propio pool, sin locks, y lo vuelve a sembrar desde el SO:
+//   - despues de reseedBytes bytes generados o reseedInterval de tiempo, lo que ocurra primero
+//   - en el proceso hijo despues de un fork(): el hijo heredaria el estado del padre y repetiria
+//     sus bytes; un manejador pthread_atfork cambia la generacion y el hijo re-siembra al usarlo.
+//
+// generator() es un CryptoPP::RandomNumberGenerator comun a todos los hilos (no tiene estado propio):
+// se puede pasar a Crypto++ y a los workers del pool de cifrado.
+class SecureRandom {
+public:
+   class Generator : public CryptoPP::RandomNumberGenerator {
+   public:
+      explicit Generator(const SecureRandom &owner) : owner_(owner) {}
+
+      void GenerateBlock(CryptoPP::byte *output, std::size_t size) override {
+         Local &local = owner_.local();
+         local.pool.GenerateBlock(output, size);
+         local.bytesSinceSeed += size;
+      }
+
+   private:
+      const SecureRandom &owner_;
+   };
+
+   explicit SecureRandom(std::uint64_t reseedBytes = 1 << 20,
+                         std::chrono::seconds reseedInterval = std::chrono::seconds(60))
+      : reseedBytes_(reseedBytes), reseedInterval_(reseedInterval), generator_(*this) {
+      static std::once_flag atforkRegistered;
+      std::call_once(atforkRegistered, [] {
+         pthread_atfork(nullptr, nullptr, [] { forkGeneration().fetch_add(1, std::memory_order_relaxed); });
+      });
+   }
+
+   SecureRandom(const SecureRandom &) = delete;
+   SecureRandom &operator=(const SecureRandom &) = delete;
+
+   CryptoPP::RandomNumberGenerator &generator() { return generator_; }
+
+   // Re-siembras hechas por todos los hilos (la primera de cada hilo no cuenta)
+   std::uint64_t reseeds() const { return reseeds_.load(std::memory_order_relaxed); }
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Local {
+      CryptoPP::AutoSeededRandomPool pool;   // sembrado desde el SO al crearse
+      std::uint64_t bytesSinceSeed = 0;
+      Clock::time_point seededAt = Clock::now();
+      std::uint64_t forkGeneration = SecureRandom::forkGeneration().load(std::memory_order_relaxed);
+   };
+
+   std::uint64_t reseedBytes_;
+   Clock::duration reseedInterval_;
+   Generator generator_;
+   mutable std::atomic<std::uint64_t> reseeds_{0};
+
+   static std::atomic<std::uint64_t> &forkGeneration() {
+      static std::atomic<std::uint64_t> generation{0};
+      return generation;
+   }
+
+   // Pool del hilo, re-sembrado si toca
+   Local &local() const {
+      thread_local Local local;
+      std::uint64_t generation = forkGeneration().load(std::memory_order_relaxed);
+      if (local.forkGeneration != generation || local.bytesSinceSeed >= reseedBytes_ ||
+          Clock::now() - local.seededAt >= reseedInterval_) {
+         local.pool.Reseed(false, 32);
+         local.bytesSinceSeed = 0;
+         local.seededAt = Clock::now();
+         local.forkGeneration = generation;
+         reseeds_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return local;
+   }
+};
@@ -0,0 +1,561 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cryptopp/aes.h>
+#include <cryptopp/chachapoly.h>
+#include <cryptopp/gcm.h>
+#include <cryptopp/osrng.h>
+#include "../concurrency/ThreadPool.hpp"
+#include "../../domain/utils/ByteStream.hpp"
+
+// Formato segmentado para los .tar.enc (version 1):
+//
+//   cabecera (20 bytes): "ORCA" | version (1) | suite (1) | flags (2) | tamaño de segmento (4, BE)
+//                        | prefijo de nonce (7) | reservado (1)
+//   segmentos:           texto cifrado | tag (16)   — todos de `tamaño de segmento` bytes de texto
+//                        plano menos el ultimo, que puede ser mas corto (o vacio)
+//
+// Cada segmento se sella con el AEAD de la suite (AES-256-GCM o ChaCha20-Poly1305, ambos con clave de
+// 32 bytes, nonce de 12 y tag de 16) usando nonce = prefijo (7) || indice (4, BE) || final (1)
+// y la cabecera como datos asociados. El byte "final" vale 1 solo en el ultimo segmento, asi que
+// un archivo truncado en un limite de segmento no verifica. Los segmentos son independientes:
+// se cifran/descifran en paralelo y se pueden verificar por separado.
+//
+// Con el flag FLAG_INDEX, despues del ultimo segmento va un bloque extra sellado con el indice
+// INDEX_SEGMENT (datos opacos para este formato, ej. el indice de archivos del tar) y al final
+// 8 bytes (BE) con la longitud de ese bloque sellado.
+//
+// Con el flag FLAG_CHUNKS el texto plano no es el contenido sino la lista de chunks que lo forman
+// (ver ChunkStore); como la cabecera va en los datos asociados, el flag no se puede quitar.
+namespace SegmentedAead {
+
+   constexpr std::size_t HEADER_SIZE = 20;
+   constexpr std::size_t NONCE_PREFIX_SIZE = 7;
+   constexpr std::size_t NONCE_SIZE = 12;
+   constexpr std::size_t TAG_SIZE = 16;
+   constexpr std::uint8_t VERSION = 1;
+   constexpr std::uint8_t SUITE_AES_256_GCM = 1;
+   constexpr std::uint8_t SUITE_CHACHA20_POLY1305 = 2;
+   constexpr std::uint16_t FLAG_INDEX = 0x0001;
+   constexpr std::uint16_t FLAG_CHUNKS = 0x0002;
+   constexpr std::uint32_t INDEX_SEGMENT = UINT32_MAX;
+   constexpr std::size_t INDEX_TRAILER_SIZE = 8;
+
+   struct Header {
+      std::uint8_t version = VERSION;
+      std::uint8_t suite = SUITE_AES_256_GCM;
+      std::uint16_t flags = 0;
+      std::uint32_t segmentSize = 0;
+      std::array<CryptoPP::byte, NONCE_PREFIX_SIZE> noncePrefix{};
+
+      std::array<char, HEADER_SIZE> encode() const {
+         std::array<char, HEADER_SIZE> out{};
+         std::memcpy(out.data(), "ORCA", 4);
+         out[4] = static_cast<char>(version);
+         out[5] = static_cast<char>(suite);
+         out[6] = static_cast<char>(flags >> 8);
+         out[7] = static_cast<char>(flags & 0xFF);
+         for (int i = 0; i < 4; ++i)
+            out[8 + i] = static_cast<char>((segmentSize >> (24 - 8 * i)) & 0xFF);
+         std::memcpy(out.data() + 12, noncePrefix.data(), NONCE_PREFIX_SIZE);
+         return out;
+      }
+
+      // false si los bytes no son una cabecera segmentada (archivo con el formato anterior)
+      static bool decode(const char *data, std::size_t size, Header &header) {
+         if (size < HEADER_SIZE || std::memcmp(data, "ORCA", 4) != 0) return false;
+         const auto *bytes = reinterpret_cast<const unsigned char*>(data);
+         if (bytes[4] != VERSION) return false;
+
+         header.version = bytes[4];
+         header.suite = bytes[5];
+         header.flags = static_cast<std::uint16_t>((bytes[6] << 8) | bytes[7]);
+         header.segmentSize = (std::uint32_t(bytes[8]) << 24) | (std::uint32_t(bytes[9]) << 16) |
+                              (std::uint32_t(bytes[10]) << 8) | std::uint32_t(bytes[11]);
+         std::memcpy(header.noncePrefix.data(), bytes + 12, NONCE_PREFIX_SIZE);
+         return header.segmentSize > 0;
+      }
+   };
+
+   inline bool isSupportedSuite(std::uint8_t suite) {
+      return suite == SUITE_AES_256_GCM || suite == SUITE_CHACHA20_POLY1305;
+   }
+
+   inline std::string suiteName(std::uint8_t suite) {
+      if (suite == SUITE_AES_256_GCM) return "aes-256-gcm";
+      if (suite == SUITE_CHACHA20_POLY1305) return "chacha20-poly1305";
+      return "unknown-" + std::to_string(suite);
+   }
+
+   inline std::array<CryptoPP::byte, NONCE_SIZE> segmentNonce(const Header &header, std::uint32_t index, bool last) {
+      std::array<CryptoPP::byte, NONCE_SIZE> nonce{};
+      std::memcpy(nonce.data(), header.noncePrefix.data(), NONCE_PREFIX_SIZE);
+      for (int i = 0; i < 4; ++i)
+         nonce[NONCE_PREFIX_SIZE + i] = static_cast<CryptoPP::byte>((index >> (24 - 8 * i)) & 0xFF);
+      nonce[NONCE_SIZE - 1] = last ? 1 : 0;
+      return nonce;
+   }
+
+   // Datos compartidos por las tareas de un mismo archivo
+   struct Context {
+      Header header;
+      std::array<char, HEADER_SIZE> encodedHeader;
+      std::string key;
+   };
+
+   template <class Encryption>
+   std::string sealWith(const Context &ctx, std::uint32_t index, bool last, const std::string &plain) {
+      auto nonce = segmentNonce(ctx.header, index, last);
+
+      Encryption encryptor;
+      encryptor.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte*>(ctx.key.data()), ctx.key.size(),
+                             nonce.data(), nonce.size());
+
+      std::string sealed(plain.size() + TAG_SIZE, '\0');
+      auto *out = reinterpret_cast<CryptoPP::byte*>(&sealed[0]);
+      encryptor.EncryptAndAuthenticate(out, out + plain.size(), TAG_SIZE,
+                                       nonce.data(), static_cast<int>(nonce.size()),
+                                       reinterpret_cast<const CryptoPP::byte*>(ctx.encodedHeader.data()), HEADER_SIZE,
+                                       reinterpret_cast<const CryptoPP::byte*>(plain.data()), plain.size());
+      return sealed;
+   }
+
+   template <class Decryption>
+   std::string openWith(const Context &ctx, std::uint32_t index, bool last, const std::string &sealed) {
+      if (sealed.size() < TAG_SIZE)
+         throw std::runtime_error("Truncated segment " + std::to_string(index));
+
+      auto nonce = segmentNonce(ctx.header, index, last);
+
+      Decryption decryptor;
+      decryptor.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte*>(ctx.key.data()), ctx.key.size(),
+                             nonce.data(), nonce.size());
+
+      std::size_t plainSize = sealed.size() - TAG_SIZE;
+      std::string plain(plainSize, '\0');
+      const auto *in = reinterpret_cast<const CryptoPP::byte*>(sealed.data());
+      bool ok = decryptor.DecryptAndVerify(reinterpret_cast<CryptoPP::byte*>(&plain[0]),
+                                           in + plainSize, TAG_SIZE,
+                                           nonce.data(), static_cast<int>(nonce.size()),
+                                           reinterpret_cast<const CryptoPP::byte*>(ctx.encodedHeader.data()), HEADER_SIZE,
+                                           in, plainSize);
+      if (!ok)
+         throw std::runtime_error("Segment " + std::to_string(index) + " failed authentication");
+      return plain;
+   }
+
+   inline std::string sealSegment(const Context &ctx, std::uint32_t index, bool last, const std::string &plain) {
+      if (ctx.header.suite == SUITE_CHACHA20_POLY1305)
+         return sealWith<CryptoPP::ChaCha20Poly1305::Encryption>(ctx, index, last, plain);
+      return sealWith<CryptoPP::GCM<CryptoPP::AES>::Encryption>(ctx, index, last, plain);
+   }
+
+   inline std::string openSegment(const Context &ctx, std::uint32_t index, bool last, const std::string &sealed) {
+      if (ctx.header.suite == SUITE_CHACHA20_POLY1305)
+         return openWith<CryptoPP::ChaCha20Poly1305::Decryption>(ctx, index, last, sealed);
+      return openWith<CryptoPP::GCM<CryptoPP::AES>::Decryption>(ctx, index, last, sealed);
+   }
+
+
+   // Cifrado en streaming: write() acumula texto plano, cada segmento lleno se sella en el pool
+   // y los resultados se escriben en orden al sink (como mucho 2*hilos+1 segmentos en memoria)
+   class Writer {
+   public:
+      Writer(const std::string &key, std::uint32_t segmentSize, ThreadPool &pool,
+             CryptoPP::RandomNumberGenerator &rng, ByteSink out, bool withIndex = false,
+             std::uint8_t suite = SUITE_AES_256_GCM, bool chunkList = false)
+         : out_(std::move(out)), pool_(pool), maxInFlight_(2 * pool.size() + 1) {
+         if (!isSupportedSuite(suite))
+            throw std::runtime_error("Unsupported cipher suite: " + std::to_string(suite));
+
+         auto ctx = std::make_shared<Context>();
+         ctx->header.suite = suite;
+         ctx->header.segmentSize = segmentSize;
+         ctx->header.flags = static_cast<std::uint16_t>((withIndex ? FLAG_INDEX : 0) | (chunkList ? FLAG_CHUNKS : 0));
+         rng.GenerateBlock(ctx->header.noncePrefix.data(), NONCE_PREFIX_SIZE);
+         ctx->encodedHeader = ctx->header.encode();
+         ctx->key = key;
+         ctx_ = ctx;
+
+         current_.reserve(segmentSize);
+         out_(ctx_->encodedHeader.data(), HEADER_SIZE);
+      }
+
+      Writer(const Writer &) = delete;
+      Writer &operator=(const Writer &) = delete;
+
+      ~Writer() {
+         for (auto &pending : inFlight_) {
+            if (pending.valid()) pending.wait();
+         }
+      }
+
+      void write(const char *data, std::size_t size) {
+         const std::size_t segmentSize = ctx_->header.segmentSize;
+         while (size > 0) {
+            // El segmento lleno se sella cuando llegan mas datos: asi se sabe que no es el ultimo
+            if (current_.size() == segmentSize) seal(false);
+
+            std::size_t take = std::min(segmentSize - current_.size(), size);
+            current_.append(data, take);
+            data += take;
+            size -= take;
+         }
+      }
+
+      void finish() {
+         if (ctx_->header.flags & FLAG_INDEX)
+            throw std::runtime_error("This segmented file requires an index");
+         finishData();
+      }
+
+      // Cerrar los datos y agregar el bloque de indice (solo si se creo con withIndex)
+      void finish(const std::string &index) {
+         if (!(ctx_->header.flags & FLAG_INDEX))
+            throw std::runtime_error("This segmented file was created without an index");
+         finishData();
+
+         std::string sealed = sealSegment(*ctx_, INDEX_SEGMENT, true, index);
+         out_(sealed.data(), sealed.size());
+
+         char trailer[INDEX_TRAILER_SIZE];
+         std::uint64_t length = sealed.size();
+         for (std::size_t i = 0; i < INDEX_TRAILER_SIZE; ++i)
+            trailer[i] = static_cast<char>((length >> (56 - 8 * i)) & 0xFF);
+         out_(trailer, INDEX_TRAILER_SIZE);
+      }
+
+      ByteSink sink() {
+         return [this](const char *data, std::size_t size) { write(data, size); };
+      }
+
+   private:
+      ByteSink out_;
+      ThreadPool &pool_;
+      std::size_t maxInFlight_;
+      std::shared_ptr<const Context> ctx_;
+      std::string current_;
+      std::uint32_t nextIndex_ = 0;
+      std::deque<std::future<std::string>> inFlight_;
+      bool finished_ = false;
+
+      void finishData() {
+         if (finished_)
+            throw std::runtime_error("Segmented stream already finished");
+         seal(true);
+         while (!inFlight_.empty()) emitOldest();
+         finished_ = true;
+      }
+
+      void seal(bool last) {
+         if (nextIndex_ == UINT32_MAX)
+            throw std::runtime_error("Too many segments for the segmented cipher format");
+
+         auto plain = std::make_shared<std::string>(std::move(current_));
+         current_.clear();
+         current_.reserve(ctx_->header.segmentSize);
+
+         std::shared_ptr<const Context> ctx = ctx_;
+         std::uint32_t index = nextIndex_++;
+         inFlight_.push_back(pool_.submit([ctx, index, last, plain] {
+            return sealSegment(*ctx, index, last, *plain);
+         }));
+
+         while (inFlight_.size() >= maxInFlight_) emitOldest();
+      }
+
+      void emitOldest() {
+         std::string sealed = inFlight_.front().get();
+         inFlight_.pop_front();
+         out_(sealed.data(), sealed.size());
+      }
+   };
+
+
+   // Archivo segmentado sin escribir: el resultado de sellar plainSize bytes de texto plano (que se piden
+   // a `read`) con un contexto fijo. emit() produce cualquier rango de sus bytes sellando solo los segmentos
+   // que lo cubren; con el mismo contexto (nonce incluido) la salida es identica en cada llamada, asi que
+   // una respuesta por rangos arma el mismo archivo que una completa.
+   class SealedView {
+   public:
+      using PlainReader = std::function<void(std::uint64_t offset, std::uint64_t length, const ByteSink &out)>;
+
+      // index solo se usa si el contexto tiene FLAG_INDEX
+      SealedView(std::shared_ptr<const Context> ctx, std::uint64_t plainSize, PlainReader read,
+                 ThreadPool &pool, const std::string &index = "")
+         : ctx_(std::move(ctx)), plainSize_(plainSize), read_(std::move(read)), pool_(pool),
+           maxInFlight_(2 * pool.size() + 1) {
+         std::uint64_t segmentSize = ctx_->header.segmentSize;
+         segmentCount_ = plainSize_ == 0 ? 1 : (plainSize_ + segmentSize - 1) / segmentSize;
+         if (segmentCount_ >= UINT32_MAX)
+            throw std::runtime_error("Too many segments for the segmented cipher format");
+
+         dataEnd_ = HEADER_SIZE + plainSize_ + segmentCount_ * TAG_SIZE;
+         size_ = dataEnd_;
+         if (ctx_->header.flags & FLAG_INDEX) {
+            sealedIndex_ = sealSegment(*ctx_, INDEX_SEGMENT, true, index);
+            size_ += sealedIndex_.size() + INDEX_TRAILER_SIZE;
+         }
+      }
+
+      std::uint64_t size() const { return size_; }
+
+      // Emite exactamente los bytes [offset, offset + length) del archivo sellado
+      void emit(std::uint64_t offset, std::uint64_t length, const ByteSink &out) const {
+         if (offset > size_ || length > size_ - offset)
+            throw std::runtime_error("Requested range is past the end of the sealed file");
+         const std::uint64_t end = offset + length;
+
+         // Cada parte del archivo empieza en `at`: se emite solo lo que cae dentro del rango
+         auto part = [&](const char *data, std::uint64_t partSize, std::uint64_t at) {
+            std::uint64_t from = std::max(at, offset);
+            std::uint64_t to = std::min(at + partSize, end);
+            if (from < to) out(data + (from - at), static_cast<std::size_t>(to - from));
+         };
+
+         part(ctx_->encodedHeader.data(), HEADER_SIZE, 0);
+         if (offset < dataEnd_ && end > HEADER_SIZE) emitSegments(offset, end, part);
+
+         if (ctx_->header.flags & FLAG_INDEX) {
+            part(sealedIndex_.data(), sealedIndex_.size(), dataEnd_);
+
+            char trailer[INDEX_TRAILER_SIZE];
+            std::uint64_t indexLength = sealedIndex_.size();
+            for (std::size_t i = 0; i < INDEX_TRAILER_SIZE; ++i)
+               trailer[i] = static_cast<char>((indexLength >> (56 - 8 * i)) & 0xFF);
+            part(trailer, INDEX_TRAILER_SIZE, dataEnd_ + sealedIndex_.size());
+         }
+      }
+
+   private:
+      std::shared_ptr<const Context> ctx_;
+      std::uint64_t plainSize_;
+      PlainReader read_;
+      ThreadPool &pool_;
+      std::size_t maxInFlight_;
+      std::uint64_t segmentCount_ = 0;
+      std::uint64_t dataEnd_ = 0;
+      std::uint64_t size_ = 0;
+      std::string sealedIndex_;
+
+      // Lee el texto plano de los segmentos que tocan [offset, end), los sella en el pool y los pasa en orden a part
+      template <class Part>
+      void emitSegments(std::uint64_t offset, std::uint64_t end, Part &part) const {
+         const std::uint64_t segmentSize = ctx_->header.segmentSize;
+         const std::uint64_t sealedSegment = segmentSize + TAG_SIZE;
+         std::uint64_t first = (std::max<std::uint64_t>(offset, HEADER_SIZE) - HEADER_SIZE) / sealedSegment;
+         std::uint64_t last = (std::min(end, dataEnd_) - HEADER_SIZE - 1) / sealedSegment;
+         std::uint64_t plainStart = first * segmentSize;
+         std::uint64_t plainEnd = std::min(plainSize_, (last + 1) * segmentSize);
+
+         std::deque<std::future<std::string>> inFlight;
+         std::uint64_t nextIndex = first;
+         std::uint64_t emitIndex = first;
+         std::string current;
+
+         auto emitOldest = [&] {
+            std::string sealed = inFlight.front().get();
+            inFlight.pop_front();
+            part(sealed.data(), sealed.size(), HEADER_SIZE + emitIndex++ * sealedSegment);
+         };
+         auto seal = [&] {
+            auto plain = std::make_shared<std::string>(std::move(current));
+            current.clear();
+
+            std::shared_ptr<const Context> ctx = ctx_;
+            std::uint32_t index = static_cast<std::uint32_t>(nextIndex++);
+            bool lastSegment = index + 1 == segmentCount_;
+            inFlight.push_back(pool_.submit([ctx, index, lastSegment, plain] {
+               return sealSegment(*ctx, index, lastSegment, *plain);
+            }));
+            while (inFlight.size() >= maxInFlight_) emitOldest();
+         };
+
+         try {
+            read_(plainStart, plainEnd - plainStart, [&](const char *data, std::size_t size) {
+               while (size > 0) {
+                  std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(segmentSize - current.size(), size));
+                  current.append(data, take);
+                  data += take;
+                  size -= take;
+                  if (current.size() == segmentSize) seal();
+               }
+            });
+            // Ultimo segmento corto (o vacio si no hay contenido)
+            if (nextIndex <= last) seal();
+            if (nextIndex != last + 1 || !current.empty())
+               throw std::runtime_error("Plain text source does not match the sealed file size");
+
+            while (!inFlight.empty()) emitOldest();
+         } catch (...) {
+            for (auto &pending : inFlight) pending.wait();
+            throw;
+         }
+      }
+   };
+
+
+   // Descifrado: lee los segmentos del stream, los verifica en el pool y emite el texto
+   // plano en orden. Un segmento solo se emite despues de verificar su tag.
+   class Reader {
+   public:
+      // `in` debe estar posicionado al inicio del archivo; fileSize es el tamaño total
+      Reader(std::istream &in, std::uint64_t fileSize, const std::string &key, ThreadPool &pool)
+         : in_(in), pool_(pool), maxInFlight_(2 * pool.size() + 1) {
+         char raw[HEADER_SIZE];
+         in_.read(raw, HEADER_SIZE);
+         auto ctx = std::make_shared<Context>();
+         if (in_.gcount() != static_cast<std::streamsize>(HEADER_SIZE) || !Header::decode(raw, HEADER_SIZE, ctx->header))
+            throw std::runtime_error("Not a segmented cipher file");
+         if (!isSupportedSuite(ctx->header.suite))
+            throw std::runtime_error("Unsupported cipher suite: " + std::to_string(ctx->header.suite));
+
+         std::memcpy(ctx->encodedHeader.data(), raw, HEADER_SIZE);
+         ctx->key = key;
+         ctx_ = ctx;
+
+         std::uint64_t dataSize = fileSize - HEADER_SIZE;
+         if (ctx_->header.flags & FLAG_INDEX) {
+            // Trailer: longitud del bloque de indice sellado
+            if (dataSize < INDEX_TRAILER_SIZE)
+               throw std::runtime_error("Segmented cipher file is truncated");
+            unsigned char trailer[INDEX_TRAILER_SIZE];
+            in_.seekg(static_cast<std::streamoff>(fileSize - INDEX_TRAILER_SIZE));
+            in_.read(reinterpret_cast<char*>(trailer), INDEX_TRAILER_SIZE);
+            if (in_.gcount() != static_cast<std::streamsize>(INDEX_TRAILER_SIZE))
+               throw std::runtime_error("Segmented cipher file is truncated");
+
+            std::uint64_t indexLength = 0;
+            for (unsigned char byte : trailer) indexLength = (indexLength << 8) | byte;
+            if (indexLength < TAG_SIZE || indexLength > dataSize - INDEX_TRAILER_SIZE)
+               throw std::runtime_error("Invalid index length in segmented cipher file");
+
+            dataSize -= INDEX_TRAILER_SIZE + indexLength;
+            indexOffset_ = HEADER_SIZE + dataSize;
+            indexLength_ = indexLength;
+         }
+
+         std::uint64_t sealedSegment = std::uint64_t(ctx_->header.segmentSize) + TAG_SIZE;
+         segmentCount_ = dataSize == 0 ? 0 : (dataSize + sealedSegment - 1) / sealedSegment;
+         lastSealedSize_ = dataSize - (segmentCount_ ? (segmentCount_ - 1) * sealedSegment : 0);
+         if (segmentCount_ == 0 || lastSealedSize_ < TAG_SIZE)
+            throw std::runtime_error("Segmented cipher file is truncated");
+      }
+
+      // Verdadero si el stream empieza con una cabecera segmentada (no consume bytes)
+      static bool isSegmented(std::istream &in) {
+         char raw[HEADER_SIZE];
+         std::streampos start = in.tellg();
+         in.read(raw, HEADER_SIZE);
+         std::streamsize got = in.gcount();
+         in.clear();
+         in.seekg(start);
+         Header header;
+         return Header::decode(raw, static_cast<std::size_t>(got), header);
+      }
+
+      std::uint64_t segmentCount() const { return segmentCount_; }
+      std::uint32_t segmentSize() const { return ctx_->header.segmentSize; }
+      std::uint8_t suite() const { return ctx_->header.suite; }
+      bool hasIndex() const { return (ctx_->header.flags & FLAG_INDEX) != 0; }
+      bool isChunkList() const { return (ctx_->header.flags & FLAG_CHUNKS) != 0; }
+
+      // Descifra y verifica el bloque de indice
+      std::string readIndex() {
+         if (!hasIndex())
+            throw std::runtime_error("Segmented cipher file has no index");
+
+         std::string sealed(indexLength_, '\0');
+         in_.clear();
+         in_.seekg(static_cast<std::streamoff>(indexOffset_));
+         in_.read(&sealed[0], static_cast<std::streamsize>(sealed.size()));
+         if (in_.gcount() != static_cast<std::streamsize>(sealed.size()))
+            throw std::runtime_error("Segmented cipher file is truncated");
+         return openSegment(*ctx_, INDEX_SEGMENT, true, sealed);
+      }
+
+      // Descifra solo los segmentos que cubren [offset, offset + length) del texto plano
+      // y emite exactamente esos bytes
+      void decryptRange(std::uint64_t offset, std::uint64_t length, const ByteSink &out) {
+         if (length == 0) return;
+         std::uint64_t segmentSize = ctx_->header.segmentSize;
+         std::uint64_t first = offset / segmentSize;
+         std::uint64_t last = (offset + length - 1) / segmentSize;
+
+         std::uint64_t toSkip = offset - first * segmentSize;
+         std::uint64_t remaining = length;
+         decrypt(first, last - first + 1, [&](const char *data, std::size_t size) {
+            std::uint64_t skipped = std::min<std::uint64_t>(toSkip, size);
+            toSkip -= skipped;
+            std::uint64_t emit = std::min<std::uint64_t>(size - skipped, remaining);
+            if (emit > 0) out(data + skipped, static_cast<std::size_t>(emit));
+            remaining -= emit;
+         });
+
+         if (remaining > 0)
+            throw std::runtime_error("Requested range is past the end of the cipher file");
+      }
+
+      // Descifra los segmentos [first, first + count)
+      void decrypt(std::uint64_t first, std::uint64_t count, const ByteSink &out) {
+         if (first + count > segmentCount_)
+            throw std::runtime_error("Segment range out of bounds");
+
+         std::uint64_t sealedSegment = std::uint64_t(ctx_->header.segmentSize) + TAG_SIZE;
+         in_.clear();
+         in_.seekg(static_cast<std::streamoff>(HEADER_SIZE + first * sealedSegment));
+
+         std::deque<std::future<std::string>> inFlight;
+         try {
+            for (std::uint64_t index = first; index < first + count; ++index) {
+               bool last = index + 1 == segmentCount_;
+               auto sealed = std::make_shared<std::string>(last ? lastSealedSize_ : sealedSegment, '\0');
+               in_.read(&(*sealed)[0], static_cast<std::streamsize>(sealed->size()));
+               if (in_.gcount() != static_cast<std::streamsize>(sealed->size()))
+                  throw std::runtime_error("Segmented cipher file is truncated");
+
+               std::shared_ptr<const Context> ctx = ctx_;
+               std::uint32_t segIndex = static_cast<std::uint32_t>(index);
+               inFlight.push_back(pool_.submit([ctx, segIndex, last, sealed] {
+                  return openSegment(*ctx, segIndex, last, *sealed);
+               }));
+
+               while (inFlight.size() >= maxInFlight_) {
+                  std::string plain = inFlight.front().get();
+                  inFlight.pop_front();
+                  out(plain.data(), plain.size());
+               }
+            }
+            while (!inFlight.empty()) {
+               std::string plain = inFlight.front().get();
+               inFlight.pop_front();
+               out(plain.data(), plain.size());
+            }
+         } catch (...) {
+            for (auto &pending : inFlight) pending.wait();
+            throw;
+         }
+      }
+
+      void decryptAll(const ByteSink &out) { decrypt(0, segmentCount_, out); }
+
+   private:
+      std::istream &in_;
+      ThreadPool &pool_;
+      std::size_t maxInFlight_;
+      std::shared_ptr<const Context> ctx_;
+      std::uint64_t segmentCount_ = 0;
+      std::uint64_t lastSealedSize_ = 0;
+      std::uint64_t indexOffset_ = 0;
+      std::uint64_t indexLength_ = 0;
+   };
+}
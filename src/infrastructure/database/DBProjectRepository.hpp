@@ -1,24 +1,30 @@
 #pragma once
+#include <set>
+#include <string>
+#include <vector>
 #include <soci/soci.h>
 #include <soci/mysql/soci-mysql.h>
+#include "DBSessionPool.hpp"
+#include "../logging/Log.hpp"
 #include "../../domain/repositories/IProjectDB.repository.hpp"
 
 class DBProjectRepository : public IProjectRepositoryDB {
 public:
-   explicit DBProjectRepository(soci::session &sqlSession)
-      : sql_(sqlSession) {}
+   explicit DBProjectRepository(DBSessionPool &sessionPool)
+      : pool_(sessionPool) {}
 
 
    std::optional<Repository> findById(int idProject) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       soci::row row;
-      sql_ << "SELECT idproject, projectname, description, idowner "
+      *sql << "SELECT idproject, projectname, description, idowner "
                "FROM projects "
                "WHERE idproject = :idProject "
                "LIMIT 1",
             soci::into(row),
             soci::use(idProject, "idProject");
 
-      if (!sql_.got_data()) {
+      if (!sql->got_data()) {
          return std::nullopt;
       }
 
@@ -32,15 +38,16 @@ public:
    }
       
    std::optional<Repository> findByName(const std::string &name) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       soci::row row;
-      sql_ << "SELECT idproject, projectname, description, idowner "
+      *sql << "SELECT idproject, projectname, description, idowner "
                "FROM projects "
                "WHERE projectname = :name "
                "LIMIT 1",
             soci::into(row),
             soci::use(name, "name");
 
-      if (!sql_.got_data()) {
+      if (!sql->got_data()) {
          return std::nullopt;
       }
 
@@ -54,10 +61,11 @@ public:
    }
 
    Repository create(const std::string &name, const std::string &description, int ownerId) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
          int idProject = 0;
 
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "INSERT INTO projects (projectname, description, idowner) "
             "VALUES (:name, :description, :ownerId)",
             soci::use(name,        "name"),
@@ -68,7 +76,7 @@ public:
          st.execute(true);
 
          // Recuperar id autoincremental
-         sql_ << "SELECT LAST_INSERT_ID()", soci::into(idProject);
+         *sql << "SELECT LAST_INSERT_ID()", soci::into(idProject);
 
          Repository p;
          p.idProject   = idProject;
@@ -80,14 +88,15 @@ public:
 
       } catch (const std::exception &e) {
          // opcional: loggear
-         std::cerr << "[DBProjectRepository::create] " << e.what() << "\n";
+         Log::error("DBProjectRepository::create failed", {{"error", e.what()}});
          throw; // que suba la excepción al caso de uso
       }
    }
 
    bool deleteRepositoryById(int idProject) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "DELETE FROM projects WHERE idproject = :idProject",
             soci::use(idProject, "idProject")
          );
@@ -97,14 +106,15 @@ public:
          return affected == 1;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::deleteRepositoryById] " << e.what() << "\n";
+         Log::error("DBProjectRepository::deleteRepositoryById failed", {{"error", e.what()}});
          return false;
       }
    }
 
    bool deleteRepositoryByName(const std::string &name) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "DELETE FROM projects WHERE projectname = :name",
             soci::use(name, "name")
          );
@@ -114,16 +124,17 @@ public:
          return affected == 1;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::deleteRepositoryByName] " << e.what() << "\n";
+         Log::error("DBProjectRepository::deleteRepositoryByName failed", {{"error", e.what()}});
          return false;
       }
    }
 
    
    bool existsUserInProject(int idProject, int idUser) {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
          int count = 0;
-         sql_ << "SELECT COUNT(*) FROM users_has_projects WHERE idproject = :idProject AND iduser = :idUser",
+         *sql << "SELECT COUNT(*) FROM users_has_projects WHERE idproject = :idProject AND iduser = :idUser",
             soci::into(count),
             soci::use(idProject, "idProject"),
             soci::use(idUser,    "idUser");
@@ -131,14 +142,15 @@ public:
          return count > 0;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::existsUserInProject] " << e.what() << "\n";
+         Log::error("DBProjectRepository::existsUserInProject failed", {{"error", e.what()}});
          return false;
       }
    }
 
    bool addUserToProject(int idProject, int idUser) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "INSERT INTO users_has_projects (iduser, idproject) "
             "VALUES (:idUser, :idProject)",
             soci::use(idUser,    "idUser"),
@@ -149,47 +161,266 @@ public:
          return affected == 1;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::addUserToProject] " << e.what() << "\n";
+         Log::error("DBProjectRepository::addUserToProject failed", {{"error", e.what()}});
          return false;
       }
    }
 
 
-   bool addPassword_repo_user(int idUser, int idproject, std::string password, std::string projectAlias) override {
+   bool addPassword_repo_user(int idUser, int idproject, std::string password, std::string projectAlias,
+                              WrapAlgorithm algorithm = WrapAlgorithm::RSA_OAEP, std::uint32_t keyGeneration = 0) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
-            "INSERT INTO repo_protect (iduser, idproject, rsa_aes, project_alias) "
-            "VALUES (:idUser, :idproject, :password, :projectAlias)",
+         std::string wrapAlg = wrapAlgorithmName(algorithm);
+         long long generation = keyGeneration;
+         soci::statement st = (sql->prepare <<
+            "INSERT INTO repo_protect (iduser, idproject, rsa_aes, project_alias, wrap_alg, key_generation) "
+            "VALUES (:idUser, :idproject, :password, :projectAlias, :wrapAlg, :keyGeneration)",
             soci::use(idUser,   "idUser"),
             soci::use(idproject,"idproject"),
             soci::use(password, "password"),
-            soci::use(projectAlias, "projectAlias")
+            soci::use(projectAlias, "projectAlias"),
+            soci::use(wrapAlg, "wrapAlg"),
+            soci::use(generation, "keyGeneration")
          );
          st.execute(true);
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::addPassword_repo_user] " << e.what() << "\n";
+         Log::error("DBProjectRepository::addPassword_repo_user failed", {{"error", e.what()}});
+         return false;
+      }
+   }
+
+   bool addPasswords_repo_users(int idproject, const std::string &projectAlias, const std::vector<WrappedKey> &wrappedKeys) override {
+      if (wrappedKeys.empty()) return true;
+
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         soci::transaction tr(*sql);
+         if (!insertWrappedKeys(*sql, idproject, projectAlias, wrappedKeys)) {
+            tr.rollback();
+            return false;
+         }
+         tr.commit();
+         return true;
+
+      } catch (const std::exception &e) {
+         // el destructor de la transaccion hace rollback
+         Log::error("DBProjectRepository::addPasswords_repo_users failed", {{"error", e.what()}, {"alias", projectAlias}});
+         return false;
+      }
+   }
+
+   std::optional<std::uint32_t> findKeyGeneration(const std::string &projectAlias) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         long long generation = 0;
+         soci::indicator ind = soci::i_null;
+         *sql << "SELECT MAX(key_generation) FROM repo_protect WHERE project_alias = :projectAlias",
+            soci::into(generation, ind),
+            soci::use(projectAlias, "projectAlias");
+
+         if (!sql->got_data() || ind == soci::i_null) return std::nullopt;
+         return static_cast<std::uint32_t>(generation);
+
+      } catch (const std::exception &e) {
+         Log::error("DBProjectRepository::findKeyGeneration failed", {{"error", e.what()}, {"alias", projectAlias}});
+         return std::nullopt;
+      }
+   }
+
+   std::vector<ProtectedAlias> findProtectedAliases() override {
+      std::vector<ProtectedAlias> aliases;
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         std::string repoName;
+         std::string fullAlias;
+         long long generation = 0;
+         soci::statement st = (sql->prepare <<
+            "SELECT p.projectname, rp.project_alias, MAX(rp.key_generation) "
+            "FROM repo_protect rp JOIN projects p ON p.idproject = rp.idproject "
+            "GROUP BY p.projectname, rp.project_alias",
+            soci::into(repoName),
+            soci::into(fullAlias),
+            soci::into(generation));
+         st.execute(false);
+         while (st.fetch()) {
+            // project_alias guarda <repo>_<alias>
+            std::string prefix = repoName + "_";
+            if (fullAlias.compare(0, prefix.size(), prefix) != 0) continue;
+            aliases.push_back(ProtectedAlias{repoName, fullAlias.substr(prefix.size()), static_cast<std::uint32_t>(generation)});
+         }
+
+      } catch (const std::exception &e) {
+         Log::error("DBProjectRepository::findProtectedAliases failed", {{"error", e.what()}});
+         aliases.clear();
+      }
+      return aliases;
+   }
+
+   bool rewrapPasswords_repo_users(const std::string &projectAlias, std::uint32_t keyGeneration,
+                                   const std::vector<WrappedKey> &wrappedKeys, int revokedUser = 0) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         soci::transaction tr(*sql);
+
+         // Filas actuales, bloqueadas hasta el commit
+         std::set<int> current;
+         int idUser = 0;
+         soci::statement select = (sql->prepare <<
+            "SELECT iduser FROM repo_protect WHERE project_alias = :projectAlias FOR UPDATE",
+            soci::into(idUser),
+            soci::use(projectAlias, "projectAlias"));
+         select.execute(false);
+         while (select.fetch()) current.insert(idUser);
+
+         std::set<int> rewrapped;
+         for (const WrappedKey &row : wrappedKeys) rewrapped.insert(row.idUser);
+         for (int holder : current) {
+            if (holder != revokedUser && !rewrapped.count(holder)) {
+               tr.rollback();
+               Log::error("DBProjectRepository::rewrapPasswords_repo_users: key holder without a new key",
+                          {{"alias", projectAlias}, {"iduser", holder}});
+               return false;
+            }
+         }
+
+         if (revokedUser != 0 && current.count(revokedUser)) {
+            *sql << "DELETE FROM repo_protect WHERE project_alias = :projectAlias AND iduser = :idUser",
+               soci::use(projectAlias, "projectAlias"),
+               soci::use(revokedUser, "idUser");
+         }
+
+         // Solo las filas que siguen existiendo (una quitada mientras tanto no vuelve)
+         long long generation = keyGeneration;
+         for (const WrappedKey &row : wrappedKeys) {
+            if (!current.count(row.idUser) || row.idUser == revokedUser) continue;
+            std::string wrapAlg = wrapAlgorithmName(row.algorithm);
+            *sql << "UPDATE repo_protect SET rsa_aes = :wrapped, wrap_alg = :wrapAlg, key_generation = :keyGeneration "
+                    "WHERE project_alias = :projectAlias AND iduser = :idUser",
+               soci::use(row.rsaAes, "wrapped"),
+               soci::use(wrapAlg, "wrapAlg"),
+               soci::use(generation, "keyGeneration"),
+               soci::use(projectAlias, "projectAlias"),
+               soci::use(row.idUser, "idUser");
+         }
+         tr.commit();
+         return true;
+
+      } catch (const std::exception &e) {
+         // el destructor de la transaccion hace rollback
+         Log::error("DBProjectRepository::rewrapPasswords_repo_users failed", {{"error", e.what()}, {"alias", projectAlias}});
          return false;
       }
    }
 
    bool existsRepoAlias(const std::string &projectAlias) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
          int count = 0;
-         sql_ << "SELECT COUNT(*) FROM repo_protect WHERE project_alias = :projectAlias",
+         *sql << "SELECT COUNT(*) FROM repo_protect WHERE project_alias = :projectAlias",
             soci::into(count),
             soci::use(projectAlias, "projectAlias");
 
          return count > 0;
 
       } catch (const std::exception &e) {
-         std::cerr << "[DBProjectRepository::existsRepoAlias] " << e.what() << "\n";
+         Log::error("DBProjectRepository::existsRepoAlias failed", {{"error", e.what()}});
+         return false;
+      }
+   }
+
+   bool existsKeyHolder(const std::string &projectAlias, int idUser) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         int count = 0;
+         *sql << "SELECT COUNT(*) FROM repo_protect WHERE project_alias = :projectAlias AND iduser = :idUser",
+            soci::into(count),
+            soci::use(projectAlias, "projectAlias"),
+            soci::use(idUser,       "idUser");
+
+         return count > 0;
+
+      } catch (const std::exception &e) {
+         Log::error("DBProjectRepository::existsKeyHolder failed", {{"error", e.what()}});
+         return false;
+      }
+   }
+
+   std::vector<WrappedKey> findKeyHolders(const std::string &projectAlias) override {
+      std::vector<WrappedKey> holders;
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         int idUser = 0;
+         std::string wrapped;
+         std::string wrapAlg;
+         soci::statement st = (sql->prepare <<
+            "SELECT iduser, rsa_aes, wrap_alg FROM repo_protect WHERE project_alias = :projectAlias",
+            soci::into(idUser),
+            soci::into(wrapped),
+            soci::into(wrapAlg),
+            soci::use(projectAlias, "projectAlias"));
+         st.execute(false);
+         while (st.fetch())
+            holders.push_back(WrappedKey{idUser, wrapped, parseWrapAlgorithm(wrapAlg).value_or(WrapAlgorithm::RSA_OAEP)});
+
+      } catch (const std::exception &e) {
+         Log::error("DBProjectRepository::findKeyHolders failed", {{"error", e.what()}});
+         holders.clear();
+      }
+      return holders;
+   }
+
+   bool removeKeyHolder(const std::string &projectAlias, int idUser) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         soci::statement st = (sql->prepare <<
+            "DELETE FROM repo_protect WHERE project_alias = :projectAlias AND iduser = :idUser",
+            soci::use(projectAlias, "projectAlias"),
+            soci::use(idUser,       "idUser"));
+         st.execute(true);
+         return st.get_affected_rows() > 0;
+
+      } catch (const std::exception &e) {
+         Log::error("DBProjectRepository::removeKeyHolder failed", {{"error", e.what()}});
          return false;
       }
    }
 
 private:
-   soci::session &sql_;
+   DBSessionPool &pool_;
+
+   // INSERT ... VALUES (:u0, :idproject, :k0, :projectAlias, :a0), (:u1, ...), ... en la sesion (y transaccion) del llamador
+   static bool insertWrappedKeys(soci::session &sql, int idproject, const std::string &projectAlias,
+                                 const std::vector<WrappedKey> &wrappedKeys) {
+      if (wrappedKeys.empty()) return true;
+
+      std::string query = "INSERT INTO repo_protect (iduser, idproject, rsa_aes, project_alias, wrap_alg) VALUES ";
+      for (std::size_t i = 0; i < wrappedKeys.size(); ++i) {
+         std::string n = std::to_string(i);
+         query += (i == 0 ? "" : ", ") + std::string("(:u") + n + ", :idproject, :k" + n + ", :projectAlias, :a" + n + ")";
+      }
+
+      // los nombres deben vivir hasta execute: soci guarda la referencia
+      std::vector<std::string> wrapAlgs;
+      wrapAlgs.reserve(wrappedKeys.size());
+      for (const WrappedKey &row : wrappedKeys) wrapAlgs.push_back(wrapAlgorithmName(row.algorithm));
+
+      soci::statement st(sql);
+      st.alloc();
+      st.prepare(query);
+      for (std::size_t i = 0; i < wrappedKeys.size(); ++i) {
+         st.exchange(soci::use(wrappedKeys[i].idUser, "u" + std::to_string(i)));
+         st.exchange(soci::use(wrappedKeys[i].rsaAes, "k" + std::to_string(i)));
+         st.exchange(soci::use(wrapAlgs[i], "a" + std::to_string(i)));
+      }
+      st.exchange(soci::use(idproject, "idproject"));
+      st.exchange(soci::use(projectAlias, "projectAlias"));
+      st.define_and_bind();
+      st.execute(true);
+
+      return st.get_affected_rows() == static_cast<long long>(wrappedKeys.size());
+   }
 };
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <soci/soci.h>
+#include <soci/mysql/soci-mysql.h>
+
+// Pool de sesiones SOCI compartido por DBUserRepository y DBProjectRepository.
+// Cada operacion de los repositorios pide prestada una sesion y la devuelve al
+// terminar, asi los workers de httplib no comparten la misma conexion.
+class DBSessionPool {
+public:
+   struct Stats {
+      std::size_t size;          // sesiones abiertas en el pool
+      std::size_t inUse;         // sesiones prestadas en este momento
+      std::size_t peakInUse;     // maximo de sesiones prestadas a la vez
+      unsigned long long leases;      // prestamos totales
+      unsigned long long timeouts;    // prestamos que no obtuvieron sesion a tiempo
+      double waitTotalMs;        // tiempo total esperando una sesion
+      double waitMaxMs;          // espera mas larga observada
+   };
+
+   // Prestamo de una sesion (RAII): se devuelve al pool en el destructor.
+   // Si el hilo ya tiene una sesion de este pool se reutiliza (prestamo anidado),
+   // de modo que un caso de uso que llama varios metodos no ocupa varias conexiones.
+   class Lease {
+   public:
+      Lease(const Lease &) = delete;
+      Lease &operator=(const Lease &) = delete;
+      Lease(Lease &&other) noexcept
+         : pool_(other.pool_), pos_(other.pos_), owner_(other.owner_) {
+         other.owner_ = false;
+         other.pool_ = nullptr;
+      }
+
+      ~Lease() {
+         if (pool_ && owner_) pool_->release(pos_);
+      }
+
+      soci::session &operator*() const { return pool_->pool_.at(pos_); }
+      soci::session *operator->() const { return &pool_->pool_.at(pos_); }
+
+   private:
+      friend class DBSessionPool;
+      Lease(DBSessionPool *pool, std::size_t pos, bool owner)
+         : pool_(pool), pos_(pos), owner_(owner) {}
+
+      DBSessionPool *pool_;
+      std::size_t pos_;
+      bool owner_;
+   };
+
+   explicit DBSessionPool(const std::string &connStr, std::size_t size, int leaseTimeoutMs)
+      : pool_(size), size_(size), leaseTimeoutMs_(leaseTimeoutMs) {
+      if (size == 0)
+         throw std::runtime_error("DB session pool size must be greater than 0");
+
+      // Abrir todas las conexiones al inicio para fallar pronto si la BDD no responde
+      for (std::size_t i = 0; i < size_; ++i) {
+         pool_.at(i).open(soci::mysql, connStr);
+      }
+   }
+
+   DBSessionPool(const DBSessionPool &) = delete;
+   DBSessionPool &operator=(const DBSessionPool &) = delete;
+
+   Lease acquire() {
+      // Prestamo anidado: el hilo ya tiene una sesion de este pool
+      if (current().pool == this) {
+         return Lease(this, current().pos, false);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      std::size_t pos = 0;
+      bool leased = pool_.try_lease(pos, leaseTimeoutMs_);
+      double waitedMs = std::chrono::duration<double, std::milli>(
+         std::chrono::steady_clock::now() - start).count();
+
+      recordWait(waitedMs);
+      if (!leased) {
+         timeouts_.fetch_add(1, std::memory_order_relaxed);
+         throw std::runtime_error("Timed out waiting for a database session after " + std::to_string(leaseTimeoutMs_) + " ms");
+      }
+
+      std::size_t inUse = inUse_.fetch_add(1, std::memory_order_relaxed) + 1;
+      std::size_t peak = peakInUse_.load(std::memory_order_relaxed);
+      while (inUse > peak && !peakInUse_.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {}
+      leases_.fetch_add(1, std::memory_order_relaxed);
+
+      if (current().pool == nullptr) {
+         current().pool = this;
+         current().pos = pos;
+      }
+      return Lease(this, pos, true);
+   }
+
+   Stats stats() const {
+      Stats s;
+      s.size        = size_;
+      s.inUse       = inUse_.load(std::memory_order_relaxed);
+      s.peakInUse   = peakInUse_.load(std::memory_order_relaxed);
+      s.leases      = leases_.load(std::memory_order_relaxed);
+      s.timeouts    = timeouts_.load(std::memory_order_relaxed);
+      s.waitTotalMs = waitTotalUs_.load(std::memory_order_relaxed) / 1000.0;
+      s.waitMaxMs   = waitMaxUs_.load(std::memory_order_relaxed) / 1000.0;
+      return s;
+   }
+
+private:
+   struct HeldSession {
+      const DBSessionPool *pool = nullptr;
+      std::size_t pos = 0;
+   };
+
+   static HeldSession &current() {
+      thread_local HeldSession held;
+      return held;
+   }
+
+   void release(std::size_t pos) {
+      if (current().pool == this && current().pos == pos) {
+         current().pool = nullptr;
+      }
+      inUse_.fetch_sub(1, std::memory_order_relaxed);
+      pool_.give_back(pos);
+   }
+
+   void recordWait(double waitedMs) {
+      unsigned long long us = static_cast<unsigned long long>(waitedMs * 1000.0);
+      waitTotalUs_.fetch_add(us, std::memory_order_relaxed);
+      unsigned long long max = waitMaxUs_.load(std::memory_order_relaxed);
+      while (us > max && !waitMaxUs_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+   }
+
+   soci::connection_pool pool_;
+   std::size_t size_;
+   int leaseTimeoutMs_;
+
+   std::atomic<std::size_t> inUse_{0};
+   std::atomic<std::size_t> peakInUse_{0};
+   std::atomic<unsigned long long> leases_{0};
+   std::atomic<unsigned long long> timeouts_{0};
+   std::atomic<unsigned long long> waitTotalUs_{0};
+   std::atomic<unsigned long long> waitMaxUs_{0};
+};
@@ -1,24 +1,36 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <vector>
 #include <soci/soci.h>
 #include <soci/mysql/soci-mysql.h>
+#include "DBSessionPool.hpp"
+#include "UserCache.hpp"
+#include "../logging/Log.hpp"
 #include "../../domain/repositories/IUser.repository.hpp"
 
+// Las lecturas por email/id pasan por una cache en memoria (ver UserCache); cada metodo que
+// modifica la fila de un usuario la invalida despues del UPDATE. cacheCapacity 0 la desactiva.
 class DBUserRepository : public IUserRepository {
 public:
-   explicit DBUserRepository(soci::session& sqlSession)
-      : sql_(sqlSession) {}
+   explicit DBUserRepository(DBSessionPool &sessionPool, std::size_t cacheCapacity = 0,
+                             std::size_t cacheShards = 16, int cacheTtlSeconds = 30)
+      : pool_(sessionPool), cache_(cacheCapacity, cacheShards, cacheTtlSeconds) {}
 
+   const UserCache &cache() const { return cache_; }
 
-   bool create(const std::string &name, const std::string &email, const std::string &password) override {
+
+   bool create(const std::string &name, const std::string &email, const std::string &passwordHash) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "INSERT INTO users (email, name, password) "
             "VALUES (:email, :name, :password)",
             soci::use(email, "email"),
             soci::use(name, "name"),
-            soci::use(password, "password")
+            soci::use(passwordHash, "password")
          );
 
 
@@ -36,8 +48,9 @@ public:
 
 
    bool addPublicKeyECDSA(const std::string &email, const std::string &publicKey) {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "UPDATE users "
             "SET kpubecdsa = :publicKey "
             "WHERE email = :email",
@@ -46,6 +59,7 @@ public:
          );
 
          st.execute(true);
+         cache_.invalidate(email);
 
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
@@ -57,8 +71,9 @@ public:
    }
 
    bool addPublicKeyRSA(const std::string &email, const std::string &publicKey) override {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "UPDATE users "
             "SET kpubrsa = :publicKey "
             "WHERE email = :email",
@@ -67,6 +82,7 @@ public:
          );
 
          st.execute(true);
+         cache_.invalidate(email);
 
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
@@ -80,80 +96,142 @@ public:
 
 
    std::optional<User> findByEmail(const std::string &email) override {
+      if (std::optional<User> cached = cache_.findByEmail(email)) return cached;
+
+      std::uint64_t ticket = cache_.ticket(email);
+      DBSessionPool::Lease sql = pool_.acquire();
       soci::row row;
 
-      sql_ << "SELECT iduser, name, email, role, status, verify, kpubecdsa, kpubrsa FROM users WHERE email = :email LIMIT 1",
+      *sql << "SELECT " + std::string(USER_COLUMNS) + " FROM users WHERE email = :email LIMIT 1",
          soci::into(row),
          soci::use(email, "email");
 
-      if (!sql_.got_data()) {
+      if (!sql->got_data()) {
          // No se encontró ningún usuario con ese email
          // std::cout << "No user found with email: " << email << std::endl;
          return std::nullopt;
       }
 
-      User user;
-      user.idUser = row.get<int>(0);              // columna 0: idUser
-      user.name   = row.get<std::string>(1);      // columna 1: name
-      user.email  = row.get<std::string>(2);      // columna 2: email
-      user.role   = row.get<int>(3);              // columna 3: role
-      user.status = row.get<int>(4);              // columna 4: status
-      user.verify = row.get<int>(5);              // columna 5: verify
-      
-      // --- Manejo de posible NULL en la columna kpubecdsa ---
-      soci::indicator indECDSA = row.get_indicator(6);  
-      if (indECDSA == soci::i_null) user.publicKeyECDSA = "NULL";
-      else user.publicKeyECDSA = row.get<std::string>(6);
-
-      // --- Manejo de posible NULL en la columna kpubrsa ---
-      soci::indicator indRSA = row.get_indicator(7);
-      if (indRSA == soci::i_null) user.publicKeyRSA = "NULL";
-      else user.publicKeyRSA = row.get<std::string>(7);
-   
+      User user = rowToUser(row);
+      cache_.store(user, ticket);
       return user;
    }
 
    std::optional<User> findById(int idUser) override {
+      // id ya visto: misma ruta que una busqueda por email (cache o lectura con ticket)
+      if (std::optional<std::string> email = cache_.emailOf(idUser)) {
+         std::optional<User> user = findByEmail(*email);
+         if (user.has_value() && user->idUser == idUser) return user;
+      }
+
+      DBSessionPool::Lease sql = pool_.acquire();
       soci::row row;
 
-      sql_ << "SELECT iduser, name, email, role, status, verify, kpubecdsa, kpubrsa FROM users WHERE iduser = :idUser LIMIT 1",
+      *sql << "SELECT " + std::string(USER_COLUMNS) + " FROM users WHERE iduser = :idUser LIMIT 1",
          soci::into(row),
          soci::use(idUser, "idUser");
 
-      if (!sql_.got_data()) {
+      if (!sql->got_data()) {
          return std::nullopt;
       }
 
-      User user;
-      user.idUser = row.get<int>(0);              // columna 0: idUser
-      user.name   = row.get<std::string>(1);      // columna 1: name
-      user.email  = row.get<std::string>(2);      // columna 2: email
-      user.role   = row.get<int>(3);              // columna 3: role
-      user.status = row.get<int>(4);              // columna 4: status
-      user.verify = row.get<int>(5);              // columna 5: verify
-      
-      // --- Manejo de posible NULL en la columna kpubecdsa ---
-      soci::indicator indECDSA = row.get_indicator(6);  
-      if (indECDSA == soci::i_null) user.publicKeyECDSA = "NULL";
-      else user.publicKeyECDSA = row.get<std::string>(6);
-
-      // --- Manejo de posible NULL en la columna kpubrsa ---
-      soci::indicator indRSA = row.get_indicator(7);
-      if (indRSA == soci::i_null) user.publicKeyRSA = "NULL";
-      else user.publicKeyRSA = row.get<std::string>(7);
-   
+      // la fila leida aqui no se guarda (sin ticket del email no se sabe si una escritura la dejo vieja)
+      User user = rowToUser(row);
+      cache_.rememberId(user.idUser, user.email);
       return user;
    }
 
+   // Los usuarios en cache se toman de ahi; los demas en una sola consulta con WHERE email IN (:e0, :e1, ...).
+   // Los emails que no existen no aparecen
+   UserSnapshot loadSnapshot(const std::vector<std::string> &emails) override {
+      std::vector<User> users;
+      std::vector<std::string> missing;
+      std::vector<std::uint64_t> tickets;
+      for (const std::string &email : emails) {
+         if (std::optional<User> cached = cache_.findByEmail(email)) {
+            users.push_back(std::move(*cached));
+         } else {
+            missing.push_back(email);
+            tickets.push_back(cache_.ticket(email));
+         }
+      }
+      if (missing.empty()) return UserSnapshot(std::move(users));
+
+      std::string query = "SELECT " + std::string(USER_COLUMNS) + " FROM users WHERE email IN (";
+      for (std::size_t i = 0; i < missing.size(); ++i)
+         query += (i == 0 ? ":e" : ", :e") + std::to_string(i);
+      query += ")";
+
+      DBSessionPool::Lease sql = pool_.acquire();
+      soci::row row;
+      soci::statement st(*sql);
+      st.alloc();
+      st.prepare(query);
+      st.exchange(soci::into(row));
+      for (std::size_t i = 0; i < missing.size(); ++i)
+         st.exchange(soci::use(missing[i], "e" + std::to_string(i)));
+      st.define_and_bind();
+
+      st.execute(false);
+      while (st.fetch()) {
+         User user = rowToUser(row);
+         std::string key = UserCache::normalize(user.email);
+         for (std::size_t i = 0; i < missing.size(); ++i) {
+            if (UserCache::normalize(missing[i]) == key) cache_.store(user, tickets[i]);
+         }
+         users.push_back(std::move(user));
+      }
+      return UserSnapshot(std::move(users));
+   }
+
+   std::vector<User> findProjectMembersWithWrapKey(int idProject, WrapAlgorithm algorithm) override {
+      std::vector<User> members;
+      DBSessionPool::Lease sql = pool_.acquire();
+      soci::row row;
+      std::string keyColumn = algorithm == WrapAlgorithm::ECIES_P256 ? "kpubecdsa" : "kpubrsa";
+      soci::statement st = (sql->prepare <<
+         "SELECT " + std::string(USER_COLUMNS) + " FROM users "
+         "WHERE iduser IN (SELECT iduser FROM users_has_projects WHERE idproject = :idProject) "
+         "AND " + keyColumn + " IS NOT NULL AND status = 1 AND verify = 1",
+         soci::into(row),
+         soci::use(idProject, "idProject"));
+
+      st.execute(false);
+      while (st.fetch()) members.push_back(rowToUser(row));
+      return members;
+   }
+
+   std::optional<std::string> findPasswordHash(const std::string &email) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      std::string passwordHash;
+      *sql << "SELECT password FROM users WHERE email = :email LIMIT 1",
+         soci::into(passwordHash),
+         soci::use(email, "email");
+
+      if (!sql->got_data()) return std::nullopt;
+      return passwordHash;
+   }
+
+   bool updatePasswordHash(const std::string &email, const std::string &passwordHash) override {
+      DBSessionPool::Lease sql = pool_.acquire();
+      try {
+         soci::statement st = (sql->prepare <<
+            "UPDATE users "
+            "SET password = :password "
+            "WHERE email = :email",
+            soci::use(passwordHash, "password"),
+            soci::use(email, "email")
+         );
+
+         st.execute(true);
 
-   bool isValidPassword(const std::string &email, const std::string &password) override {
-      int count = 0;
-      sql_ << "SELECT COUNT(*) FROM users WHERE email = :email AND password = :password",
-         soci::into(count),
-         soci::use(email, "email"),
-         soci::use(password, "password");
+         std::size_t affected = st.get_affected_rows();
+         return affected == 1;
 
-      return count > 0;
+      } catch (const std::exception &e) {
+         Log::error("DBUserRepository::updatePasswordHash failed", {{"error", e.what()}});
+         return false;
+      }
    }
 
    bool isVerifiedUser(const std::string &email) {
@@ -182,44 +260,21 @@ public:
    }
 
    bool notECDSAKeyAdded(const std::string &email) {
-      soci::row row;
-
-      sql_ << "SELECT kpubecdsa FROM users WHERE email = :email LIMIT 1",
-         soci::into(row),
-         soci::use(email, "email");
-
-      if (!sql_.got_data()) {
-         // No se encontró ningún usuario con ese email
-         return false;
-      }
-
-      soci::indicator ind = row.get_indicator(0);  // columna 0: kpubecdsa
-
-      return ind == soci::i_null;
+      auto userOpt = findByEmail(email);
+      return userOpt.has_value() && userOpt->publicKeyECDSA == "NULL";
    }
 
    bool notRSAKeyAdded(const std::string &email) override {
-      soci::row row;
-
-      sql_ << "SELECT kpubrsa FROM users WHERE email = :email LIMIT 1",
-         soci::into(row),
-         soci::use(email, "email");
-
-      if (!sql_.got_data()) {
-         // No se encontró ningún usuario con ese email
-         return false;
-      }
-
-      soci::indicator ind = row.get_indicator(0);  // columna 0: kpubrsa
-
-      return ind == soci::i_null;
+      auto userOpt = findByEmail(email);
+      return userOpt.has_value() && userOpt->publicKeyRSA == "NULL";
    }
 
 
    // Para cambiar el rol de un usuario a entre lider, senior o developer
    bool changeLevelUser(const std::string &email, int newRole) {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "UPDATE users "
             "SET role = :newRole "
             "WHERE email = :email",
@@ -227,6 +282,7 @@ public:
             soci::use(email, "email")
          );
          st.execute(true);
+         cache_.invalidate(email);
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
       } catch (const std::exception &e) {
@@ -236,14 +292,16 @@ public:
 
    // Para verificar el email de un usuario nuevo
    bool verifyUserEmail(const std::string &email) {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "UPDATE users "
             "SET verify = 1 "
             "WHERE email = :email",
             soci::use(email, "email")
          );
          st.execute(true);
+         cache_.invalidate(email);
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
       } catch (const std::exception &e) {
@@ -252,8 +310,9 @@ public:
    }
 
    bool changeActiveStatus(const std::string &email, int newStatus) {
+      DBSessionPool::Lease sql = pool_.acquire();
       try {
-         soci::statement st = (sql_.prepare <<
+         soci::statement st = (sql->prepare <<
             "UPDATE users "
             "SET status = :newStatus "
             "WHERE email = :email",
@@ -261,6 +320,7 @@ public:
             soci::use(email, "email")
          );
          st.execute(true);
+         cache_.invalidate(email);
          std::size_t affected = st.get_affected_rows();
          return affected == 1;
       } catch (const std::exception &e) {
@@ -269,5 +329,31 @@ public:
    }
 
 private:
-   soci::session& sql_;
+   DBSessionPool &pool_;
+   UserCache cache_;
+
+   // Columnas que lee rowToUser, en ese orden
+   static constexpr const char *USER_COLUMNS = "iduser, name, email, role, status, verify, kpubecdsa, kpubrsa";
+
+   static User rowToUser(const soci::row &row) {
+      User user;
+      user.idUser = row.get<int>(0);              // columna 0: idUser
+      user.name   = row.get<std::string>(1);      // columna 1: name
+      user.email  = row.get<std::string>(2);      // columna 2: email
+      user.role   = row.get<int>(3);              // columna 3: role
+      user.status = row.get<int>(4);              // columna 4: status
+      user.verify = row.get<int>(5);              // columna 5: verify
+      
+      // --- Manejo de posible NULL en la columna kpubecdsa ---
+      soci::indicator indECDSA = row.get_indicator(6);  
+      if (indECDSA == soci::i_null) user.publicKeyECDSA = "NULL";
+      else user.publicKeyECDSA = row.get<std::string>(6);
+
+      // --- Manejo de posible NULL en la columna kpubrsa ---
+      soci::indicator indRSA = row.get_indicator(7);
+      if (indRSA == soci::i_null) user.publicKeyRSA = "NULL";
+      else user.publicKeyRSA = row.get<std::string>(7);
+   
+      return user;
+   }
 };
@@ -0,0 +1,71 @@
+// infrastructure/database/UserCache.hpp
+#pragma once
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "../cache/ShardedLruCache.hpp"
+#include "../../domain/entities/User.entity.hpp"
+
+// Cache de filas de users para DBUserRepository, por email y por id.
+//
+// Las filas se guardan por email; el indice por id solo guarda id -> email, asi una escritura
+// (que el repositorio recibe por email) se invalida con un solo erase. Una busqueda por id
+// resuelve el email y sigue como una busqueda por email.
+// El TTL acota lo que otra instancia del servidor puede dejar desactualizado.
+class UserCache {
+public:
+   UserCache(std::size_t capacity, std::size_t shards, int ttlSeconds)
+      : byEmail_(capacity, shards, std::chrono::seconds(ttlSeconds)),
+        emailById_(capacity, shards, std::chrono::seconds(ttlSeconds)) {}
+
+   bool enabled() const { return byEmail_.enabled(); }
+
+   std::optional<User> findByEmail(const std::string &email) {
+      return byEmail_.get(normalize(email));
+   }
+
+   // Email de un id ya visto (la relacion id -> email no cambia: se guarda sin ticket)
+   std::optional<std::string> emailOf(int idUser) { return emailById_.get(idUser); }
+   void rememberId(int idUser, const std::string &email) { emailById_.put(idUser, normalize(email)); }
+
+   // Tomar antes de consultar la BDD y pasarlo a store(): descarta lo leido si hubo una escritura en medio
+   std::uint64_t ticket(const std::string &email) { return byEmail_.ticket(normalize(email)); }
+
+   void store(const User &user, std::uint64_t ticket) {
+      std::string key = normalize(user.email);
+      if (byEmail_.put(key, user, ticket))
+         emailById_.put(user.idUser, key);
+   }
+
+   void invalidate(const std::string &email) { byEmail_.erase(normalize(email)); }
+
+   // La columna email compara sin distinguir mayusculas (collation de MariaDB): la clave tambien
+   static std::string normalize(std::string email) {
+      for (char &c : email) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      return email;
+   }
+
+   // Texto Prometheus para /metrics
+   std::string renderPrometheus() const {
+      std::string out;
+      out += "# HELP user_cache_requests_total User cache lookups by index and result.\n";
+      out += "# TYPE user_cache_requests_total counter\n";
+      out += "user_cache_requests_total{index=\"email\",result=\"hit\"} " + std::to_string(byEmail_.hits()) + "\n";
+      out += "user_cache_requests_total{index=\"email\",result=\"miss\"} " + std::to_string(byEmail_.misses()) + "\n";
+      out += "user_cache_requests_total{index=\"id\",result=\"hit\"} " + std::to_string(emailById_.hits()) + "\n";
+      out += "user_cache_requests_total{index=\"id\",result=\"miss\"} " + std::to_string(emailById_.misses()) + "\n";
+      out += "# HELP user_cache_evictions_total Users evicted from the cache by the LRU bound.\n";
+      out += "# TYPE user_cache_evictions_total counter\n";
+      out += "user_cache_evictions_total " + std::to_string(byEmail_.evictions()) + "\n";
+      out += "# HELP user_cache_entries Users currently cached.\n";
+      out += "# TYPE user_cache_entries gauge\n";
+      out += "user_cache_entries " + std::to_string(byEmail_.size()) + "\n";
+      return out;
+   }
+
+private:
+   ShardedLruCache<std::string, User> byEmail_;
+   ShardedLruCache<int, std::string> emailById_;
+};
@@ -0,0 +1,233 @@
+// infrastructure/logging/AsyncLogger.hpp
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../../third_party/json.hpp"
+
+// Logger asincrono con salida JSON lines.
+// Cada hilo escribe en su propio ring buffer (un productor, un consumidor, sin locks ni syscalls);
+// un hilo de fondo los vacia periodicamente y escribe todo el lote con un solo fflush.
+// Con el ring lleno: Overflow::Drop descarta el registro (y lo cuenta), Overflow::Block espera a que haya lugar.
+class AsyncLogger {
+public:
+   enum class Level { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+   enum class Overflow { Drop, Block };
+
+   struct Record {
+      Level level;
+      std::chrono::system_clock::time_point time;
+      std::uint64_t threadId;
+      std::string requestId;
+      std::string message;
+      nlohmann::json fields;
+   };
+
+   AsyncLogger(Level minLevel, std::size_t ringCapacity, Overflow overflow, std::FILE *out = stdout,
+               std::chrono::milliseconds drainInterval = std::chrono::milliseconds(5))
+      : minLevel_(minLevel), ringCapacity_(roundUpPowerOfTwo(ringCapacity)), overflow_(overflow),
+        out_(out), drainInterval_(drainInterval) {
+      drainer_ = std::thread([this] { drainLoop(); });
+   }
+
+   AsyncLogger(const AsyncLogger &) = delete;
+   AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+   ~AsyncLogger() {
+      stopping_.store(true, std::memory_order_release);
+      drainer_.join();
+      drainOnce();   // lo que quede despues de la ultima pasada
+   }
+
+   bool enabled(Level level) const { return level >= minLevel_; }
+
+   void log(Level level, std::string message, nlohmann::json fields, const std::string &requestId) {
+      if (!enabled(level)) return;
+
+      Ring &ring = localRing();
+      Record record{level, std::chrono::system_clock::now(), ring.threadId, requestId, std::move(message), std::move(fields)};
+
+      while (!ring.tryPush(std::move(record))) {
+         if (overflow_ == Overflow::Drop) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+         }
+         std::this_thread::yield();   // Block: solo aqui hay syscall, cuando el consumidor va atrasado
+      }
+   }
+
+   std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+   static Level parseLevel(const std::string &name) {
+      if (name == "debug") return Level::Debug;
+      if (name == "warn")  return Level::Warn;
+      if (name == "error") return Level::Error;
+      return Level::Info;
+   }
+
+   static Overflow parseOverflow(const std::string &name) {
+      return name == "block" ? Overflow::Block : Overflow::Drop;
+   }
+
+private:
+   // Ring SPSC: el hilo dueño escribe en head_, el hilo de fondo consume desde tail_
+   struct Ring {
+      explicit Ring(std::size_t capacity, std::uint64_t id)
+         : slots(capacity), mask(capacity - 1), threadId(id) {}
+
+      bool tryPush(Record &&record) {
+         std::size_t head = head_.load(std::memory_order_relaxed);
+         if (head - tail_.load(std::memory_order_acquire) == slots.size()) return false;
+         slots[head & mask] = std::move(record);
+         head_.store(head + 1, std::memory_order_release);
+         return true;
+      }
+
+      template <class F>
+      std::size_t drain(F &&consume) {
+         std::size_t tail = tail_.load(std::memory_order_relaxed);
+         std::size_t head = head_.load(std::memory_order_acquire);
+         for (std::size_t i = tail; i != head; ++i) {
+            consume(slots[i & mask]);
+            slots[i & mask] = Record{};
+         }
+         tail_.store(head, std::memory_order_release);
+         return head - tail;
+      }
+
+      bool empty() const {
+         return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+      }
+
+      std::vector<Record> slots;
+      std::size_t mask;
+      std::uint64_t threadId;
+      std::atomic<bool> abandoned{false};   // el hilo dueño termino
+      alignas(64) std::atomic<std::size_t> head_{0};
+      alignas(64) std::atomic<std::size_t> tail_{0};
+   };
+
+   // Marca el ring como abandonado cuando termina el hilo, para que el consumidor lo libere
+   struct LocalRing {
+      AsyncLogger *owner = nullptr;
+      std::shared_ptr<Ring> ring;
+      ~LocalRing() {
+         if (ring) ring->abandoned.store(true, std::memory_order_release);
+      }
+   };
+
+   Level minLevel_;
+   std::size_t ringCapacity_;
+   Overflow overflow_;
+   std::FILE *out_;
+   std::chrono::milliseconds drainInterval_;
+
+   std::mutex ringsMutex_;                      // solo alta de rings (una vez por hilo) y drenado
+   std::vector<std::shared_ptr<Ring>> rings_;
+   std::atomic<std::uint64_t> nextThreadId_{1};
+   std::atomic<std::uint64_t> dropped_{0};
+   std::uint64_t reportedDropped_ = 0;
+   std::atomic<bool> stopping_{false};
+   std::thread drainer_;
+
+   Ring &localRing() {
+      thread_local LocalRing local;
+      if (local.owner != this || !local.ring) {
+         if (local.ring) local.ring->abandoned.store(true, std::memory_order_release);
+         local.owner = this;
+         local.ring = std::make_shared<Ring>(ringCapacity_, nextThreadId_.fetch_add(1, std::memory_order_relaxed));
+         std::lock_guard<std::mutex> lock(ringsMutex_);
+         rings_.push_back(local.ring);
+      }
+      return *local.ring;
+   }
+
+   void drainLoop() {
+      while (!stopping_.load(std::memory_order_acquire)) {
+         if (drainOnce() == 0) std::this_thread::sleep_for(drainInterval_);
+      }
+   }
+
+   // Vacia todos los rings en un buffer y lo escribe de una vez; devuelve registros escritos
+   std::size_t drainOnce() {
+      std::string batch;
+      std::size_t written = 0;
+      {
+         std::lock_guard<std::mutex> lock(ringsMutex_);
+         for (auto it = rings_.begin(); it != rings_.end();) {
+            Ring &ring = **it;
+            written += ring.drain([&batch](const Record &record) { appendLine(batch, record); });
+            if (ring.abandoned.load(std::memory_order_acquire) && ring.empty()) it = rings_.erase(it);
+            else ++it;
+         }
+      }
+
+      std::uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+      if (dropped != reportedDropped_) {
+         Record notice{Level::Warn, std::chrono::system_clock::now(), 0, "", "log records dropped",
+                       nlohmann::json{{"dropped_total", dropped}}};
+         appendLine(batch, notice);
+         reportedDropped_ = dropped;
+      }
+
+      if (!batch.empty()) {
+         std::fwrite(batch.data(), 1, batch.size(), out_);
+         std::fflush(out_);
+      }
+      return written;
+   }
+
+   static void appendLine(std::string &batch, const Record &record) {
+      nlohmann::json line = nlohmann::json::object();
+      line["ts"] = formatTime(record.time);
+      line["level"] = levelName(record.level);
+      line["thread"] = record.threadId;
+      if (!record.requestId.empty()) line["request_id"] = record.requestId;
+      line["msg"] = record.message;
+      if (record.fields.is_object()) {
+         for (auto field = record.fields.begin(); field != record.fields.end(); ++field)
+            line[field.key()] = field.value();
+      }
+      // los mensajes pueden traer bytes invalidos en UTF-8 (ej. e.what() de terceros)
+      batch += line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+      batch += '\n';
+   }
+
+   static const char *levelName(Level level) {
+      switch (level) {
+         case Level::Debug: return "debug";
+         case Level::Info:  return "info";
+         case Level::Warn:  return "warn";
+         case Level::Error: return "error";
+      }
+      return "info";
+   }
+
+   // ISO-8601 UTC con milisegundos
+   static std::string formatTime(std::chrono::system_clock::time_point time) {
+      std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+      auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+      std::tm utc{};
+      gmtime_r(&seconds, &utc);
+      char buffer[32];
+      std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                    utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                    utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>(millis));
+      return buffer;
+   }
+
+   static std::size_t roundUpPowerOfTwo(std::size_t value) {
+      std::size_t result = 64;
+      while (result < value) result <<= 1;
+      return result;
+   }
+};
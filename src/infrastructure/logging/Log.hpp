@@ -0,0 +1,79 @@
+// infrastructure/logging/Log.hpp
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include "AsyncLogger.hpp"
+
+// Punto de acceso global al logger (se instala en main) y al id de la peticion en curso.
+// Sin logger instalado (ej. herramientas sueltas) los registros se escriben directo a stderr.
+//
+//    Log::info("Repository created", {{"repo", name}});
+//    Log::error("Error creating user", {{"error", e.what()}});
+namespace Log {
+
+   inline std::atomic<AsyncLogger *> &installed() {
+      static std::atomic<AsyncLogger *> logger{nullptr};
+      return logger;
+   }
+
+   inline void install(AsyncLogger *logger) { installed().store(logger, std::memory_order_release); }
+
+   // Instala el logger mientras viva el objeto (declararlo despues del AsyncLogger)
+   class Installation {
+   public:
+      explicit Installation(AsyncLogger &logger) { install(&logger); }
+      ~Installation() { install(nullptr); }
+
+      Installation(const Installation &) = delete;
+      Installation &operator=(const Installation &) = delete;
+   };
+
+   inline std::string &currentRequestId() {
+      thread_local std::string requestId;
+      return requestId;
+   }
+
+   // Asocia un id de peticion a los registros del hilo mientras dure el scope
+   class RequestScope {
+   public:
+      explicit RequestScope(std::string requestId) : previous_(std::move(currentRequestId())) {
+         currentRequestId() = std::move(requestId);
+      }
+      ~RequestScope() { currentRequestId() = std::move(previous_); }
+
+      RequestScope(const RequestScope &) = delete;
+      RequestScope &operator=(const RequestScope &) = delete;
+
+   private:
+      std::string previous_;
+   };
+
+   inline void write(AsyncLogger::Level level, std::string message, nlohmann::json fields) {
+      AsyncLogger *logger = installed().load(std::memory_order_acquire);
+      if (logger) {
+         if (!logger->enabled(level)) return;
+         logger->log(level, std::move(message), std::move(fields), currentRequestId());
+         return;
+      }
+      std::string line = message + (fields.is_object() && !fields.empty() ? " " + fields.dump() : "") + "\n";
+      std::fputs(line.c_str(), stderr);
+   }
+
+   inline void debug(std::string message, nlohmann::json fields = nlohmann::json::object()) {
+      write(AsyncLogger::Level::Debug, std::move(message), std::move(fields));
+   }
+
+   inline void info(std::string message, nlohmann::json fields = nlohmann::json::object()) {
+      write(AsyncLogger::Level::Info, std::move(message), std::move(fields));
+   }
+
+   inline void warn(std::string message, nlohmann::json fields = nlohmann::json::object()) {
+      write(AsyncLogger::Level::Warn, std::move(message), std::move(fields));
+   }
+
+   inline void error(std::string message, nlohmann::json fields = nlohmann::json::object()) {
+      write(AsyncLogger::Level::Error, std::move(message), std::move(fields));
+   }
+}
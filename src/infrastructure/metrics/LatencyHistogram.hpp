@@ -0,0 +1,77 @@
+// infrastructure/metrics/LatencyHistogram.hpp
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Histograma de latencias log-lineal sin locks (contadores atomicos relajados).
+// Los valores se registran en microsegundos: 0..3 us en buckets lineales y desde ahi 4 buckets
+// por cada potencia de dos (error relativo <= 25%), hasta ~2^40 us (~12 dias).
+class LatencyHistogram {
+public:
+   static constexpr std::size_t SUB_BUCKETS = 4;     // buckets por potencia de dos
+   static constexpr std::size_t MAX_EXPONENT = 40;
+   static constexpr std::size_t BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - 1) * SUB_BUCKETS;
+
+   void observe(std::uint64_t micros) {
+      buckets_[indexOf(micros)].fetch_add(1, std::memory_order_relaxed);
+      sumMicros_.fetch_add(micros, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   // Limite superior (exclusivo, en us) del bucket i
+   static std::uint64_t upperBound(std::size_t index) {
+      if (index < SUB_BUCKETS) return index + 1;
+      std::size_t exponent = 2 + (index - SUB_BUCKETS) / SUB_BUCKETS;
+      std::uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+      return (SUB_BUCKETS + sub + 1) << (exponent - 2);
+   }
+
+   static std::size_t indexOf(std::uint64_t micros) {
+      if (micros < SUB_BUCKETS) return static_cast<std::size_t>(micros);
+      std::size_t exponent = 63 - static_cast<std::size_t>(__builtin_clzll(micros));
+      if (exponent >= MAX_EXPONENT + 1) return BUCKETS - 1;
+      std::size_t sub = static_cast<std::size_t>((micros >> (exponent - 2)) & (SUB_BUCKETS - 1));
+      return SUB_BUCKETS + (exponent - 2) * SUB_BUCKETS + sub;
+   }
+
+   std::uint64_t bucket(std::size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+   std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+   std::uint64_t sumMicros() const { return sumMicros_.load(std::memory_order_relaxed); }
+
+   // Series Prometheus (<name>_bucket/_sum/_count, en segundos); labels sin llaves, ej. route="/x"
+   // Se exportan los limites entre 64 us y ~19 h; los buckets menores se acumulan en el primero
+   std::string renderPrometheus(const std::string &name, const std::string &labels) const {
+      std::string out;
+      std::string sep = labels.empty() ? "" : ",";
+      std::uint64_t cumulative = 0;
+      for (std::size_t i = 0; i < BUCKETS; ++i) {
+         cumulative += bucket(i);
+         std::uint64_t upper = upperBound(i);
+         if (upper < MIN_EXPORTED_US || upper > MAX_EXPORTED_US) continue;
+         out += name + "_bucket{" + labels + sep + "le=\"" + seconds(upper) + "\"} " + std::to_string(cumulative) + "\n";
+      }
+      std::uint64_t total = count();
+      out += name + "_bucket{" + labels + sep + "le=\"+Inf\"} " + std::to_string(total) + "\n";
+      out += name + "_sum{" + labels + "} " + seconds(sumMicros()) + "\n";
+      out += name + "_count{" + labels + "} " + std::to_string(total) + "\n";
+      return out;
+   }
+
+private:
+   static constexpr std::uint64_t MIN_EXPORTED_US = 64;
+   static constexpr std::uint64_t MAX_EXPORTED_US = 1ULL << 36;
+
+   std::array<std::atomic<std::uint64_t>, BUCKETS> buckets_{};
+   std::atomic<std::uint64_t> sumMicros_{0};
+   std::atomic<std::uint64_t> count_{0};
+
+   static std::string seconds(std::uint64_t micros) {
+      std::string whole = std::to_string(micros / 1000000);
+      std::string frac = std::to_string(micros % 1000000);
+      frac.insert(frac.begin(), 6 - frac.size(), '0');
+      while (!frac.empty() && frac.back() == '0') frac.pop_back();
+      return frac.empty() ? whole : whole + "." + frac;
+   }
+};
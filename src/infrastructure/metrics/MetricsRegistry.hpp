@@ -0,0 +1,136 @@
+// infrastructure/metrics/MetricsRegistry.hpp
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "LatencyHistogram.hpp"
+#include "../../domain/repositories/IMetrics.repository.hpp"
+
+// Metricas de la API en formato Prometheus.
+// Rutas y etapas se registran al arrancar (antes de listen); despues solo se actualizan
+// contadores atomicos, sin locks en el camino de una peticion.
+class MetricsRegistry : public IMetricsRepository {
+public:
+   struct RouteMetrics {
+      std::string method;
+      std::string path;
+      std::array<std::atomic<std::uint64_t>, 5> byStatusClass{};   // 1xx..5xx
+      std::atomic<std::int64_t> inFlight{0};
+      LatencyHistogram latency;
+
+      RouteMetrics(std::string m, std::string p) : method(std::move(m)), path(std::move(p)) {}
+   };
+
+   // Mide una peticion: suma al gauge en vuelo y al terminar registra latencia y clase de status.
+   // Si sale una excepcion del handler, httplib responde 500 y asi se cuenta.
+   class RequestScope {
+   public:
+      RequestScope(RouteMetrics &route, const int &status)
+         : route_(route), status_(status), start_(std::chrono::steady_clock::now()),
+           uncaught_(std::uncaught_exceptions()) {
+         route_.inFlight.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      ~RequestScope() {
+         auto elapsed = std::chrono::steady_clock::now() - start_;
+         route_.latency.observe(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+
+         // status -1: el handler no lo asigno y httplib responde 200
+         int status = std::uncaught_exceptions() > uncaught_ ? 500 : (status_ == -1 ? 200 : status_);
+         std::size_t statusClass = (status >= 100 && status < 600) ? static_cast<std::size_t>(status / 100 - 1) : 4;
+         route_.byStatusClass[statusClass].fetch_add(1, std::memory_order_relaxed);
+         route_.inFlight.fetch_sub(1, std::memory_order_relaxed);
+      }
+
+      RequestScope(const RequestScope &) = delete;
+      RequestScope &operator=(const RequestScope &) = delete;
+
+   private:
+      RouteMetrics &route_;
+      const int &status_;
+      std::chrono::steady_clock::time_point start_;
+      int uncaught_;
+   };
+
+   explicit MetricsRegistry(const std::vector<std::string> &stages = {}) {
+      for (const auto &stage : stages) stages_[stage];
+   }
+
+   // Alta de una ruta (al registrar los handlers); la referencia es estable
+   RouteMetrics &route(const std::string &method, const std::string &path) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      routes_.emplace_back(method, path);
+      return routes_.back();
+   }
+
+   // Alta (al arrancar) de metricas de otro componente (ej. caches): se llama en cada render de /metrics
+   void addCollector(std::function<std::string()> render) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      collectors_.push_back(std::move(render));
+   }
+
+   void observeStage(const std::string &stage, std::uint64_t micros) override {
+      // stages_ no cambia despues del constructor: lectura concurrente segura
+      auto found = stages_.find(stage);
+      if (found != stages_.end()) found->second.observe(micros);
+   }
+
+   // Texto para /metrics (Prometheus exposition format 0.0.4)
+   std::string renderPrometheus() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      static const char *classes[5] = { "1xx", "2xx", "3xx", "4xx", "5xx" };
+      std::string out;
+
+      out += "# HELP http_requests_total Requests handled per route and status class.\n";
+      out += "# TYPE http_requests_total counter\n";
+      for (const auto &route : routes_) {
+         for (std::size_t i = 0; i < 5; ++i) {
+            out += "http_requests_total{" + routeLabels(route) + ",code=\"" + classes[i] + "\"} " +
+                   std::to_string(route.byStatusClass[i].load(std::memory_order_relaxed)) + "\n";
+         }
+      }
+
+      out += "# HELP http_requests_in_flight Requests currently inside a handler.\n";
+      out += "# TYPE http_requests_in_flight gauge\n";
+      for (const auto &route : routes_) {
+         out += "http_requests_in_flight{" + routeLabels(route) + "} " +
+                std::to_string(route.inFlight.load(std::memory_order_relaxed)) + "\n";
+      }
+
+      out += "# HELP http_request_duration_seconds Handler latency per route.\n";
+      out += "# TYPE http_request_duration_seconds histogram\n";
+      for (const auto &route : routes_) {
+         out += route.latency.renderPrometheus("http_request_duration_seconds", routeLabels(route));
+      }
+
+      if (!stages_.empty()) {
+         out += "# HELP usecase_stage_duration_seconds Duration of internal use case stages.\n";
+         out += "# TYPE usecase_stage_duration_seconds histogram\n";
+         for (const auto &stage : stages_) {
+            out += stage.second.renderPrometheus("usecase_stage_duration_seconds", "stage=\"" + stage.first + "\"");
+         }
+      }
+
+      for (const auto &collector : collectors_) out += collector();
+      return out;
+   }
+
+private:
+   mutable std::mutex mutex_;                       // solo alta de rutas y render
+   std::deque<RouteMetrics> routes_;                // deque: referencias estables al crecer
+   std::map<std::string, LatencyHistogram> stages_;
+   std::vector<std::function<std::string()>> collectors_;
+
+   static std::string routeLabels(const RouteMetrics &route) {
+      return "method=\"" + route.method + "\",route=\"" + route.path + "\"";
+   }
+};
@@ -0,0 +1,83 @@
+// infrastructure/storage/FastCdc.hpp
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Cortes por contenido al estilo FastCDC (hash "gear" con chunking normalizado).
+// Un corte depende solo de los ultimos bytes vistos, asi que insertar o borrar datos en medio
+// de un stream mueve como mucho los chunks vecinos: el resto se repite igual y se deduplica.
+//
+// Tamaños: promedio redondeado a potencia de 2, minimo promedio/4 y maximo promedio*4.
+// Antes del promedio se usa una mascara con 2 bits mas (cortes menos probables) y despues
+// una con 2 bits menos, lo que concentra los tamaños alrededor del promedio.
+//
+// La tabla gear y las mascaras son parte del formato: cambiarlas cambia todos los cortes
+// (los chunks ya guardados siguen leyendose, pero dejan de deduplicarse con los nuevos).
+class FastCdc {
+public:
+   explicit FastCdc(std::size_t averageSize = 64 * 1024) {
+      unsigned bits = 12;  // 4 KiB .. 4 MiB
+      while (bits < 22 && (std::size_t(1) << bits) < averageSize) ++bits;
+      avg_ = std::size_t(1) << bits;
+      min_ = avg_ / 4;
+      max_ = avg_ * 4;
+      maskSmall_ = topBits(bits + 2);
+      maskLarge_ = topBits(bits - 2);
+   }
+
+   std::size_t minSize() const { return min_; }
+   std::size_t averageSize() const { return avg_; }
+   std::size_t maxSize() const { return max_; }
+
+   // Longitud del primer chunk de data[0, size). Si no hay corte antes de size (< maximo)
+   // devuelve size: quien llama solo debe aceptarlo al final del stream
+   std::size_t cut(const char *data, std::size_t size) const {
+      if (size <= min_) return size;
+      const std::size_t end = std::min(size, max_);
+      const std::size_t normal = std::min(end, avg_);
+      const auto *bytes = reinterpret_cast<const unsigned char*>(data);
+      const auto &table = gear();
+
+      std::uint64_t hash = 0;
+      std::size_t i = min_;
+      for (; i < normal; ++i) {
+         hash = (hash << 1) + table[bytes[i]];
+         if ((hash & maskSmall_) == 0) return i + 1;
+      }
+      for (; i < end; ++i) {
+         hash = (hash << 1) + table[bytes[i]];
+         if ((hash & maskLarge_) == 0) return i + 1;
+      }
+      return end;
+   }
+
+private:
+   std::size_t min_;
+   std::size_t avg_;
+   std::size_t max_;
+   std::uint64_t maskSmall_;
+   std::uint64_t maskLarge_;
+
+   // Bits altos: con el desplazamiento del gear dependen de los ultimos ~64 bytes, no solo de los ultimos
+   static std::uint64_t topBits(unsigned count) {
+      return ~std::uint64_t(0) << (64 - count);
+   }
+
+   // 256 valores de splitmix64 con semilla fija
+   static const std::array<std::uint64_t, 256> &gear() {
+      static const std::array<std::uint64_t, 256> table = [] {
+         std::array<std::uint64_t, 256> values{};
+         std::uint64_t state = 0x6f72636163646331ULL;
+         for (auto &value : values) {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            value = z ^ (z >> 31);
+         }
+         return values;
+      }();
+      return table;
+   }
+};
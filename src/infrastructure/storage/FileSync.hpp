@@ -0,0 +1,17 @@
+// infrastructure/storage/FileSync.hpp
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+// fsync de un archivo o de un directorio (para que un rename/link dentro de el sea durable)
+inline void fsyncPath(const std::string &path) {
+   int fd = ::open(path.empty() ? "." : path.c_str(), O_RDONLY);
+   if (fd < 0)
+      throw std::runtime_error("Could not open for fsync: " + path);
+   int rc = ::fsync(fd);
+   ::close(fd);
+   if (rc != 0)
+      throw std::runtime_error("fsync failed: " + path);
+}
@@ -1,14 +1,43 @@
 // infrastructure/storage/FilesystemStorage.hpp
 #pragma once
 #include "../../domain/repositories/IRepositoryStore.repository.hpp"
+#include "TarWriter.hpp"
+#include "ParallelGzipWriter.hpp"
+#include "GzipReader.hpp"
+#include "TarReader.hpp"
+#include "../concurrency/ThreadPool.hpp"
+#include "../../third_party/json.hpp"
+#include <cryptopp/sha.h>
+#include <cryptopp/hex.h>
+#include <cryptopp/filters.h>
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <future>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 class FilesystemStorage : public IRepositoryStore {
 public:
-   explicit FilesystemStorage(const std::filesystem::path& repositoriesRoot, const std::filesystem::path& cipherPath)
-      : rootPath_(repositoriesRoot), cipherPath_(cipherPath) {
+   // compressPool: hilos compartidos para comprimir los tar (presupuesto global de CPU)
+   // compressBlockSize: tamaño de bloque para la compresion gzip en paralelo
+   // contentDefinedBlocks: tamaño promedio de bloque cortado por contenido (FastCDC) para los tar.gz
+   //                       con indice; 0 = bloques fijos de compressBlockSize. Con el almacen de chunks
+   //                       cada bloque comprimido es un chunk (ver ChunkStore)
+   explicit FilesystemStorage(const std::filesystem::path& repositoriesRoot, const std::filesystem::path& cipherPath,
+                              ThreadPool &compressPool, std::size_t compressBlockSize = 1 << 20,
+                              std::size_t contentDefinedBlocks = 0)
+      : rootPath_(repositoriesRoot), cipherPath_(cipherPath),
+        compressPool_(compressPool), compressBlockSize_(compressBlockSize),
+        blockCutter_(contentDefinedBlocks > 0 ? contentDefinedBlocks : 64 * 1024),
+        contentDefinedBlocks_(contentDefinedBlocks > 0) {
       // Si la carpeta raíz no existe, crearla
       if (!std::filesystem::exists(rootPath_)) {
          std::filesystem::create_directories(rootPath_);
@@ -116,32 +145,449 @@ public:
    }
 
 
-   // Funcion para convertir una carpeta en un archivo .tar
+   // Funcion para convertir una carpeta en un archivo .tar (comprimido con gzip, igual que `tar -czf`)
    std::filesystem::path folderToTar(const std::string &name, const std::string &projectAlias) override {
-      std::filesystem::path repoPath = rootPath_ / name;
       std::filesystem::path tarPath = cipherPath_ / (name + "_" + projectAlias + ".tar");
-      
+
+      std::ofstream tarFile(tarPath, std::ios::binary);
+      if (!tarFile)
+         throw std::runtime_error("Could not create tar file: " + tarPath.string());
+
+      try {
+         folderToTarStream(name, [&tarFile](const char *data, std::size_t size) {
+            tarFile.write(data, size);
+         });
+         tarFile.close();
+         if (!tarFile)
+            throw std::runtime_error("Could not write tar file: " + tarPath.string());
+      } catch (...) {
+         tarFile.close();
+         std::error_code ec;
+         std::filesystem::remove(tarPath, ec);
+         throw;
+      }
+
+      return tarPath;
+   }
+
+
+   // Genera el tar.gz en proceso: recorre la carpeta, escribe el tar y lo comprime al vuelo.
+   // Dentro del tar las entradas quedan bajo "<name>/..." (mismo layout que `tar -C <root> <name>`).
+   // Los bloques gzip se comprimen de forma independiente para poder descomprimir un archivo
+   // suelto a partir del indice que se devuelve.
+   std::string folderToTarStream(const std::string &name, const ByteSink &out) override {
+      std::filesystem::path repoPath = rootPath_ / name;
+
       // Validar que el repositorio exista
       if (!std::filesystem::exists(repoPath))
          throw std::runtime_error("Repository directory does not exist: " + name);
-      
+
       if (!std::filesystem::is_directory(repoPath))
          throw std::runtime_error("Path is not a directory: " + name);
-      
-      // Crear el comando tar
-      // -c: crear archivo, -f: archivo de salida, -C: cambiar a directorio
-      std::string command = "tar -czf \"" + tarPath.string() + "\" -C \"" + rootPath_.string() + "\" \"" + name + "\"";
-      
-      int result = std::system(command.c_str());
-      
-      if (result != 0)
-         throw std::runtime_error("Failed to create tar archive for: " + name);
-      
-      // Verificar que el archivo tar se creó correctamente
-      if (!std::filesystem::exists(tarPath))
-         throw std::runtime_error("Tar file was not created: " + tarPath.string());
-      
-      return tarPath;
+
+      // Compresion por bloques (en paralelo si hay mas de un hilo); el resultado sigue siendo un gzip estandar
+      ParallelGzipWriter gzip(out, compressPool_, compressBlockSize_, Z_DEFAULT_COMPRESSION, true, blockCutter());
+      TarWriter tar(gzip.sink());
+      tar.addDirectoryTree(repoPath, name);
+      tar.finish();
+      gzip.finish();
+
+      return buildArchiveIndex(tar.members(), gzip.blocks(), gzip.compressedDataEnd()).dump();
+   }
+
+
+   std::optional<ArchiveMember> findArchiveMember(const std::string &index, const std::string &path) override {
+      nlohmann::json parsed = nlohmann::json::parse(index);
+      if (parsed.value("version", 0) != 1)
+         throw std::runtime_error("Unsupported archive index version");
+
+      const auto &members = parsed.at("members");
+      auto found = members.find(path);
+      if (found == members.end()) return std::nullopt;
+
+      std::uint64_t dataOffset = found->at(0).get<std::uint64_t>();
+      std::uint64_t size = found->at(1).get<std::uint64_t>();
+
+      // Bloques: [offset sin comprimir, offset comprimido], ordenados
+      const auto &blocks = parsed.at("blocks");
+      std::uint64_t dataEnd = parsed.at("compressed_end").get<std::uint64_t>();
+
+      ArchiveMember member;
+      member.path = path;
+      member.size = size;
+
+      // Primer bloque: el ultimo que empieza en o antes de dataOffset
+      std::size_t first = 0;
+      while (first + 1 < blocks.size() && blocks[first + 1][0].get<std::uint64_t>() <= dataOffset) ++first;
+
+      // Primer bloque que empieza despues del final del archivo (o el final de los datos deflate)
+      std::uint64_t endOffset = dataOffset + size;
+      std::size_t next = first + 1;
+      while (next < blocks.size() && blocks[next][0].get<std::uint64_t>() < endOffset) ++next;
+
+      member.compressedOffset = blocks[first][1].get<std::uint64_t>();
+      std::uint64_t compressedEnd = next < blocks.size() ? blocks[next][1].get<std::uint64_t>() : dataEnd;
+      member.compressedLength = compressedEnd - member.compressedOffset;
+      member.skip = dataOffset - blocks[first][0].get<std::uint64_t>();
+      return member;
+   }
+
+
+   // Inflate crudo desde el inicio de un bloque independiente; se descartan `skip` bytes
+   // y se emiten exactamente `size` bytes del archivo
+   void inflateArchiveMember(const ArchiveMember &member, const ByteProducer &compressed, const ByteSink &out) override {
+      if (member.size == 0) return;
+
+      z_stream zs{};
+      if (inflateInit2(&zs, -15) != Z_OK)
+         throw std::runtime_error("Could not initialize gzip decompressor");
+
+      std::uint64_t toSkip = member.skip;
+      std::uint64_t remaining = member.size;
+      std::vector<char> buffer(64 * 1024);
+      bool streamEnded = false;
+
+      try {
+         compressed([&](const char *data, std::size_t size) {
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            zs.avail_in = static_cast<uInt>(size);
+
+            while (zs.avail_in > 0 && remaining > 0 && !streamEnded) {
+               zs.next_out = reinterpret_cast<Bytef*>(buffer.data());
+               zs.avail_out = static_cast<uInt>(buffer.size());
+               int ret = inflate(&zs, Z_NO_FLUSH);
+               if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                  throw std::runtime_error("Corrupted archive data");
+               streamEnded = ret == Z_STREAM_END;
+
+               std::uint64_t produced = buffer.size() - zs.avail_out;
+               const char *chunk = buffer.data();
+               std::uint64_t skipped = std::min(toSkip, produced);
+               toSkip -= skipped;
+               chunk += skipped;
+               produced -= skipped;
+
+               std::uint64_t emit = std::min(produced, remaining);
+               if (emit > 0) out(chunk, static_cast<std::size_t>(emit));
+               remaining -= emit;
+            }
+         });
+      } catch (...) {
+         inflateEnd(&zs);
+         throw;
+      }
+      inflateEnd(&zs);
+
+      if (remaining > 0)
+         throw std::runtime_error("Archive data ended before the file " + member.path);
+   }
+
+
+   std::filesystem::path cipherFilePath(const std::string &name, const std::string &projectAlias, std::uint32_t generation) override {
+      return cipherPath_ / (generationPrefix(name, projectAlias, generation) + ".tar.enc");
+   }
+
+
+   std::filesystem::path snapshotFilePath(const std::string &name, const std::string &projectAlias,
+                                          std::uint32_t generation, std::uint32_t snapshot) override {
+      if (snapshot == 0) return cipherFilePath(name, projectAlias, generation);
+      return cipherPath_ / (generationPrefix(name, projectAlias, generation) + ".d" + std::to_string(snapshot) + ".tar.enc");
+   }
+
+
+   std::uint32_t lastSnapshot(const std::string &name, const std::string &projectAlias, std::uint32_t generation) override {
+      std::uint32_t snapshot = 0;
+      while (std::filesystem::is_regular_file(snapshotFilePath(name, projectAlias, generation, snapshot + 1))) ++snapshot;
+      return snapshot;
+   }
+
+
+   std::filesystem::path manifestFilePath(const std::string &name, const std::string &projectAlias, std::uint32_t generation) override {
+      return cipherPath_ / (generationPrefix(name, projectAlias, generation) + ".manifest.enc");
+   }
+
+
+   // Del ultimo delta al archivo base: si se corta a la mitad los deltas que quedan siguen siendo 1..k
+   std::size_t discardGeneration(const std::string &name, const std::string &projectAlias, std::uint32_t generation) override {
+      std::vector<std::filesystem::path> files;
+      std::uint32_t last = lastSnapshot(name, projectAlias, generation);
+      // el delta siguiente puede haber quedado como .part de un cifrado interrumpido
+      for (std::uint32_t snapshot = last + 1; snapshot > 0; --snapshot)
+         files.push_back(snapshotFilePath(name, projectAlias, generation, snapshot));
+      files.push_back(cipherFilePath(name, projectAlias, generation));
+      files.push_back(manifestFilePath(name, projectAlias, generation));
+
+      std::size_t removed = 0;
+      for (const std::filesystem::path &file : files) {
+         std::filesystem::path part = file;
+         part += ".part";
+         removed += std::filesystem::remove(file) ? 1 : 0;
+         removed += std::filesystem::remove(part) ? 1 : 0;
+      }
+      return removed;
+   }
+
+
+   // Recorre la carpeta con lstat (sin seguir enlaces). Los enlaces se hashean por su destino; los
+   // archivos nuevos o con otro tamaño/mtime se hashean en paralelo en el pool de compresion
+   RepoManifest scanRepository(const std::string &name, const RepoManifest &previous) override {
+      std::filesystem::path repoPath = rootPath_ / name;
+      if (!std::filesystem::is_directory(repoPath))
+         throw std::runtime_error("Repository directory does not exist: " + name);
+
+      RepoManifest current;
+      current.snapshot = previous.snapshot;
+      std::vector<std::string> toHash;
+
+      for (const auto &entry : std::filesystem::recursive_directory_iterator(repoPath)) {
+         struct stat st;
+         if (::lstat(entry.path().c_str(), &st) != 0)
+            throw std::runtime_error("Could not stat file: " + entry.path().string());
+
+         std::string path = entry.path().lexically_relative(repoPath).generic_string();
+         ManifestEntry file;
+         file.mtimeNs = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+
+         if (S_ISLNK(st.st_mode)) {
+            std::string target = std::filesystem::read_symlink(entry.path()).string();
+            CryptoPP::SHA256 hash;
+            hash.Update(reinterpret_cast<const CryptoPP::byte*>(target.data()), target.size());
+            file.size = target.size();
+            file.sha256 = hexDigest(hash);
+            file.symlink = true;
+         } else if (S_ISREG(st.st_mode)) {
+            file.size = static_cast<std::uint64_t>(st.st_size);
+            auto found = previous.files.find(path);
+            if (found != previous.files.end() && !found->second.symlink &&
+                found->second.size == file.size && found->second.mtimeNs == file.mtimeNs)
+               file.sha256 = found->second.sha256;
+            else
+               toHash.push_back(path);
+         } else {
+            continue;   // carpetas (se recorren), sockets, fifos y dispositivos
+         }
+         current.files.emplace(std::move(path), std::move(file));
+      }
+
+      std::vector<std::future<std::string>> hashes;
+      hashes.reserve(toHash.size());
+      for (const std::string &path : toHash)
+         hashes.push_back(compressPool_.submit([file = repoPath / path] { return sha256File(file); }));
+      for (std::size_t i = 0; i < toHash.size(); ++i)
+         current.files[toHash[i]].sha256 = hashes[i].get();
+
+      return current;
+   }
+
+
+   // {"version": 1, "snapshot": N, "files": {ruta: [tamaño, mtime ns, sha256, enlace]}}
+   std::string serializeManifest(const RepoManifest &manifest) override {
+      nlohmann::json files = nlohmann::json::object();
+      for (const auto &[path, entry] : manifest.files)
+         files[path] = {entry.size, entry.mtimeNs, entry.sha256, entry.symlink};
+
+      nlohmann::json serialized;
+      serialized["version"] = 1;
+      serialized["snapshot"] = manifest.snapshot;
+      serialized["files"] = std::move(files);
+      return serialized.dump();
+   }
+
+
+   RepoManifest parseManifest(const std::string &serialized) override {
+      nlohmann::json parsed = nlohmann::json::parse(serialized);
+      if (parsed.value("version", 0) != 1)
+         throw std::runtime_error("Unsupported manifest version");
+
+      RepoManifest manifest;
+      manifest.snapshot = parsed.at("snapshot").get<std::uint32_t>();
+      for (const auto &[path, entry] : parsed.at("files").items()) {
+         ManifestEntry file;
+         file.size = entry.at(0).get<std::uint64_t>();
+         file.mtimeNs = entry.at(1).get<std::int64_t>();
+         file.sha256 = entry.at(2).get<std::string>();
+         file.symlink = entry.at(3).get<bool>();
+         manifest.files.emplace(path, std::move(file));
+      }
+      return manifest;
+   }
+
+
+   // Mismo layout e indice que folderToTarStream, con solo las rutas cambiadas
+   std::string deltaToTarStream(const std::string &name, const ManifestDiff &diff, std::uint32_t snapshot, const ByteSink &out) override {
+      std::filesystem::path repoPath = rootPath_ / name;
+      if (!std::filesystem::is_directory(repoPath))
+         throw std::runtime_error("Repository directory does not exist: " + name);
+
+      if (snapshot == 0)
+         throw std::runtime_error("A delta snapshot number must be greater than 0");
+
+      ParallelGzipWriter gzip(out, compressPool_, compressBlockSize_, Z_DEFAULT_COMPRESSION, true, blockCutter());
+      TarWriter tar(gzip.sink());
+      for (const std::string &path : diff.changed) tar.addPath(repoPath, name, path);
+      tar.finish();
+      gzip.finish();
+
+      nlohmann::json index = buildArchiveIndex(tar.members(), gzip.blocks(), gzip.compressedDataEnd());
+      index["snapshot"] = snapshot;
+      index["parent"] = snapshot - 1;
+      index["deleted"] = diff.deleted;
+      return index.dump();
+   }
+
+
+   // El archivo base no lleva "snapshot" en su indice (0)
+   std::vector<std::string> snapshotTombstones(const std::string &index, std::uint32_t snapshot) override {
+      nlohmann::json parsed = nlohmann::json::parse(index);
+      std::uint32_t found = parsed.value("snapshot", 0u);
+      if (found != snapshot)
+         throw std::runtime_error("Archive index belongs to snapshot " + std::to_string(found) +
+                                  ", expected " + std::to_string(snapshot));
+      return parsed.value("deleted", std::vector<std::string>{});
+   }
+
+
+   void readCipherRange(const std::filesystem::path &cipherFile, std::uint64_t offset, std::uint64_t length, const ByteSink &out) override {
+      std::ifstream in(cipherFile, std::ios::binary);
+      if (!in)
+         throw std::runtime_error("Could not open cipher file: " + cipherFile.string());
+
+      in.seekg(static_cast<std::streamoff>(offset));
+      std::vector<char> buffer(static_cast<std::size_t>(std::min<std::uint64_t>(length, READ_BUFFER_SIZE)));
+      std::uint64_t remaining = length;
+      while (remaining > 0) {
+         std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, buffer.size()));
+         in.read(buffer.data(), want);
+         std::size_t got = static_cast<std::size_t>(in.gcount());
+         if (got == 0)
+            throw std::runtime_error("Cipher file ended before the requested range: " + cipherFile.string());
+         out(buffer.data(), got);
+         remaining -= got;
+      }
+   }
+
+
+   // Subida por streaming: el contenido va directo a <root>/.uploads/<name>.<n>.tar.gz.part
+   // y se hashea conforme llega (memoria constante, sin pasar por req.body)
+   StagedUpload stageUpload(const std::string &name, const ByteProducer &producer) override {
+      validateRepoName(name);
+      std::filesystem::path uploadDir = rootPath_ / ".uploads";
+      std::filesystem::create_directories(uploadDir);
+
+      StagedUpload upload;
+      upload.path = uploadDir / (name + "." + uniqueSuffix() + ".tar.gz.part");
+      upload.size = 0;
+
+      std::ofstream file(upload.path, std::ios::binary);
+      if (!file)
+         throw std::runtime_error("Could not create upload file: " + upload.path.string());
+
+      try {
+         CryptoPP::SHA256 hash;
+         producer([&file, &hash, &upload](const char *data, std::size_t size) {
+            hash.Update(reinterpret_cast<const CryptoPP::byte*>(data), size);
+            file.write(data, size);
+            if (!file)
+               throw std::runtime_error("Could not write upload file");
+            upload.size += size;
+         });
+
+         file.close();
+         if (!file)
+            throw std::runtime_error("Could not write upload file: " + upload.path.string());
+
+         upload.sha256 = hexDigest(hash);
+      } catch (...) {
+         file.close();
+         std::error_code ec;
+         std::filesystem::remove(upload.path, ec);
+         throw;
+      }
+
+      return upload;
+   }
+
+
+   // Extraer en <root>/.staging/<name>.<n> y luego intercambiar con <root>/<name> usando
+   // renameat2(RENAME_EXCHANGE): los lectores ven la carpeta anterior completa o la nueva completa
+   void replaceFolderFromArchive(const std::string &name, const std::filesystem::path &archivePath) override {
+      validateRepoName(name);
+      std::filesystem::path repoPath = rootPath_ / name;
+      std::filesystem::path stagingDir = rootPath_ / ".staging";
+      std::filesystem::create_directories(stagingDir);
+
+      std::filesystem::path stagingPath = stagingDir / (name + "." + uniqueSuffix());
+      std::filesystem::create_directories(stagingPath);
+
+      // Mismo layout que genera folderToTarStream: "<name>/..." → se quita el primer componente.
+      // Se extrae en proceso con TarReader, igual que extractArchiveStream: sin fork/exec, rutas
+      // limpias (sin "/" inicial ni ".."), enlaces creados al final y sin dueños del cliente
+      try {
+         std::ifstream archive(archivePath, std::ios::binary);
+         if (!archive)
+            throw std::runtime_error("Could not open uploaded archive: " + archivePath.string());
+
+         TarReader tar(stagingPath, 1);
+         GzipReader gunzip(tar.sink());
+         std::vector<char> buffer(64 * 1024);
+         while (archive) {
+            archive.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (archive.gcount() > 0) gunzip.write(buffer.data(), static_cast<std::size_t>(archive.gcount()));
+         }
+         if (archive.bad())
+            throw std::runtime_error("Could not read uploaded archive: " + archivePath.string());
+         gunzip.finish();
+         tar.finish();
+      } catch (const std::exception &e) {
+         std::error_code ec;
+         std::filesystem::remove_all(stagingPath, ec);
+         throw std::runtime_error("Failed to extract uploaded archive for repository " + name + ": " + e.what());
+      }
+
+      installStagedFolder(stagingPath, repoPath, name);
+   }
+
+
+   // Descifrado → gunzip → extraccion sin archivos intermedios: los bytes solo tocan disco como
+   // archivos finales dentro de la carpeta temporal, que se instala igual que en replaceFolderFromArchive.
+   // El productor solo emite segmentos ya autenticados; si falla a la mitad (tag invalido, archivo
+   // truncado) se borra la carpeta temporal y la carpeta del repositorio queda intacta.
+   // Con deltas, todas las capas se extraen sobre la misma carpeta temporal antes de instalarla
+   void extractArchiveStream(const std::string &name, const std::vector<ArchiveLayer> &layers) override {
+      validateRepoName(name);
+      std::filesystem::path repoPath = rootPath_ / name;
+      std::filesystem::path stagingDir = rootPath_ / ".staging";
+      std::filesystem::create_directories(stagingDir);
+
+      std::filesystem::path stagingPath = stagingDir / (name + "." + uniqueSuffix());
+      std::filesystem::create_directories(stagingPath);
+
+      try {
+         // Mismo layout que genera folderToTarStream: "<name>/..." → se quita el primer componente
+         TarReader tar(stagingPath, 1);
+         for (const ArchiveLayer &layer : layers) {
+            // los tombstones van antes que las entradas del delta (una ruta puede pasar de carpeta a archivo)
+            for (const std::string &path : layer.deleted) tar.remove(path);
+
+            GzipReader gunzip(tar.sink());
+            layer.tarGz(gunzip.sink());
+            gunzip.finish();
+            tar.finishArchive();
+         }
+         tar.finish();
+      } catch (...) {
+         std::error_code ec;
+         std::filesystem::remove_all(stagingPath, ec);
+         throw;
+      }
+
+      installStagedFolder(stagingPath, repoPath, name);
+   }
+
+
+   void discardUpload(const StagedUpload &upload) override {
+      std::error_code ec;
+      std::filesystem::remove(upload.path, ec);
    }
 
    
@@ -189,6 +635,101 @@ public:
 
 
 private:
+   static constexpr std::size_t READ_BUFFER_SIZE = 256 * 1024;
+
+   // Los nombres llegan de la API: evitar rutas fuera de la raiz y carpetas internas (.uploads, .staging)
+   static void validateRepoName(const std::string &name) {
+      bool valid = !name.empty() && name[0] != '.' &&
+         std::all_of(name.begin(), name.end(), [](unsigned char c) {
+            return std::isalnum(c) || c == '_' || c == '-' || c == '.';
+         });
+      if (!valid)
+         throw std::runtime_error("Invalid repository name: " + name);
+   }
+
+   // Mueve una carpeta ya extraida a <root>/<name>. Si ya existe, renameat2(RENAME_EXCHANGE) las
+   // intercambia: los lectores ven la carpeta anterior completa o la nueva completa
+   static void installStagedFolder(const std::filesystem::path &stagingPath, const std::filesystem::path &repoPath,
+                                   const std::string &name) {
+      std::error_code ec;
+      if (!std::filesystem::exists(repoPath)) {
+         std::filesystem::rename(stagingPath, repoPath);
+         return;
+      }
+
+      if (::renameat2(AT_FDCWD, stagingPath.c_str(), AT_FDCWD, repoPath.c_str(), RENAME_EXCHANGE) != 0) {
+         std::filesystem::remove_all(stagingPath, ec);
+         throw std::runtime_error("Could not swap repository folder: " + name);
+      }
+
+      // Despues del intercambio, stagingPath tiene el contenido anterior
+      std::filesystem::remove_all(stagingPath, ec);
+   }
+
+   // Sufijo unico para temporales de subida/extraccion
+   std::string uniqueSuffix() {
+      return std::to_string(::getpid()) + "-" + std::to_string(tempCounter_.fetch_add(1));
+   }
+
+   // Indice JSON: miembros {ruta: [offset de datos en el tar, tamaño]} y la tabla de bloques gzip
+   static nlohmann::json buildArchiveIndex(const std::vector<TarWriter::Member> &members,
+                                        const std::vector<ParallelGzipWriter::BlockOffset> &blocks,
+                                        std::uint64_t compressedEnd) {
+      nlohmann::json index;
+      index["version"] = 1;
+      index["compressed_end"] = compressedEnd;
+
+      nlohmann::json blockTable = nlohmann::json::array();
+      for (const auto &block : blocks) {
+         blockTable.push_back({block.raw, block.compressed});
+      }
+      index["blocks"] = std::move(blockTable);
+
+      nlohmann::json memberTable = nlohmann::json::object();
+      for (const auto &member : members) {
+         memberTable[member.path] = {member.dataOffset, member.size};
+      }
+      index["members"] = std::move(memberTable);
+
+      return index;
+   }
+
+   // Generacion 0: <repo>_<alias> (nombres anteriores a las generaciones); N > 0: <repo>_<alias>.g<N>
+   static std::string generationPrefix(const std::string &name, const std::string &projectAlias, std::uint32_t generation) {
+      std::string prefix = name + "_" + projectAlias;
+      if (generation > 0) prefix += ".g" + std::to_string(generation);
+      return prefix;
+   }
+
+   static std::string hexDigest(CryptoPP::SHA256 &hash) {
+      CryptoPP::byte digest[CryptoPP::SHA256::DIGESTSIZE];
+      hash.Final(digest);
+      std::string hex;
+      CryptoPP::StringSource ss(digest, sizeof(digest), true,
+         new CryptoPP::HexEncoder(new CryptoPP::StringSink(hex), false));
+      return hex;
+   }
+
+   static std::string sha256File(const std::filesystem::path &path) {
+      std::ifstream in(path, std::ios::binary);
+      if (!in)
+         throw std::runtime_error("Could not open file for hashing: " + path.string());
+
+      CryptoPP::SHA256 hash;
+      std::vector<char> buffer(READ_BUFFER_SIZE);
+      while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0)
+         hash.Update(reinterpret_cast<const CryptoPP::byte*>(buffer.data()), static_cast<std::size_t>(in.gcount()));
+      return hexDigest(hash);
+   }
+
+   // Cortes por contenido para los tar.gz con indice (nullptr = bloques fijos)
+   const FastCdc *blockCutter() const { return contentDefinedBlocks_ ? &blockCutter_ : nullptr; }
+
    std::filesystem::path rootPath_;
    std::filesystem::path cipherPath_;
+   ThreadPool &compressPool_;
+   std::size_t compressBlockSize_;
+   FastCdc blockCutter_;
+   bool contentDefinedBlocks_;
+   std::atomic<std::uint64_t> tempCounter_{0};
 };
@@ -0,0 +1,89 @@
+// infrastructure/storage/GzipReader.hpp
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "../../domain/utils/ByteStream.hpp"
+
+// Descompresor gzip en streaming (zlib): recibe bloques con write() y emite
+// el contenido descomprimido al ByteSink conforme se llena su buffer.
+// Acepta varios miembros gzip concatenados (como `gzip -d`).
+class GzipReader {
+public:
+   explicit GzipReader(ByteSink out, std::size_t bufferSize = 64 * 1024)
+      : out_(std::move(out)), buffer_(bufferSize ? bufferSize : 64 * 1024) {
+      // windowBits 15 + 32 → detectar cabecera gzip (o zlib) automaticamente
+      if (inflateInit2(&zs_, 15 + 32) != Z_OK)
+         throw std::runtime_error("Could not initialize gzip decompressor");
+   }
+
+   GzipReader(const GzipReader &) = delete;
+   GzipReader &operator=(const GzipReader &) = delete;
+
+   ~GzipReader() {
+      inflateEnd(&zs_);
+   }
+
+   void write(const char *data, std::size_t size) {
+      // zlib recibe uInt; partir entradas muy grandes
+      while (size > 0) {
+         uInt chunk = static_cast<uInt>(std::min<std::size_t>(size, 1u << 30));
+         zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+         zs_.avail_in = chunk;
+         inflateAll();
+         data += chunk;
+         size -= chunk;
+      }
+   }
+
+   // Verifica que el ultimo miembro gzip haya terminado (trailer con CRC y tamaño incluidos)
+   void finish() {
+      if (!streamEnded_)
+         throw std::runtime_error("Gzip stream is truncated");
+   }
+
+   // Adaptador para encadenar con otros productores (ej. un descifrador)
+   ByteSink sink() {
+      return [this](const char *data, std::size_t size) { write(data, size); };
+   }
+
+private:
+   ByteSink out_;
+   std::vector<char> buffer_;
+   z_stream zs_{};
+   bool streamEnded_ = false;
+
+   void inflateAll() {
+      while (zs_.avail_in > 0) {
+         // datos despues del final de un miembro: empieza otro miembro gzip
+         if (streamEnded_) {
+            if (inflateReset(&zs_) != Z_OK)
+               throw std::runtime_error("Could not reset gzip decompressor");
+            streamEnded_ = false;
+         }
+
+         do {
+            zs_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+            zs_.avail_out = static_cast<uInt>(buffer_.size());
+            int ret = inflate(&zs_, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+               throw std::runtime_error("Corrupted gzip data");
+
+            std::size_t produced = buffer_.size() - zs_.avail_out;
+            if (produced > 0) out_(buffer_.data(), produced);
+
+            if (ret == Z_STREAM_END) {
+               streamEnded_ = true;
+               break;
+            }
+            if (ret == Z_BUF_ERROR && produced == 0) {
+               if (zs_.avail_in > 0)
+                  throw std::runtime_error("Corrupted gzip data");
+               break;
+            }
+         } while (zs_.avail_out == 0 || zs_.avail_in > 0);
+      }
+   }
+};
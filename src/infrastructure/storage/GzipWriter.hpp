@@ -0,0 +1,75 @@
+// infrastructure/storage/GzipWriter.hpp
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "../../domain/utils/ByteStream.hpp"
+
+// Compresor gzip en streaming (zlib): recibe bloques con write() y emite
+// la salida comprimida al ByteSink conforme se llena su buffer
+class GzipWriter {
+public:
+   explicit GzipWriter(ByteSink out, int level = Z_DEFAULT_COMPRESSION, std::size_t bufferSize = 64 * 1024)
+      : out_(std::move(out)), buffer_(bufferSize ? bufferSize : 64 * 1024) {
+      // windowBits 15 + 16 → cabecera y trailer gzip (compatible con `tar -xzf`)
+      if (deflateInit2(&zs_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+         throw std::runtime_error("Could not initialize gzip compressor");
+   }
+
+   GzipWriter(const GzipWriter &) = delete;
+   GzipWriter &operator=(const GzipWriter &) = delete;
+
+   ~GzipWriter() {
+      deflateEnd(&zs_);
+   }
+
+   void write(const char *data, std::size_t size) {
+      if (finished_)
+         throw std::runtime_error("Gzip stream already finished");
+
+      // zlib recibe uInt; partir entradas muy grandes
+      while (size > 0) {
+         uInt chunk = static_cast<uInt>(std::min<std::size_t>(size, 1u << 30));
+         zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+         zs_.avail_in = chunk;
+         deflateAll(Z_NO_FLUSH);
+         data += chunk;
+         size -= chunk;
+      }
+   }
+
+   void finish() {
+      if (finished_) return;
+      zs_.next_in = nullptr;
+      zs_.avail_in = 0;
+      deflateAll(Z_FINISH);
+      finished_ = true;
+   }
+
+   // Adaptador para encadenar con otros productores (ej. TarWriter)
+   ByteSink sink() {
+      return [this](const char *data, std::size_t size) { write(data, size); };
+   }
+
+private:
+   ByteSink out_;
+   std::vector<char> buffer_;
+   z_stream zs_{};
+   bool finished_ = false;
+
+   void deflateAll(int flush) {
+      int ret;
+      do {
+         zs_.next_out = reinterpret_cast<Bytef*>(buffer_.data());
+         zs_.avail_out = static_cast<uInt>(buffer_.size());
+         ret = deflate(&zs_, flush);
+         if (ret == Z_STREAM_ERROR)
+            throw std::runtime_error("Gzip compression failed");
+
+         std::size_t produced = buffer_.size() - zs_.avail_out;
+         if (produced > 0) out_(buffer_.data(), produced);
+      } while (zs_.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+   }
+};
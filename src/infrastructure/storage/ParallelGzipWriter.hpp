@@ -0,0 +1,223 @@
+// infrastructure/storage/ParallelGzipWriter.hpp
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <zlib.h>
+#include "../concurrency/ThreadPool.hpp"
+#include "FastCdc.hpp"
+#include "../../domain/utils/ByteStream.hpp"
+
+// Compresor gzip por bloques en paralelo (estilo pigz).
+// La entrada se parte en bloques de blockSize bytes que se comprimen como deflate crudo
+// en el ThreadPool; cada bloque usa los ultimos 32 KiB del anterior como diccionario y
+// termina con Z_SYNC_FLUSH, el ultimo con Z_FINISH. Al concatenarlos en orden se obtiene
+// un unico miembro gzip valido (se descomprime con `gzip -d` / `tar -xzf` sin cambios).
+//
+// Con independentBlocks los bloques no usan diccionario: se puede empezar a descomprimir
+// (inflate crudo) en el inicio de cualquier bloque, usando la tabla de blocks().
+//
+// Con cutter los bloques se cortan por contenido (FastCDC sobre los datos sin comprimir) en vez
+// de cada blockSize bytes, y el ultimo bloque con datos tambien termina con Z_SYNC_FLUSH (el
+// Z_FINISH va en un bloque vacio aparte). Con bloques independientes, el mismo tramo de datos da
+// los mismos bytes comprimidos en cualquier archivo y en cualquier posicion: una insercion solo
+// cambia los bloques vecinos. Cada bloque se entrega al sink en una sola escritura.
+class ParallelGzipWriter {
+public:
+   // Inicio de cada bloque: offset en los datos sin comprimir y en el .gz
+   struct BlockOffset {
+      std::uint64_t raw;
+      std::uint64_t compressed;
+   };
+
+   explicit ParallelGzipWriter(ByteSink out, ThreadPool &pool,
+                               std::size_t blockSize = 1 << 20,
+                               int level = Z_DEFAULT_COMPRESSION,
+                               bool independentBlocks = false,
+                               const FastCdc *cutter = nullptr)
+      : out_(std::move(out)), pool_(pool),
+        blockSize_(std::max<std::size_t>(blockSize, 64 * 1024)), level_(level),
+        maxInFlight_(2 * pool.size() + 1), independentBlocks_(independentBlocks), cutter_(cutter) {
+      current_ = std::make_shared<std::vector<char>>();
+      if (!cutter_) current_->reserve(blockSize_);
+      writeHeader();
+   }
+
+   ParallelGzipWriter(const ParallelGzipWriter &) = delete;
+   ParallelGzipWriter &operator=(const ParallelGzipWriter &) = delete;
+
+   ~ParallelGzipWriter() {
+      // Si hubo una excepcion, esperar a los bloques pendientes antes de liberar los buffers
+      for (auto &pending : inFlight_) {
+         if (pending.valid()) pending.wait();
+      }
+   }
+
+   void write(const char *data, std::size_t size) {
+      if (finished_)
+         throw std::runtime_error("Gzip stream already finished");
+
+      if (cutter_) {
+         current_->insert(current_->end(), data, data + size);
+         while (current_->size() >= cutter_->maxSize()) cutBlock();
+         return;
+      }
+
+      while (size > 0) {
+         std::size_t room = blockSize_ - current_->size();
+         std::size_t take = std::min(room, size);
+         current_->insert(current_->end(), data, data + take);
+         data += take;
+         size -= take;
+
+         if (current_->size() == blockSize_) submitBlock(false);
+      }
+   }
+
+   void finish() {
+      if (finished_) return;
+      if (cutter_) {
+         while (!current_->empty()) cutBlock();  // al final del stream el resto es un corte valido
+      }
+      submitBlock(true);
+      while (!inFlight_.empty()) emitOldest();
+      writeTrailer();
+      finished_ = true;
+   }
+
+   // Adaptador para encadenar con otros productores (ej. TarWriter)
+   ByteSink sink() {
+      return [this](const char *data, std::size_t size) { write(data, size); };
+   }
+
+   // Tabla de bloques (completa despues de finish())
+   const std::vector<BlockOffset> &blocks() const { return blocks_; }
+
+   // Offset en el .gz donde terminan los datos deflate (inicio del trailer)
+   std::uint64_t compressedDataEnd() const { return bytesOut_ - (finished_ ? 8 : 0); }
+
+private:
+   static constexpr std::size_t DICT_SIZE = 32 * 1024;
+
+   struct CompressedBlock {
+      std::vector<char> data;
+      uLong crc;
+      std::size_t rawSize;
+   };
+
+   ByteSink out_;
+   ThreadPool &pool_;
+   std::size_t blockSize_;
+   int level_;
+   std::size_t maxInFlight_;
+   bool independentBlocks_;
+   const FastCdc *cutter_;
+
+   std::shared_ptr<std::vector<char>> current_;
+   std::shared_ptr<std::vector<char>> previous_;
+   std::deque<std::future<CompressedBlock>> inFlight_;
+
+   uLong crc_ = crc32(0L, Z_NULL, 0);
+   std::uint64_t totalIn_ = 0;
+   std::uint64_t bytesOut_ = 0;
+   std::vector<BlockOffset> blocks_;
+   bool finished_ = false;
+
+   // Envia como bloque el primer tramo de current_ segun el cutter; el resto queda en current_
+   void cutBlock() {
+      std::size_t length = cutter_->cut(current_->data(), current_->size());
+      auto rest = std::make_shared<std::vector<char>>(current_->begin() + length, current_->end());
+      current_->resize(length);
+      submitBlock(false);
+      current_ = std::move(rest);
+   }
+
+   void submitBlock(bool last) {
+      std::shared_ptr<std::vector<char>> input = current_;
+      std::shared_ptr<std::vector<char>> dictionary = independentBlocks_ ? nullptr : previous_;
+      int level = level_;
+
+      inFlight_.push_back(pool_.submit([input, dictionary, last, level] {
+         return compressBlock(*input, dictionary.get(), last, level);
+      }));
+
+      previous_ = input;
+      current_ = std::make_shared<std::vector<char>>();
+      if (!cutter_) current_->reserve(blockSize_);
+
+      // Limitar la memoria: como mucho maxInFlight_ bloques pendientes
+      while (inFlight_.size() >= maxInFlight_) emitOldest();
+   }
+
+   void emitOldest() {
+      CompressedBlock block = inFlight_.front().get();
+      inFlight_.pop_front();
+
+      blocks_.push_back(BlockOffset{totalIn_, bytesOut_});
+      crc_ = crc32_combine(crc_, block.crc, static_cast<z_off_t>(block.rawSize));
+      totalIn_ += block.rawSize;
+      emit(block.data.data(), block.data.size());
+   }
+
+   void emit(const char *data, std::size_t size) {
+      if (size == 0) return;
+      out_(data, size);
+      bytesOut_ += size;
+   }
+
+   static CompressedBlock compressBlock(const std::vector<char> &input, const std::vector<char> *dictionary,
+                                        bool last, int level) {
+      CompressedBlock result;
+      result.rawSize = input.size();
+      result.crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(input.data()),
+                         static_cast<uInt>(input.size()));
+
+      z_stream zs{};
+      // windowBits negativo: deflate crudo, la cabecera/trailer gzip los escribe el writer
+      if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+         throw std::runtime_error("Could not initialize gzip block compressor");
+
+      if (dictionary && !dictionary->empty()) {
+         std::size_t dictLen = std::min(dictionary->size(), DICT_SIZE);
+         deflateSetDictionary(&zs,
+            reinterpret_cast<const Bytef*>(dictionary->data() + dictionary->size() - dictLen),
+            static_cast<uInt>(dictLen));
+      }
+
+      result.data.resize(deflateBound(&zs, static_cast<uLong>(input.size())) + 16);
+      zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+      zs.avail_in = static_cast<uInt>(input.size());
+      zs.next_out = reinterpret_cast<Bytef*>(result.data.data());
+      zs.avail_out = static_cast<uInt>(result.data.size());
+
+      int ret = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+      bool ok = last ? ret == Z_STREAM_END : (ret == Z_OK && zs.avail_in == 0);
+      result.data.resize(result.data.size() - zs.avail_out);
+      deflateEnd(&zs);
+
+      if (!ok)
+         throw std::runtime_error("Gzip block compression failed");
+      return result;
+   }
+
+   void writeHeader() {
+      // ID1 ID2 CM FLG MTIME(4) XFL OS
+      static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3 };
+      emit(header, sizeof(header));
+   }
+
+   void writeTrailer() {
+      char trailer[8];
+      std::uint32_t crc = static_cast<std::uint32_t>(crc_);
+      std::uint32_t isize = static_cast<std::uint32_t>(totalIn_ & 0xFFFFFFFFu);
+      for (int i = 0; i < 4; ++i) {
+         trailer[i]     = static_cast<char>((crc >> (8 * i)) & 0xFF);
+         trailer[4 + i] = static_cast<char>((isize >> (8 * i)) & 0xFF);
+      }
+      emit(trailer, sizeof(trailer));
+   }
+};
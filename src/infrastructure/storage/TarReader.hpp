@@ -0,0 +1,354 @@
+// infrastructure/storage/TarReader.hpp
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../domain/utils/ByteStream.hpp"
+
+// Extractor de archivos tar en streaming (ustar, cabeceras pax y nombres largos GNU): recibe los
+// bytes con write() y escribe las entradas bajo `destination` conforme llegan, sin pasar por `tar`.
+//
+// Es la contraparte de TarWriter. Las rutas se limpian antes de tocar disco: se quitan los primeros
+// `stripComponents` componentes (el "<name>/" que agrega TarWriter), se ignoran "/" y "." iniciales
+// y se rechaza cualquier "..". Los enlaces simbolicos se crean al final (finish), asi ningun archivo
+// del tar se escribe a traves de un enlace del mismo tar. No se conservan dueños; sockets, fifos,
+// dispositivos y enlaces duros se omiten (TarWriter no los genera).
+//
+// Se pueden extraer varios tar seguidos sobre la misma carpeta (archivo base y deltas): finishArchive()
+// cierra uno, remove() aplica los tombstones de un delta (antes de extraerlo) y una entrada posterior
+// reemplaza a la anterior.
+class TarReader {
+public:
+   explicit TarReader(std::filesystem::path destination, std::size_t stripComponents = 1)
+      : destination_(std::move(destination)), stripComponents_(stripComponents) {}
+
+   void write(const char *data, std::size_t size) {
+      while (size > 0) {
+         std::size_t used = 0;
+         switch (state_) {
+            case State::Header:   used = readHeader(data, size); break;
+            case State::Data:     used = readData(data, size); break;
+            case State::Metadata: used = readMetadata(data, size); break;
+            case State::Padding:  used = skipPadding(size); break;
+            case State::End:      return;   // relleno despues de los bloques de cierre
+         }
+         data += used;
+         size -= used;
+      }
+   }
+
+   // Verifica que el tar actual termino en un limite de entrada; despues se puede escribir el siguiente
+   void finishArchive() {
+      if (state_ != State::End && !(state_ == State::Header && headerFill_ == 0))
+         throw std::runtime_error("Tar archive is truncated");
+      state_ = State::Header;
+      zeroBlocks_ = 0;
+   }
+
+   // Borra una ruta (relativa a destination, sin componentes a quitar) extraida por un tar anterior,
+   // y las carpetas que queden vacias por eso
+   void remove(const std::string &path) {
+      std::filesystem::path target = sanitize(path, 0);
+      if (target.empty()) return;
+      symlinks_.erase(target);
+      clearTarget(target);
+
+      std::error_code ec;
+      for (std::filesystem::path dir = target.parent_path(); dir != destination_ && dir.has_relative_path();
+           dir = dir.parent_path()) {
+         if (!std::filesystem::is_empty(dir, ec) || ec || !std::filesystem::remove(dir, ec)) break;
+      }
+   }
+
+   // Cierra el ultimo tar y crea los enlaces simbolicos
+   void finish() {
+      finishArchive();
+
+      for (const auto &link : symlinks_) {
+         std::filesystem::create_directories(link.first.parent_path());
+         std::filesystem::create_symlink(link.second, link.first);
+      }
+      symlinks_.clear();
+   }
+
+   ByteSink sink() {
+      return [this](const char *data, std::size_t size) { write(data, size); };
+   }
+
+   std::uint64_t filesExtracted() const { return files_; }
+   std::uint64_t bytesExtracted() const { return bytes_; }
+
+private:
+   static constexpr std::size_t BLOCK = 512;
+   static constexpr std::uint64_t MAX_METADATA_SIZE = 1 << 20;   // pax / nombres largos
+
+   enum class State { Header, Data, Metadata, Padding, End };
+
+   std::filesystem::path destination_;
+   std::size_t stripComponents_;
+   State state_ = State::Header;
+
+   char header_[BLOCK];
+   std::size_t headerFill_ = 0;
+   int zeroBlocks_ = 0;
+
+   std::uint64_t remaining_ = 0;   // bytes de datos de la entrada actual
+   std::uint64_t padding_ = 0;     // relleno hasta el siguiente bloque
+   std::ofstream file_;
+   std::filesystem::path filePath_;
+   std::uint32_t fileMode_ = 0644;
+   std::int64_t fileMtime_ = 0;
+
+   char metadataType_ = 0;
+   std::string metadata_;
+
+   // Valores de la cabecera pax ('x') o GNU ('L', 'K') que aplican a la siguiente entrada
+   std::string nextPath_;
+   std::string nextLink_;
+   bool hasNextSize_ = false;
+   std::uint64_t nextSize_ = 0;
+
+   std::map<std::filesystem::path, std::string> symlinks_;   // ruta → destino, pendientes hasta finish()
+   std::uint64_t files_ = 0;
+   std::uint64_t bytes_ = 0;
+
+   std::size_t readHeader(const char *data, std::size_t size) {
+      std::size_t take = std::min(BLOCK - headerFill_, size);
+      std::memcpy(header_ + headerFill_, data, take);
+      headerFill_ += take;
+      if (headerFill_ < BLOCK) return take;
+      headerFill_ = 0;
+
+      // Dos bloques de ceros cierran el archivo
+      if (std::all_of(header_, header_ + BLOCK, [](char c) { return c == 0; })) {
+         if (++zeroBlocks_ == 2) state_ = State::End;
+         return take;
+      }
+      zeroBlocks_ = 0;
+      startEntry();
+      return take;
+   }
+
+   void startEntry() {
+      if (!checksumMatches())
+         throw std::runtime_error("Invalid tar header checksum");
+
+      char type = header_[156];
+      std::uint64_t size = parseNumber(header_ + 124, 12);
+      if (hasNextSize_) size = nextSize_;
+
+      std::string name = nextPath_.empty() ? headerName() : nextPath_;
+      std::string link = nextLink_.empty() ? field(header_ + 157, 100) : nextLink_;
+      std::uint32_t mode = static_cast<std::uint32_t>(parseNumber(header_ + 100, 8)) & 07777;
+      std::int64_t mtime = static_cast<std::int64_t>(parseNumber(header_ + 136, 12));
+
+      // Cabeceras de metadatos: su contenido aplica a la siguiente entrada
+      if (type == 'x' || type == 'g' || type == 'L' || type == 'K') {
+         if (size > MAX_METADATA_SIZE)
+            throw std::runtime_error("Tar metadata entry is too large");
+         metadataType_ = type;
+         metadata_.clear();
+         beginData(size, State::Metadata);
+         return;
+      }
+
+      nextPath_.clear();
+      nextLink_.clear();
+      hasNextSize_ = false;
+
+      std::filesystem::path target = sanitize(name, stripComponents_);
+
+      if (type == '0' || type == '\0' || type == '7') {
+         if (target.empty())
+            throw std::runtime_error("Invalid tar entry path: " + name);
+         symlinks_.erase(target);
+         clearTarget(target);
+         std::filesystem::create_directories(target.parent_path());
+         file_.open(target, std::ios::binary | std::ios::trunc);
+         if (!file_)
+            throw std::runtime_error("Could not create file: " + target.string());
+         filePath_ = target;
+         fileMode_ = mode;
+         fileMtime_ = mtime;
+         beginData(size, State::Data);
+         if (size == 0) closeFile();
+         return;
+      }
+
+      if (type == '5') {
+         if (!target.empty()) {
+            symlinks_.erase(target);
+            if (!std::filesystem::is_directory(std::filesystem::symlink_status(target))) clearTarget(target);
+            std::filesystem::create_directories(target);
+         }
+      } else if (type == '2') {
+         if (target.empty())
+            throw std::runtime_error("Invalid tar entry path: " + name);
+         clearTarget(target);
+         symlinks_[target] = link;
+      }
+      // enlaces duros, dispositivos y fifos: se omiten junto con sus datos (si tienen)
+      beginData(type == '5' || type == '2' ? 0 : size, State::Data);
+   }
+
+   void beginData(std::uint64_t size, State dataState) {
+      remaining_ = size;
+      padding_ = (BLOCK - size % BLOCK) % BLOCK;
+      state_ = size > 0 ? dataState : (padding_ > 0 ? State::Padding : State::Header);
+      if (size == 0 && dataState == State::Metadata) applyMetadata();
+   }
+
+   std::size_t readData(const char *data, std::size_t size) {
+      std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(remaining_, size));
+      if (file_.is_open()) {
+         file_.write(data, static_cast<std::streamsize>(take));
+         if (!file_)
+            throw std::runtime_error("Could not write file: " + filePath_.string());
+         bytes_ += take;
+      }
+      remaining_ -= take;
+      if (remaining_ == 0) {
+         if (file_.is_open()) closeFile();
+         state_ = padding_ > 0 ? State::Padding : State::Header;
+      }
+      return take;
+   }
+
+   std::size_t readMetadata(const char *data, std::size_t size) {
+      std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(remaining_, size));
+      metadata_.append(data, take);
+      remaining_ -= take;
+      if (remaining_ == 0) {
+         applyMetadata();
+         state_ = padding_ > 0 ? State::Padding : State::Header;
+      }
+      return take;
+   }
+
+   std::size_t skipPadding(std::size_t size) {
+      std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(padding_, size));
+      padding_ -= take;
+      if (padding_ == 0) state_ = State::Header;
+      return take;
+   }
+
+   void closeFile() {
+      file_.close();
+      if (!file_)
+         throw std::runtime_error("Could not write file: " + filePath_.string());
+
+      std::filesystem::permissions(filePath_, static_cast<std::filesystem::perms>(fileMode_ & 0777));
+      struct timespec times[2];
+      times[0].tv_sec = times[1].tv_sec = static_cast<time_t>(fileMtime_);
+      times[0].tv_nsec = times[1].tv_nsec = 0;
+      ::utimensat(AT_FDCWD, filePath_.c_str(), times, AT_SYMLINK_NOFOLLOW);
+      ++files_;
+   }
+
+   void applyMetadata() {
+      if (metadataType_ == 'L') {
+         nextPath_ = metadata_.substr(0, metadata_.find('\0'));
+      } else if (metadataType_ == 'K') {
+         nextLink_ = metadata_.substr(0, metadata_.find('\0'));
+      } else if (metadataType_ == 'x') {
+         // registros "<len> <key>=<value>\n"
+         std::size_t pos = 0;
+         while (pos < metadata_.size()) {
+            std::size_t space = metadata_.find(' ', pos);
+            if (space == std::string::npos) break;
+            std::uint64_t length = std::stoull(metadata_.substr(pos, space - pos));
+            if (length == 0 || pos + length > metadata_.size())
+               throw std::runtime_error("Invalid pax record");
+
+            std::string record = metadata_.substr(space + 1, pos + length - space - 2);
+            std::size_t equals = record.find('=');
+            if (equals != std::string::npos) {
+               std::string key = record.substr(0, equals);
+               std::string value = record.substr(equals + 1);
+               if (key == "path") nextPath_ = value;
+               else if (key == "linkpath") nextLink_ = value;
+               else if (key == "size") { nextSize_ = std::stoull(value); hasNextSize_ = true; }
+            }
+            pos += length;
+         }
+      }
+      // 'g' (pax global): sin campos que apliquen aqui
+      metadata_.clear();
+   }
+
+   bool checksumMatches() const {
+      std::uint64_t expected = parseNumber(header_ + 148, 8);
+      unsigned int sum = 0;
+      for (std::size_t i = 0; i < BLOCK; ++i)
+         sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header_[i]);
+      return sum == expected;
+   }
+
+   // ustar: prefix (155) + "/" + name (100)
+   std::string headerName() const {
+      std::string name = field(header_, 100);
+      if (std::memcmp(header_ + 257, "ustar", 5) == 0) {
+         std::string prefix = field(header_ + 345, 155);
+         if (!prefix.empty()) name = prefix + "/" + name;
+      }
+      return name;
+   }
+
+   static std::string field(const char *data, std::size_t width) {
+      return std::string(data, strnlen(data, width));
+   }
+
+   // Octal (con espacios / NUL) o base-256 (bit alto del primer byte)
+   static std::uint64_t parseNumber(const char *data, std::size_t width) {
+      const auto *bytes = reinterpret_cast<const unsigned char*>(data);
+      std::uint64_t value = 0;
+      if (bytes[0] & 0x80) {
+         for (std::size_t i = 1; i < width; ++i) value = (value << 8) | bytes[i];
+         return value;
+      }
+      std::size_t i = 0;
+      while (i < width && (bytes[i] == ' ' || bytes[i] == 0)) ++i;
+      for (; i < width && bytes[i] >= '0' && bytes[i] <= '7'; ++i) value = (value << 3) | (bytes[i] - '0');
+      return value;
+   }
+
+   // Un tar anterior dejo algo donde va la nueva entrada: quitarlo. Nunca se sigue un enlace ni se
+   // borra una carpeta con contenido (si queda una, la escritura posterior falla y lo reporta)
+   static void clearTarget(const std::filesystem::path &target) {
+      std::error_code ec;
+      std::filesystem::file_status status = std::filesystem::symlink_status(target, ec);
+      if (ec || !std::filesystem::exists(status)) return;
+      if (std::filesystem::is_directory(status)) std::filesystem::remove(target, ec);
+      else std::filesystem::remove(target);
+   }
+
+   // Ruta destino dentro de destination_, o vacia si la entrada es la carpeta raiz que se quita
+   std::filesystem::path sanitize(const std::string &name, std::size_t stripComponents) const {
+      std::vector<std::string> parts;
+      std::size_t start = 0;
+      while (start <= name.size()) {
+         std::size_t slash = name.find('/', start);
+         if (slash == std::string::npos) slash = name.size();
+         std::string part = name.substr(start, slash - start);
+         if (part == "..")
+            throw std::runtime_error("Tar entry escapes the destination: " + name);
+         if (!part.empty() && part != ".") parts.push_back(part);
+         start = slash + 1;
+      }
+
+      if (parts.size() <= stripComponents) return {};
+      std::filesystem::path target = destination_;
+      for (std::size_t i = stripComponents; i < parts.size(); ++i) target /= parts[i];
+      return target;
+   }
+};
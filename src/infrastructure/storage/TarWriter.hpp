@@ -0,0 +1,200 @@
+// infrastructure/storage/TarWriter.hpp
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../domain/utils/ByteStream.hpp"
+
+// Escritor de archivos tar (formato ustar + cabeceras pax para rutas largas o
+// archivos > 8 GiB) que emite los bytes a un ByteSink, sin pasar por disco ni por `tar`.
+class TarWriter {
+public:
+   // Archivo regular escrito en el tar: ruta relativa a la carpeta y offset de sus datos
+   struct Member {
+      std::string path;
+      std::uint64_t dataOffset;
+      std::uint64_t size;
+   };
+
+   explicit TarWriter(ByteSink out, std::size_t readBufferSize = 64 * 1024)
+      : out_(std::move(out)), readBuffer_(readBufferSize ? readBufferSize : 64 * 1024) {}
+
+   // Agregar recursivamente una carpeta; las entradas quedan bajo "<prefix>/..."
+   // (mismo layout que `tar -C <root> <prefix>`)
+   void addDirectoryTree(const std::filesystem::path &dirPath, const std::string &prefix) {
+      prefixSize_ = prefix.size() + 1;
+      addEntry(dirPath, prefix);
+   }
+
+   // Agregar una sola ruta de la carpeta (un delta): queda como "<prefix>/<relativePath>";
+   // las carpetas intermedias no se escriben (el extractor las crea)
+   void addPath(const std::filesystem::path &dirPath, const std::string &prefix, const std::string &relativePath) {
+      prefixSize_ = prefix.size() + 1;
+      addEntry(dirPath / relativePath, prefix + "/" + relativePath);
+   }
+
+   // Cerrar el archivo: dos bloques de ceros
+   void finish() {
+      static const char zeros[2 * BLOCK] = {};
+      emit(zeros, sizeof(zeros));
+   }
+
+   // Bytes emitidos hasta ahora (offset en el tar sin comprimir)
+   std::uint64_t offset() const { return offset_; }
+
+   // Archivos regulares escritos hasta ahora, en orden
+   const std::vector<Member> &members() const { return members_; }
+
+private:
+   static constexpr std::size_t BLOCK = 512;
+
+   ByteSink out_;
+   std::vector<char> readBuffer_;
+   std::uint64_t offset_ = 0;
+   std::size_t prefixSize_ = 0;
+   std::vector<Member> members_;
+
+   void emit(const char *data, std::size_t size) {
+      out_(data, size);
+      offset_ += size;
+   }
+
+   void pad(std::uint64_t size) {
+      static const char zeros[BLOCK] = {};
+      std::size_t rest = static_cast<std::size_t>(size % BLOCK);
+      if (rest != 0) emit(zeros, BLOCK - rest);
+   }
+
+   void addEntry(const std::filesystem::path &path, const std::string &name) {
+      struct stat st;
+      if (::lstat(path.c_str(), &st) != 0)
+         throw std::runtime_error("Could not stat file for tar: " + path.string());
+
+      if (S_ISDIR(st.st_mode)) {
+         writeHeader(name + "/", st, '5', 0, "");
+
+         // Ordenar las entradas para que el tar sea determinista
+         std::vector<std::filesystem::path> children;
+         for (const auto &entry : std::filesystem::directory_iterator(path)) {
+            children.push_back(entry.path());
+         }
+         std::sort(children.begin(), children.end());
+
+         for (const auto &child : children) {
+            addEntry(child, name + "/" + child.filename().string());
+         }
+      }
+      else if (S_ISREG(st.st_mode)) {
+         std::uint64_t size = static_cast<std::uint64_t>(st.st_size);
+         writeHeader(name, st, '0', size, "");
+         members_.push_back(Member{name.substr(std::min(prefixSize_, name.size())), offset_, size});
+         writeFileData(path, size);
+      }
+      else if (S_ISLNK(st.st_mode)) {
+         std::string target = std::filesystem::read_symlink(path).string();
+         writeHeader(name, st, '2', 0, target);
+      }
+      // sockets, fifos y dispositivos no se incluyen en el repositorio
+   }
+
+   void writeFileData(const std::filesystem::path &path, std::uint64_t size) {
+      std::ifstream in(path, std::ios::binary);
+      if (!in)
+         throw std::runtime_error("Could not open file for tar: " + path.string());
+
+      // Se emite exactamente `size` bytes (el tamaño declarado en la cabecera),
+      // aunque el archivo cambie mientras se lee
+      std::uint64_t remaining = size;
+      while (remaining > 0) {
+         std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, readBuffer_.size()));
+         in.read(readBuffer_.data(), want);
+         std::size_t got = static_cast<std::size_t>(in.gcount());
+         if (got < want) {
+            std::fill(readBuffer_.begin() + got, readBuffer_.begin() + want, 0);
+            in.clear(std::ios::eofbit);
+         }
+         emit(readBuffer_.data(), want);
+         remaining -= want;
+      }
+      pad(size);
+   }
+
+   static void putOctal(char *field, std::size_t width, std::uint64_t value) {
+      // width incluye el terminador
+      std::string digits;
+      do {
+         digits.insert(digits.begin(), static_cast<char>('0' + (value & 7)));
+         value >>= 3;
+      } while (value != 0);
+      if (digits.size() > width - 1)
+         digits = digits.substr(digits.size() - (width - 1));
+      std::memset(field, '0', width - 1);
+      std::memcpy(field + (width - 1 - digits.size()), digits.data(), digits.size());
+      field[width - 1] = '\0';
+   }
+
+   static void putString(char *field, std::size_t width, const std::string &value) {
+      std::memcpy(field, value.data(), std::min(width, value.size()));
+   }
+
+   // Registro pax: "<len> <key>=<value>\n", donde len incluye su propio texto
+   static std::string paxRecord(const std::string &key, const std::string &value) {
+      std::size_t base = key.size() + value.size() + 3;
+      std::size_t len = base + std::to_string(base).size();
+      if (std::to_string(len).size() != std::to_string(base).size()) ++len;
+      return std::to_string(len) + " " + key + "=" + value + "\n";
+   }
+
+   void writeRawHeader(const std::string &name, std::uint32_t mode, std::uint32_t uid, std::uint32_t gid,
+                       std::uint64_t size, std::int64_t mtime, char type, const std::string &linkName) {
+      char header[BLOCK];
+      std::memset(header, 0, sizeof(header));
+
+      putString(header, 100, name);
+      putOctal(header + 100, 8, mode);
+      putOctal(header + 108, 8, uid);
+      putOctal(header + 116, 8, gid);
+      putOctal(header + 124, 12, size);
+      putOctal(header + 136, 12, static_cast<std::uint64_t>(mtime < 0 ? 0 : mtime));
+      header[156] = type;
+      putString(header + 157, 100, linkName);
+      std::memcpy(header + 257, "ustar", 6);
+      std::memcpy(header + 263, "00", 2);
+
+      // checksum: suma de los bytes con el campo chksum lleno de espacios
+      std::memset(header + 148, ' ', 8);
+      unsigned int sum = 0;
+      for (unsigned char c : header) sum += c;
+      putOctal(header + 148, 7, sum);
+      header[155] = ' ';
+
+      emit(header, sizeof(header));
+   }
+
+   void writeHeader(const std::string &name, const struct stat &st, char type,
+                    std::uint64_t size, const std::string &linkName) {
+      const std::uint64_t maxOctalSize = 077777777777ULL;  // 11 digitos octales
+
+      // Rutas/enlaces largos y tamaños grandes van en una cabecera pax previa
+      std::string pax;
+      if (name.size() > 100) pax += paxRecord("path", name);
+      if (linkName.size() > 100) pax += paxRecord("linkpath", linkName);
+      if (size > maxOctalSize) pax += paxRecord("size", std::to_string(size));
+
+      if (!pax.empty()) {
+         writeRawHeader("PaxHeaders/" + name.substr(0, 80), 0644, 0, 0, pax.size(), st.st_mtime, 'x', "");
+         emit(pax.data(), pax.size());
+         pad(pax.size());
+      }
+
+      writeRawHeader(name, st.st_mode & 07777, st.st_uid, st.st_gid,
+                     size > maxOctalSize ? 0 : size, st.st_mtime, type, linkName);
+   }
+};
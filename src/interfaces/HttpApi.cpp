@@ -1,7 +1,96 @@
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <random>
 #include "HttpApi.hpp"
+#include "dto/RequestDtos.hpp"
 #include "../third_party/json.hpp"
 
+namespace {
+   // Id de peticion: el que mande el cliente en X-Request-Id (si es razonable) o <prefijo del proceso>-<contador>
+   std::string requestIdFor(const httplib::Request& req) {
+      std::string incoming = req.get_header_value("X-Request-Id");
+      bool usable = !incoming.empty() && incoming.size() <= 64 &&
+         std::all_of(incoming.begin(), incoming.end(), [](unsigned char c) {
+            return std::isalnum(c) || c == '-' || c == '_' || c == '.';
+         });
+      if (usable) return incoming;
+
+      static const std::string prefix = [] {
+         char buffer[9];
+         std::snprintf(buffer, sizeof(buffer), "%08x", static_cast<unsigned>(std::random_device{}()));
+         return std::string(buffer);
+      }();
+      static std::atomic<std::uint64_t> counter{0};
+      return prefix + "-" + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+   }
+
+   // Envolver un handler con las metricas de su ruta (conteo, clase de status, en vuelo, latencia)
+   // y con el id de peticion que llevan sus registros de log.
+   // En respuestas por streaming la latencia cubre el handler, no el envio del contenido.
+   httplib::Server::Handler instrument(MetricsRegistry &metrics, const char *method, const char *path,
+                                       httplib::Server::Handler handler) {
+      MetricsRegistry::RouteMetrics &route = metrics.route(method, path);
+      return [&route, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+         Log::RequestScope logScope(requestIdFor(req));
+         res.set_header("X-Request-Id", Log::currentRequestId());
+         MetricsRegistry::RequestScope scope(route, res.status);
+         handler(req, res);
+      };
+   }
+
+   // Decodificar el body JSON al DTO del endpoint; si no es valido responde 400 con el motivo
+   template <class Dto>
+   bool decodeBody(const httplib::Request& req, httplib::Response& res, Dto &body) {
+      try {
+         body = dto::decode<Dto>(req.body);
+         return true;
+      } catch (const dto::DecodeError &e) {
+         res.status = 400;
+         res.set_content(e.what(), "text/plain");
+         return false;
+      }
+   }
+
+   // Token de "Authorization: Bearer <token>" (vacio si no viene)
+   std::string bearerToken(const httplib::Request& req) {
+      static const std::string scheme = "Bearer ";
+      std::string header = req.get_header_value("Authorization");
+      if (header.size() <= scheme.size() || header.compare(0, scheme.size(), scheme) != 0)
+         return "";
+      return header.substr(scheme.size());
+   }
+
+   // Usuario del token de sesion; si falta, vencio o no es valido responde 401
+   std::optional<Principal> authenticate(SessionUseCase &sessionUseCase, const httplib::Request& req, httplib::Response& res) {
+      std::string token = bearerToken(req);
+      std::optional<Principal> principal;
+      if (!token.empty())
+         principal = sessionUseCase.authenticate(token);
+
+      if (!principal) {
+         res.status = 401;
+         res.set_header("WWW-Authenticate", "Bearer");
+         res.set_content("Missing, invalid or expired session token", "text/plain");
+      }
+      return principal;
+   }
+
+   httplib::Server::HandlerWithContentReader instrument(MetricsRegistry &metrics, const char *method, const char *path,
+                                                        httplib::Server::HandlerWithContentReader handler) {
+      MetricsRegistry::RouteMetrics &route = metrics.route(method, path);
+      return [&route, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res,
+                                                    const httplib::ContentReader &content_reader) {
+         Log::RequestScope logScope(requestIdFor(req));
+         res.set_header("X-Request-Id", Log::currentRequestId());
+         MetricsRegistry::RequestScope scope(route, res.status);
+         handler(req, res, content_reader);
+      };
+   }
+}
+
 HttpApi::HttpApi(const char* certPath, const char* keyPath)
    : server_(certPath, keyPath) {
    // Constructor vacío o configuración inicial si necesitas
@@ -17,18 +106,28 @@ void HttpApi::registerRoutes(
    SavePublicKeyRSAUseCase& saveKPubRSAUseCase,
    CipherRepositoryUseCase &cipherRepoUseCase,
    AddUserToRepoUseCase &addUserToRepoUseCase,
+   ExtractProtectedFileUseCase &extractProtectedFileUseCase,
+   CloneRepositoryUseCase &cloneRepoUseCase,
+   PushRepositoryUseCase &pushRepoUseCase,
+   SessionUseCase &sessionUseCase,
+   RepoAccessUseCase &repoAccessUseCase,
+   DecryptLocalProtectUseCase &decryptLocalProtectUseCase,
+   JobQueue &protectJobs,
+   DBSessionPool &dbPool,
+   ChunkStore &chunkStore,
+   MetricsRegistry &metrics,
 
    TestUseCase &testUseCase  // Caso de uso exclusivo para pruebas
 ) {
    /***********************************  ENDPOINT PARA PRUEBAS  ***********************************/
-   server_.Post("/test",
+   server_.Post("/test", instrument(metrics, "POST", "/test",
       [&testUseCase](const httplib::Request& req, httplib::Response& res) {
 
-         nlohmann::json body = nlohmann::json::parse(req.body);
-         std::string argument = body["argument"].get<std::string>();
+         TestRequest body;
+         if (!decodeBody(req, res, body)) return;
 
          // Ejecutar el caso de uso de prueba
-         bool hecho = testUseCase.execute(argument);
+         bool hecho = testUseCase.execute(body.argument);
 
          if (hecho) {
             res.status = 200; // OK
@@ -38,45 +137,91 @@ void HttpApi::registerRoutes(
             res.set_content("Test use case failed.", "text/plain");
          }
       }
-   );
+   ));
 
 
-   /***********************************   INICIAR UN NUEVO REPOSITORIO  ***********************************/
-   server_.Post("/repo/init",
-      [&createRepoUseCase](const httplib::Request& req, httplib::Response& res) {
+   /***********************************   INICIAR SESION  ***********************************/
+   // El password se verifica aqui una sola vez; el token devuelto se envia en Authorization: Bearer
+   // en el resto de endpoints y se valida en memoria hasta que vence (SESSION_TTL_SECONDS)
+   server_.Post("/auth/login", instrument(metrics, "POST", "/auth/login",
+      [&sessionUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
+            // 1. Decodificar y validar el body (campos declarados en LoginRequest)
+            LoginRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // 2. Ejecutar caso de uso
+            SessionToken session = sessionUseCase.login(body.email, body.password);
 
-            // 3. Extraer campos "repo_name" y "owner_email" y "owner_password"
-            if (!body.contains("repo_name") || !body.contains("owner_email") || !body.contains("owner_password")) {
-               res.status = 400;
-               res.set_content("Missing 'name' or 'email' field", "text/plain");
-               return;
-            }
+            // 3. Construir respuesta JSON
+            nlohmann::json responseBody;
+            responseBody["status"] = "ok";
+            responseBody["token"] = session.token;
+            responseBody["token_type"] = "Bearer";
+            responseBody["expires_in"] = session.ttlSeconds;
+            responseBody["expires_at"] = session.expiresAt;
 
-            std::string repoName  = body["repo_name"].get<std::string>();
-            std::string userEmail = body["owner_email"].get<std::string>();
-            std::string userPassword = body["owner_password"].get<std::string>();
+            res.status = 200;
+            res.set_content(responseBody.dump(), "application/json");
+            Log::info("User logged in", {{"email", body.email}});
+         }
+         catch (const IPasswordHashRepository::Busy &e) {
+            // Pool de hashing saturado: reintentar en un momento
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content(e.what(), "text/plain");
+         }
+         catch (const std::exception &e) {
+            // Credenciales invalidas o usuario inactivo / sin verificar
+            res.status = 401;
+            Log::warn("Login rejected", {{"error", e.what()}});
+            res.set_content(e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while logging in");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
 
-            // (opcional) Validaciones simples
-            if (repoName.empty() || userEmail.empty() || userPassword.empty()) {
-               res.status = 400;
-               res.set_content("Fields 'repo_name', 'owner_email' and 'owner_password' cannot be empty", "text/plain");
-               return;
-            }
 
-            // 4. Ejecutar caso de uso
-            Repository newRepo = createRepoUseCase.execute(repoName, userEmail, userPassword);
+   /***********************************   CERRAR SESION  ***********************************/
+   server_.Post("/auth/logout", instrument(metrics, "POST", "/auth/logout",
+      [&sessionUseCase](const httplib::Request& req, httplib::Response& res) {
+         // 1. Autenticar con el token de sesion
+         std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+         if (!principal) return;
 
-            // 5. Construir respuesta JSON
+         // 2. Revocar el token
+         sessionUseCase.logout(bearerToken(req));
+
+         nlohmann::json responseBody;
+         responseBody["status"] = "ok";
+         res.status = 200;
+         res.set_content(responseBody.dump(), "application/json");
+         Log::info("User logged out", {{"email", principal->email}});
+      }
+   ));
+
+
+   /***********************************   INICIAR UN NUEVO REPOSITORIO  ***********************************/
+   server_.Post("/repo/init", instrument(metrics, "POST", "/repo/init",
+      [&sessionUseCase, &createRepoUseCase](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en CreateRepoRequest)
+            CreateRepoRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            // 3. Ejecutar caso de uso
+            Repository newRepo = createRepoUseCase.execute(*principal, body.repoName);
+
+            // 4. Construir respuesta JSON
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
             responseBody["Repository_name"]   = newRepo.name;
@@ -84,576 +229,908 @@ void HttpApi::registerRoutes(
 
             res.status = 201; // Created
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "Repository created: " << newRepo.name << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("Repository created", {{"repo", newRepo.name}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error creating repository: " << e.what() << std::endl << std::endl;
+            Log::error("Error creating repository", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while creating repository." << std::endl << std::endl;
+            Log::error("Unknown error occurred while creating repository");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
    /***********************************   CLONAR UN REPOSITORIO  ***********************************/
-   server_.Get("/repo/clone", [](const httplib::Request&, httplib::Response& res) {
-      res.set_content("Repository cloned!", "text/plain");
-   });
-
-
-   /***********************************   DAR DE ALTA NUEVO USER  ***********************************/
-   server_.Post("/user/create",
-      [&createUserUseCase](const httplib::Request& req, httplib::Response& res) {
+   // GET /repo/clone?repo_name=<repo>[&repo_tag=<alias>[&snapshot=<n>]] con el token de sesion en Authorization: Bearer.
+   // Sin repo_tag se envia la carpeta de trabajo como tar.gz generado al vuelo (chunked, sin tamaño conocido);
+   // con repo_tag se envia el .tar.enc del snapshot pedido (0 = base, 1..X-Last-Snapshot = deltas) desde disco
+   // con soporte de Range para reanudar descargas; el ETag cambia con cualquier cambio de la cadena.
+   // Si ese archivo esta guardado como lista de chunks se envia reconstruido como archivo segmentado normal,
+   // para lo que hace falta la clave del alias en X-AES-Key (400 si falta).
+   // En ningun caso se arma la respuesta en res.body: la memoria por descarga queda acotada.
+   server_.Get("/repo/clone", instrument(metrics, "GET", "/repo/clone",
+      [&sessionUseCase, &cloneRepoUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Extraer parametros
+            std::string repoName = req.get_param_value("repo_name");
+            std::string repo_tag = req.has_param("repo_tag") ? req.get_param_value("repo_tag") : "";
+            if (repoName.empty()) {
                res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
+               res.set_content("Missing required fields", "text/plain");
                return;
             }
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // snapshot (solo con repo_tag): archivo de la cadena protegida, 0 = base
+            std::uint32_t snapshot = 0;
+            if (req.has_param("snapshot")) {
+               std::string value = req.get_param_value("snapshot");
+               const char *end = value.data() + value.size();
+               auto parsed = std::from_chars(value.data(), end, snapshot);
+               if (repo_tag.empty() || value.empty() || parsed.ec != std::errc() || parsed.ptr != end) {
+                  res.status = 400;
+                  res.set_content("Invalid snapshot", "text/plain");
+                  return;
+               }
+            }
 
-            // 3. Extraer campos "name", "email" y "password"
-            if (!body.contains("name") || !body.contains("email") || !body.contains("password")) {
+            // 3. Ejecutar caso de uso (autorizacion antes de enviar cabeceras)
+            std::string keyAES = repo_tag.empty() ? "" : req.get_header_value("X-AES-Key");
+            CloneRepositoryUseCase::CloneSource source = cloneRepoUseCase.execute(*principal, repoName, repo_tag, snapshot, keyAES);
+            if (source.protectedArchive && source.chunkList && source.keyAES.empty()) {
                res.status = 400;
-               res.set_content("Missing 'name', 'email' or 'password' field", "text/plain");
+               res.set_content("This snapshot is stored as chunks; send the alias key in X-AES-Key to clone it", "text/plain");
                return;
             }
 
-            std::string name     = body["name"].get<std::string>();
-            std::string email    = body["email"].get<std::string>();
-            std::string password = body["password"].get<std::string>();
+            if (source.protectedArchive) {
+               // 4a. Archivo protegido: tamaño conocido, httplib responde 206 si la peticion trae Range.
+               //     X-Last-Snapshot > 0: el cliente pide los deltas 1..N con ?snapshot= y los aplica en orden
+               std::string fileName = source.cipherFile.filename().string();
+               res.set_header("Accept-Ranges", "bytes");
+               res.set_header("ETag", source.etag);
+               res.set_header("X-Snapshot", std::to_string(source.snapshot));
+               res.set_header("X-Last-Snapshot", std::to_string(source.lastSnapshot));
+               res.set_header("Content-Disposition", "attachment; filename=\"" + fileName + "\"");
+               res.set_content_provider(source.size, "application/octet-stream",
+                  [&cloneRepoUseCase, source](size_t offset, size_t length, httplib::DataSink &sink) {
+                     try {
+                        cloneRepoUseCase.streamProtected(source, offset, length,
+                           [&sink](const char *data, std::size_t size) {
+                              if (!sink.write(data, size))
+                                 throw std::runtime_error("Client connection closed");
+                           });
+                        return true;
+                     } catch (const std::exception &e) {
+                        Log::error("Error streaming protected repository", {{"error", e.what()}});
+                        return false;
+                     }
+                  });
+               Log::info("Repository cloned", {{"file", fileName}});
+            } else {
+               // 4b. Carpeta de trabajo: tar.gz generado al vuelo, se envia por chunks
+               res.set_header("Accept-Ranges", "none");
+               res.set_header("Content-Disposition", "attachment; filename=\"" + repoName + ".tar.gz\"");
+               res.set_chunked_content_provider("application/gzip",
+                  [&cloneRepoUseCase, source](size_t, httplib::DataSink &sink) {
+                     try {
+                        cloneRepoUseCase.streamWorkingTree(source,
+                           [&sink](const char *data, std::size_t size) {
+                              if (!sink.write(data, size))
+                                 throw std::runtime_error("Client connection closed");
+                           });
+                        sink.done();
+                        return true;
+                     } catch (const std::exception &e) {
+                        Log::error("Error streaming repository", {{"error", e.what()}});
+                        return false;
+                     }
+                  });
+               Log::info("Repository cloned", {{"repo", repoName}});
+            }
+         }
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error cloning repository", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while cloning repository");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
+
 
-            // (opcional) Validaciones simples
-            if (name.empty() || email.empty() || password.empty()) {
+   /***********************************   SUBIR (PUSH) UN REPOSITORIO  ***********************************/
+   // POST /repo/push?repo_name=<repo> con el tar.gz como body y el token de sesion en Authorization: Bearer.
+   // El body se lee con ContentReader directo a un temporal (no se acumula en req.body).
+   // X-Content-SHA256 (opcional) se compara con el hash calculado al recibir.
+   server_.Post("/repo/push", instrument(metrics, "POST", "/repo/push",
+      [&sessionUseCase, &pushRepoUseCase](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader &content_reader) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Extraer parametros
+            std::string repoName = req.get_param_value("repo_name");
+            std::string sha256   = req.get_header_value("X-Content-SHA256");
+            if (repoName.empty()) {
                res.status = 400;
-               res.set_content("Fields 'name', 'email' and 'password' cannot be empty", "text/plain");
+               res.set_content("Missing required fields", "text/plain");
                return;
             }
 
-            // 4. Ejecutar caso de uso
-            bool created = createUserUseCase.execute(name, email, password);
+            // 3. Autorizar y rechazar por Content-Length antes de leer el body
+            std::uint64_t declaredSize = 0;
+            if (req.has_header("Content-Length")) {
+               std::string contentLength = req.get_header_value("Content-Length");
+               const char *end = contentLength.data() + contentLength.size();
+               auto parsed = std::from_chars(contentLength.data(), end, declaredSize);
+               if (contentLength.empty() || parsed.ec != std::errc() || parsed.ptr != end) {
+                  res.status = 400;
+                  res.set_content("Invalid Content-Length", "text/plain");
+                  return;
+               }
+            }
+            pushRepoUseCase.authorize(*principal, repoName, declaredSize);
+
+            // 4. Recibir el body por streaming; los errores del sink cortan la lectura y se relanzan aqui
+            StagedUpload upload = pushRepoUseCase.execute(repoName, sha256,
+               [&content_reader](const ByteSink &sink) {
+                  std::exception_ptr error;
+                  bool complete = content_reader([&sink, &error](const char *data, size_t size) {
+                     try {
+                        sink(data, size);
+                        return true;
+                     } catch (...) {
+                        error = std::current_exception();
+                        return false;
+                     }
+                  });
+                  if (error) std::rethrow_exception(error);
+                  if (!complete)
+                     throw std::runtime_error("Upload interrupted");
+               });
+
+            // mandar respuesta al cliente
+            nlohmann::json responseBody;
+            responseBody["status"] = "ok";
+            responseBody["repo_name"] = repoName;
+            responseBody["size"] = upload.size;
+            responseBody["sha256"] = upload.sha256;
+            res.status = 200;
+            res.set_content(responseBody.dump(), "application/json");
+            Log::info("Repository pushed", {{"repo", repoName}, {"bytes", upload.size}, {"sha256", upload.sha256}});
+         }
+         catch (const PushRepositoryUseCase::TooLarge &e) {
+            res.status = 413;
+            Log::warn("Repository push rejected", {{"error", e.what()}});
+            res.set_content(e.what(), "text/plain");
+         }
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error pushing repository", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while pushing repository");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
+
+
+   /***********************************   DAR DE ALTA NUEVO USER  ***********************************/
+   server_.Post("/user/create", instrument(metrics, "POST", "/user/create",
+      [&createUserUseCase](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Decodificar y validar el body (campos declarados en CreateUserRequest)
+            CreateUserRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            // 2. Ejecutar caso de uso
+            bool created = createUserUseCase.execute(body.name, body.email, body.password);
             
-            // 5. Construir respuesta JSON
+            // 3. Construir respuesta JSON
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["user_name"]  = name;
-            responseBody["user_email"] = email;
+            responseBody["user_name"]  = body.name;
+            responseBody["user_email"] = body.email;
 
             res.status = 201; // Created
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "User created: " << name << " with email " << email << std::endl << std::endl;
+            Log::info("User created", {{"name", body.name}, {"email", body.email}});
          }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            std::cout << "JSON parse error: " << e.what() << std::endl;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+         catch (const IPasswordHashRepository::Busy &e) {
+            // Pool de hashing saturado: reintentar en un momento
+            res.status = 503;
+            res.set_header("Retry-After", "1");
+            res.set_content(e.what(), "text/plain");
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error creating user: " << e.what() << std::endl << std::endl;
+            Log::error("Error creating user", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while creating user." << std::endl << std::endl;
+            Log::error("Unknown error occurred while creating user");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
    /***********************************   INSERTAR K_PUB ECDSA A UN USUARIO  ***********************************/
-   server_.Post("/user/add_kpub_ecdsa",
-      [&saveKPubUseCase](const httplib::Request& req, httplib::Response& res) {
+   server_.Post("/user/add_kpub_ecdsa", instrument(metrics, "POST", "/user/add_kpub_ecdsa",
+      [&sessionUseCase, &saveKPubUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
-
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
 
-            // 3. Extraer campos "email", "password" y "public_key"
-            if (!body.contains("email") || !body.contains("password") || !body.contains("kpub_ecdsa")) {
-               res.status = 400;
-               res.set_content("Missing 'email', 'password' or 'public_key_ecdsa' field", "text/plain");
-               return;
-            }
+            // 2. Decodificar y validar el body (campos declarados en SaveKPubEcdsaRequest)
+            SaveKPubEcdsaRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            std::string email    = body["email"].get<std::string>();
-            std::string password = body["password"].get<std::string>();
-            std::string publicKey = body["kpub_ecdsa"].get<std::string>();
+            // 3. Ejecutar caso de uso
+            bool keySaved = saveKPubUseCase.execute(*principal, body.kpubEcdsa);
 
-            // (opcional) Validaciones simples
-            if (email.empty() || password.empty() || publicKey.empty()) {
-               res.status = 400;
-               res.set_content("Fields 'name', 'email' and 'password' cannot be empty", "text/plain");
-               return;
-            }
-
-            // 4. Ejecutar caso de uso
-            bool keySaved = saveKPubUseCase.execute(email, publicKey, password);
-
-            // 5. Construir respuesta JSON
+            // 4. Construir respuesta JSON
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["user_email"] = email;
+            responseBody["user_email"] = principal->email;
             responseBody["key_saved"]  = keySaved;
 
             res.status = 201; // Created
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "Public key saved for user with email " << email << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("Public key saved", {{"email", principal->email}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error saving public key: " << e.what() << std::endl << std::endl;
+            Log::error("Error saving public key", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while saving public key." << std::endl << std::endl;
+            Log::error("Unknown error occurred while saving public key");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
    /***********************************   INSERTAR K_PUB RSA A UN USUARIO  ***********************************/
-   server_.Post("/user/add_kpub_rsa",
-      [&saveKPubRSAUseCase](const httplib::Request& req, httplib::Response& res) {
+   server_.Post("/user/add_kpub_rsa", instrument(metrics, "POST", "/user/add_kpub_rsa",
+      [&sessionUseCase, &saveKPubRSAUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
-
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
-
-            // 3. Extraer campos "email", "password" y "public_key"
-            if (!body.contains("email") || !body.contains("password") || !body.contains("kpub_rsa")) {
-               res.status = 400;
-               res.set_content("Missing 'email', 'password' or 'public_key_rsa' field", "text/plain");
-               return;
-            }
-
-            std::string email    = body["email"].get<std::string>();
-            std::string password = body["password"].get<std::string>();
-            std::string publicKey = body["kpub_rsa"].get<std::string>();
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
 
-            // (opcional) Validaciones simples
-            if (email.empty() || password.empty() || publicKey.empty()) {
-               res.status = 400;
-               res.set_content("Fields 'name', 'email' and 'password' cannot be empty", "text/plain");
-               return;
-            }
+            // 2. Decodificar y validar el body (campos declarados en SaveKPubRsaRequest)
+            SaveKPubRsaRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            // 4. Ejecutar caso de uso
-            bool keySaved = saveKPubRSAUseCase.execute(email, publicKey, password);
+            // 3. Ejecutar caso de uso
+            bool keySaved = saveKPubRSAUseCase.execute(*principal, body.kpubRsa);
 
-            // 5. Construir respuesta JSON
+            // 4. Construir respuesta JSON
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["user_email"] = email;
+            responseBody["user_email"] = principal->email;
             responseBody["key_saved"]  = keySaved;
 
             res.status = 201; // Created
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "RSA Public key saved for user with email " << email << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("RSA public key saved", {{"email", principal->email}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error saving RSA public key: " << e.what() << std::endl << std::endl;
+            Log::error("Error saving RSA public key", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while saving RSA public key." << std::endl << std::endl;
+            Log::error("Unknown error occurred while saving RSA public key");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
 
    /***********************************   CAMBIAR EL ROL A UN USUARIO  ***********************************/
-   server_.Post("/user/change_level",
-      [&changeLevelUserUseCase](const httplib::Request& req, httplib::Response& res) {
+   server_.Post("/user/change_level", instrument(metrics, "POST", "/user/change_level",
+      [&sessionUseCase, &changeLevelUserUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // 2. Decodificar y validar el body (campos declarados en ChangeLevelRequest)
+            ChangeLevelRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            // 3. Extraer campos necesarios
-            if (!body.contains("approver_email") || !body.contains("approver_password") || !body.contains("target_user_email") || !body.contains("new_role")) {
-               res.status = 400;
-               res.set_content("Missing required fields", "text/plain");
-               return;
-            }
-
-            std::string approverEmail    = body["approver_email"].get<std::string>();
-            std::string approverPassword = body["approver_password"].get<std::string>();
-            std::string targetUserEmail  = body["target_user_email"].get<std::string>();
-            int newRole                  = body["new_role"].get<int>();
-
-            // (opcional) Validaciones simples
-            if (approverEmail.empty() || approverPassword.empty() ||
-                targetUserEmail.empty()) {
-               res.status = 400;
-               res.set_content("Email and password fields cannot be empty", "text/plain");
-               return;
-            }
-
-            // 4. Ejecutar caso de uso
-            bool levelChanged = changeLevelUserUseCase.execute(approverEmail, approverPassword, targetUserEmail, newRole);
+            // 3. Ejecutar caso de uso
+            bool levelChanged = changeLevelUserUseCase.execute(*principal, body.targetUserEmail, body.newRole);
 
             // mandar respuesta al cliente
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["target_user_email"] = targetUserEmail;
-            responseBody["new_role"] = newRole;
+            responseBody["target_user_email"] = body.targetUserEmail;
+            responseBody["new_role"] = body.newRole;
             res.status = 200; // OK
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "User level changed for " << targetUserEmail << " to role " << newRole << std::endl << std::endl;
+            Log::info("User level changed", {{"email", body.targetUserEmail}, {"role", body.newRole}});
 
          }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
-         }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error changing user level: " << e.what() << std::endl << std::endl;
+            Log::error("Error changing user level", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while changing user level." << std::endl << std::endl;
+            Log::error("Unknown error occurred while changing user level");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
 
    /***********************************   VERIFICAR A UN USUARIO NUEVO  ***********************************/
-   server_.Post("/user/verify_email",
-      [&verifyUserUseCase](const httplib::Request& req, httplib::Response& res) {
+   server_.Post("/user/verify_email", instrument(metrics, "POST", "/user/verify_email",
+      [&sessionUseCase, &verifyUserUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
-            
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
-
-            // 3. Extraer campos necesarios
-            if (!body.contains("approver_email") || !body.contains("approver_password") || !body.contains("target_user_email")) {
-               res.status = 400;
-               res.set_content("Missing required fields", "text/plain");
-               return;
-            }
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
 
-            std::string approverEmail    = body["approver_email"].get<std::string>();
-            std::string approverPassword = body["approver_password"].get<std::string>();
-            std::string targetUserEmail  = body["target_user_email"].get<std::string>();
+            // 2. Decodificar y validar el body (campos declarados en VerifyEmailRequest)
+            VerifyEmailRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            // (opcional) Validaciones simples
-            if (approverEmail.empty() || approverPassword.empty() || targetUserEmail.empty()) {
-               res.status = 400;
-               res.set_content("Email and password fields cannot be empty", "text/plain");
-               return;
-            }
-
-            // 4. Ejecutar caso de uso
-            bool statusChanged = verifyUserUseCase.execute(approverEmail, approverPassword, targetUserEmail);
+            // 3. Ejecutar caso de uso
+            bool statusChanged = verifyUserUseCase.execute(*principal, body.targetUserEmail);
 
             // mandar respuesta al cliente
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["target_user_email"] = targetUserEmail;
+            responseBody["target_user_email"] = body.targetUserEmail;
             res.status = 200; // OK
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "Verified user email for " << targetUserEmail << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("User email verified", {{"email", body.targetUserEmail}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error changing user status: " << e.what() << std::endl << std::endl;
+            Log::error("Error changing user status", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while verifying user." << std::endl << std::endl;
+            Log::error("Unknown error occurred while verifying user");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
 
    /***********************************   CAMBIO DE STATUS A UN USUARIO  ***********************************/
-   server_.Post("/user/change_status",
-      [&changeUserStatusUseCase](const httplib::Request& req, httplib::Response& res) {
+   server_.Post("/user/change_status", instrument(metrics, "POST", "/user/change_status",
+      [&sessionUseCase, &changeUserStatusUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
-               res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
-               return;
-            }
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // 2. Decodificar y validar el body (campos declarados en ChangeStatusRequest)
+            ChangeStatusRequest body;
+            if (!decodeBody(req, res, body)) return;
 
-            // 3. Extraer campos necesarios
-            if (!body.contains("approver_email") || !body.contains("approver_password") || !body.contains("target_user_email") || !body.contains("new_status")) {
-               res.status = 400;
-               res.set_content("Missing required fields", "text/plain");
-               return;
-            }
+            // 3. Ejecutar caso de uso
+            bool statusChanged = changeUserStatusUseCase.execute(*principal, body.targetUserEmail, body.newStatus);
 
-            std::string approverEmail    = body["approver_email"].get<std::string>();
-            std::string approverPassword = body["approver_password"].get<std::string>();
-            std::string targetUserEmail  = body["target_user_email"].get<std::string>();
-            int newStatus                = body["new_status"].get<int>();
+            // mandar respuesta al cliente
+            nlohmann::json responseBody;
+            responseBody["status"] = "ok";
+            responseBody["target_user_email"] = body.targetUserEmail;
+            responseBody["new_status"] = body.newStatus;
+            res.status = 200; // OK
+            res.set_content(responseBody.dump(), "application/json");
+            Log::info("User status changed", {{"email", body.targetUserEmail}, {"status", body.newStatus}});
+         }
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error changing user status", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+      }
+   ));
 
-            // (opcional) Validaciones simples
-            if (approverEmail.empty() || approverPassword.empty() || targetUserEmail.empty()) {
-               res.status = 400;
-               res.set_content("Email and password fields cannot be empty", "text/plain");
-               return;
-            }
 
-            // 4. Ejecutar caso de uso
-            bool statusChanged = changeUserStatusUseCase.execute(approverEmail, approverPassword, targetUserEmail, newStatus);
+   /***********************************   AGREGAR UN USUARIO A UN REPOSITORIO  ***********************************/
+   server_.Post("/repo/add_user", instrument(metrics, "POST", "/repo/add_user",
+      [&sessionUseCase, &addUserToRepoUseCase](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en AddUserToRepoRequest)
+            AddUserToRepoRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            // 3. Ejecutar caso de uso
+            addUserToRepoUseCase.execute(*principal, body.projectName, body.userEmail);
 
             // mandar respuesta al cliente
             nlohmann::json responseBody;
             responseBody["status"] = "ok";
-            responseBody["target_user_email"] = targetUserEmail;
-            responseBody["new_status"] = newStatus;
+            responseBody["project_name"] = body.projectName;
+            responseBody["user_email"] = body.userEmail;
             res.status = 200; // OK
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "User status changed for " << targetUserEmail << " to status " << newStatus << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("User added to project", {{"id_user", body.userEmail}, {"id_project", body.projectName}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error changing user status: " << e.what() << std::endl << std::endl;
+            Log::error("Error adding user to project", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while adding user to project");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
       }
-   );
+   ));
 
 
-   /***********************************   AGREGAR UN USUARIO A UN REPOSITORIO  ***********************************/
-   server_.Post("/repo/add_user",
-      [&addUserToRepoUseCase](const httplib::Request& req, httplib::Response& res) {
+   /***********************************   CIFRAR UN REPOSITORIO  ***********************************/
+   // El cifrado (tar, compresion, cifrado, envoltura RSA e inserts) corre en la cola de trabajos:
+   // se responde 202 con el id del trabajo y el cliente consulta /repo/protect/status
+   server_.Post("/repo/protect", instrument(metrics, "POST", "/repo/protect",
+      [&sessionUseCase, &cipherRepoUseCase, &protectJobs](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en ProtectRepoRequest)
+            ProtectRepoRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            std::optional<WrapAlgorithm> algorithm = parseWrapAlgorithm(body.wrapAlg);
+            if (!algorithm.has_value()) {
                res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
+               res.set_content("Invalid wrap_alg: expected rsa-oaep or ecies-p256", "text/plain");
                return;
             }
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
-
-            // 3. Extraer campos necesarios
-            if (!body.contains("approverEmail") || !body.contains("approverPassword") || !body.contains("projectName") || !body.contains("userEmail")) {
+            const bool incremental = body.mode == "incremental";
+            if (!incremental && body.mode != "full") {
                res.status = 400;
-               res.set_content("Missing required fields", "text/plain");
+               res.set_content("Invalid mode: expected full or incremental", "text/plain");
                return;
             }
-
-            std::string approverEmail    = body["approverEmail"].get<std::string>();
-            std::string approverPassword = body["approverPassword"].get<std::string>();
-            std::string idProject        = body["projectName"].get<std::string>();
-            std::string idUser           = body["userEmail"].get<std::string>();
-
-            // Validacion de campos
-            if (approverEmail.empty() || approverPassword.empty() || idProject.empty() || idUser.empty()) {
+            if (incremental ? body.aesKey.empty() : body.seniorEmail.empty()) {
                res.status = 400;
-               res.set_content("Email and password fields cannot be empty", "text/plain");
+               res.set_content(incremental ? "Missing aes_key for incremental mode" : "Missing required fields", "text/plain");
                return;
             }
 
-            // 4. Ejecutar caso de uso
-            addUserToRepoUseCase.execute(approverEmail, approverPassword, idProject, idUser);
+            // 3. Encolar el caso de uso (el worker HTTP queda libre de inmediato)
+            std::optional<std::string> jobId = protectJobs.enqueue(
+               [&cipherRepoUseCase, leader = *principal, body, algorithm = *algorithm, incremental] {
+                  std::string alias = body.repoName + "_" + body.repoTag;
+                  if (incremental) {
+                     CipherRepositoryUseCase::IncrementalResult result =
+                        cipherRepoUseCase.executeIncremental(leader, body.repoName, body.repoTag, body.aesKey);
+                     Log::info("Repository delta ciphered", {{"repo", body.repoName}, {"alias", alias},
+                               {"snapshot", result.snapshot}, {"changed", result.changed}, {"deleted", result.deleted}});
+                     return result.wrappedKey;
+                  }
+
+                  std::string aes_rsa_key = cipherRepoUseCase.execute(leader, body.seniorEmail, body.repoName, body.repoTag,
+                                                                       body.allMembers, algorithm);
+                  Log::info("Repository ciphered", {{"repo", body.repoName}, {"alias", alias}});
+                  return aes_rsa_key;
+               });
+
+            if (!jobId.has_value()) {
+               res.status = 503; // cola llena
+               res.set_header("Retry-After", "30");
+               res.set_content("Too many protect jobs queued, try again later", "text/plain");
+               return;
+            }
 
             // mandar respuesta al cliente
             nlohmann::json responseBody;
-            responseBody["status"] = "ok";
-            responseBody["project_name"] = idProject;
-            responseBody["user_email"] = idUser;
-            res.status = 200; // OK
+            responseBody["status"] = "queued";
+            responseBody["job_id"] = *jobId;
+            responseBody["repo_name"] = body.repoName;
+            responseBody["wrap_alg"] = body.wrapAlg;
+            responseBody["mode"] = body.mode;
+            responseBody["status_url"] = "/repo/protect/status?job_id=" + *jobId;
+            res.status = 202; // Accepted
+            res.set_header("Location", "/repo/protect/status?job_id=" + *jobId);
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "User with ID " << idUser << " added to project with ID " << idProject << std::endl << std::endl;
-         }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+            Log::info("Repository protect queued", {{"repo", body.repoName}, {"job_id", *jobId}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error adding user to project: " << e.what() << std::endl << std::endl;
+            Log::error("Error queueing repository protect", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while adding user to project." << std::endl << std::endl;
+            Log::error("Unknown error occurred while queueing repository protect");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
-   );
+   ));
 
 
-   /***********************************   CIFRAR UN REPOSITORIO  ***********************************/
-   server_.Post("/repo/protect",
-      [&cipherRepoUseCase](const httplib::Request& req, httplib::Response& res) {
+
+   /***********************************   ESTADO DE UN CIFRADO EN COLA  ***********************************/
+   // GET /repo/protect/status?job_id=<id> → queued | running | done (con aes_rsa_key) | failed (con error).
+   // El estado de un trabajo terminado se conserva PROTECT_JOB_TTL_SECONDS
+   server_.Get("/repo/protect/status", instrument(metrics, "GET", "/repo/protect/status",
+      [&protectJobs](const httplib::Request& req, httplib::Response& res) {
+         if (!req.has_param("job_id")) {
+            res.status = 400;
+            res.set_content("Missing required fields", "text/plain");
+            return;
+         }
+
+         std::optional<JobQueue::Status> job = protectJobs.status(req.get_param_value("job_id"));
+         if (!job.has_value()) {
+            res.status = 404;
+            res.set_content("Job not found or expired", "text/plain");
+            return;
+         }
+
+         nlohmann::json responseBody;
+         responseBody["job_id"] = job->id;
+         responseBody["status"] = JobQueue::stateName(job->state);
+         if (job->state == JobQueue::State::Done) {
+            responseBody["aes_rsa_key"] = job->result;
+            responseBody["message"] = "Store this AES key encrypted with RSA safely to decrypt the repository later. You can also retrieve it from the database when needed.";
+         }
+         if (job->state == JobQueue::State::Failed)
+            responseBody["error"] = job->error;
+
+         res.status = 200;
+         res.set_content(responseBody.dump(), "application/json");
+      }
+   ));
+
+
+
+   /***********************************   DAR ACCESO A UN REPOSITORIO CIFRADO  ***********************************/
+   // Solo se envuelve la clave del repositorio para el nuevo usuario; el archivo cifrado no se toca
+   server_.Post("/repo/grant_access", instrument(metrics, "POST", "/repo/grant_access",
+      [&sessionUseCase, &repoAccessUseCase](const httplib::Request& req, httplib::Response& res) {
          try {
-            // 1. Verificar que haya body
-            if (req.body.empty()) {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en GrantAccessRequest)
+            GrantAccessRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            std::optional<WrapAlgorithm> algorithm = parseWrapAlgorithm(body.wrapAlg);
+            if (!algorithm.has_value()) {
                res.status = 400;
-               res.set_content("Request body is empty", "text/plain");
+               res.set_content("Invalid wrap_alg: expected rsa-oaep or ecies-p256", "text/plain");
                return;
             }
 
-            // 2. Parsear JSON del body
-            nlohmann::json body = nlohmann::json::parse(req.body);
+            // 3. Ejecutar caso de uso
+            std::string aes_rsa_key = repoAccessUseCase.grant(*principal, body.repoName, body.repoTag, body.aesKey, body.userEmail, *algorithm);
+
+            // mandar respuesta al cliente
+            nlohmann::json responseBody;
+            responseBody["status"] = "ok";
+            responseBody["repo_name"] = body.repoName;
+            responseBody["user_email"] = body.userEmail;
+            responseBody["aes_rsa_key"] = aes_rsa_key;
+            responseBody["wrap_alg"] = body.wrapAlg;
+            res.status = 201; // Created
+            res.set_content(responseBody.dump(), "application/json");
+            Log::info("Repository access granted", {{"alias", body.repoName + "_" + body.repoTag}, {"user", body.userEmail}});
+         }
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error granting repository access", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while granting repository access");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
+
+
 
-            // 3. Extraer campos necesarios
-            if (!body.contains("leader_email") || !body.contains("leader_password") || !body.contains("senior_email") || !body.contains("repo_name") || !body.contains("repo_tag")) {
+   /***********************************   QUITAR ACCESO A UN REPOSITORIO CIFRADO  ***********************************/
+   // Borra la clave envuelta del usuario. Con reencrypt el archivo se re-cifra con una clave nueva
+   // en la cola de trabajos y la fila se borra al activarla (202 + /repo/protect/status, cuyo resultado
+   // es la nueva clave envuelta del actor)
+   server_.Post("/repo/revoke_access", instrument(metrics, "POST", "/repo/revoke_access",
+      [&sessionUseCase, &repoAccessUseCase, &protectJobs](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en RevokeAccessRequest)
+            RevokeAccessRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            if (body.reencrypt && body.aesKey.empty()) {
                res.status = 400;
-               res.set_content("Missing required fields", "text/plain");
+               res.set_content("aes_key is required to re-encrypt the repository", "text/plain");
                return;
             }
 
-            std::string leaderEmail    = body["leader_email"].get<std::string>();
-            std::string leaderPassword = body["leader_password"].get<std::string>();
-            std::string seniorEmail    = body["senior_email"].get<std::string>();
-            std::string repoName       = body["repo_name"].get<std::string>();
-            std::string repo_tag   = body["repo_tag"].get<std::string>();
+            nlohmann::json responseBody;
+            responseBody["repo_name"] = body.repoName;
+            responseBody["user_email"] = body.userEmail;
 
-            // (opcional) Validaciones simples
-            if (leaderEmail.empty() || leaderPassword.empty() || seniorEmail.empty() || repoName.empty() || repo_tag.empty()) {
-               res.status = 400;
-               res.set_content("Email, password and repository name fields cannot be empty", "text/plain");
+            // 3. Sin re-cifrado: quitar la fila ahora
+            if (!body.reencrypt) {
+               repoAccessUseCase.revoke(*principal, body.repoName, body.repoTag, body.userEmail);
+               Log::info("Repository access revoked", {{"alias", body.repoName + "_" + body.repoTag}, {"user", body.userEmail}});
+
+               responseBody["status"] = "ok";
+               res.status = 200; // OK
+               res.set_content(responseBody.dump(), "application/json");
                return;
             }
 
-            // 4. Ejecutar caso de uso
-            std::string aes_rsa_key = cipherRepoUseCase.execute(leaderEmail, leaderPassword, seniorEmail, repoName, repo_tag);
+            // 4. Con re-cifrado: verificar (incluida la clave) y encolar; la fila se quita dentro del trabajo,
+            //    en la misma transaccion que activa la clave nueva. Con la cola llena o si el trabajo falla no
+            //    cambia nada y la misma solicitud se puede repetir
+            repoAccessUseCase.checkRevokeAndReencrypt(*principal, body.repoName, body.repoTag, body.userEmail, body.aesKey);
+            std::optional<std::string> jobId = protectJobs.enqueue(
+               [&repoAccessUseCase, actor = *principal, body] {
+                  std::string aes_rsa_key = repoAccessUseCase.revokeAndReencrypt(actor, body.repoName, body.repoTag,
+                                                                                 body.userEmail, body.aesKey);
+                  Log::info("Repository access revoked and re-encrypted",
+                            {{"alias", body.repoName + "_" + body.repoTag}, {"user", body.userEmail}});
+                  return aes_rsa_key;
+               });
+
+            if (!jobId.has_value()) {
+               res.status = 503; // cola llena
+               res.set_header("Retry-After", "30");
+               res.set_content("Too many jobs are queued; access was not revoked, try again later", "text/plain");
+               return;
+            }
 
-            // mandar respuesta al cliente
-            nlohmann::json responseBody;
-            responseBody["status"] = "ok";
-            responseBody["repo_name"] = repoName;
-            responseBody["aes_rsa_key"] = aes_rsa_key;
-            responseBody["message"] = "Store this AES key encrypted with RSA safely to decrypt the repository later. You can also retrieve it from the database when needed.";
-            res.status = 200; // OK
+            responseBody["status"] = "queued";
+            responseBody["job_id"] = *jobId;
+            responseBody["status_url"] = "/repo/protect/status?job_id=" + *jobId;
+            res.status = 202; // Accepted
+            res.set_header("Location", "/repo/protect/status?job_id=" + *jobId);
             res.set_content(responseBody.dump(), "application/json");
-            std::cout << "Repository ciphered: " << repoName << " with alias " << repoName + "_" + repo_tag << std::endl << std::endl;
+            Log::info("Repository re-encrypt queued", {{"repo", body.repoName}, {"job_id", *jobId}});
          }
-         catch (const nlohmann::json::parse_error &e) {
-            // Error al parsear JSON
-            res.status = 400;
-            res.set_content(std::string("Invalid JSON: ") + e.what(), "text/plain");
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error revoking repository access", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while revoking repository access");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
+
+
+
+   /***********************************   EXTRAER UN ARCHIVO DE UN REPOSITORIO CIFRADO  ***********************************/
+   // Solo se descifran los segmentos que cubren al archivo; la respuesta se envia por chunks
+   server_.Post("/repo/protected_file", instrument(metrics, "POST", "/repo/protected_file",
+      [&sessionUseCase, &extractProtectedFileUseCase](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en ProtectedFileRequest)
+            ProtectedFileRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            // 3. Ejecutar caso de uso (autorizacion y ubicacion del archivo, antes de enviar cabeceras)
+            ExtractProtectedFileUseCase::Extraction extraction =
+               extractProtectedFileUseCase.execute(*principal, body.repoName, body.repoTag, body.aesKey, body.path);
+
+            // 4. Enviar el archivo descifrado conforme se descomprime
+            res.status = 200;
+            res.set_header("X-File-Size", std::to_string(extraction.member.size));
+            res.set_chunked_content_provider("application/octet-stream",
+               [&extractProtectedFileUseCase, extraction, aesKey = body.aesKey](size_t, httplib::DataSink &sink) {
+                  try {
+                     extractProtectedFileUseCase.stream(extraction, aesKey,
+                        [&sink](const char *data, std::size_t size) {
+                           if (!sink.write(data, size))
+                              throw std::runtime_error("Client connection closed");
+                        });
+                     sink.done();
+                     return true;
+                  } catch (const std::exception &e) {
+                     // las cabeceras ya se enviaron: solo queda cortar la conexion
+                     Log::error("Error streaming protected file", {{"error", e.what()}});
+                     return false;
+                  }
+               });
+            Log::info("Protected file extracted", {{"path", body.path}, {"alias", body.repoName + "_" + body.repoTag}});
          }
          catch (const std::exception &e) {
             // Error de negocio u otro tipo
             res.status = 500;
-            std::cout << "Error ciphering repository: " << e.what() << std::endl << std::endl;
+            Log::error("Error extracting protected file", {{"error", e.what()}});
             res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
          }
          catch (...) {
             // Capturar cualquier otro tipo de excepción
             res.status = 500;
-            std::cout << "Unknown error occurred while ciphering repository." << std::endl << std::endl;
+            Log::error("Unknown error occurred while extracting protected file");
             res.set_content("Internal error: Unknown error occurred", "text/plain");
          }
       }
+   ));
+
+
+
+   /***********************************   ESTADISTICAS DEL POOL DE LA BDD  ***********************************/
+   server_.Get("/stats/db_pool", instrument(metrics, "GET", "/stats/db_pool",
+      [&dbPool](const httplib::Request&, httplib::Response& res) {
+         DBSessionPool::Stats stats = dbPool.stats();
+
+         // utilizacion y espera promedio para dimensionar el pool contra los workers HTTP
+         nlohmann::json responseBody;
+         responseBody["size"]          = stats.size;
+         responseBody["in_use"]        = stats.inUse;
+         responseBody["peak_in_use"]   = stats.peakInUse;
+         responseBody["utilization"]   = stats.size ? static_cast<double>(stats.inUse) / stats.size : 0.0;
+         responseBody["leases"]        = stats.leases;
+         responseBody["timeouts"]      = stats.timeouts;
+         responseBody["wait_total_ms"] = stats.waitTotalMs;
+         responseBody["wait_avg_ms"]   = stats.leases ? stats.waitTotalMs / stats.leases : 0.0;
+         responseBody["wait_max_ms"]   = stats.waitMaxMs;
+
+         res.status = 200;
+         res.set_content(responseBody.dump(), "application/json");
+      }
+   ));
+
+
+   /***********************************   ESTADISTICAS DEL ALMACEN DE CHUNKS  ***********************************/
+   server_.Get("/stats/chunk_store", instrument(metrics, "GET", "/stats/chunk_store",
+      [&chunkStore](const httplib::Request&, httplib::Response& res) {
+         ChunkStore::Stats stats = chunkStore.stats();
+
+         // totales del almacen y, desde el arranque, cuanto de lo recibido ya estaba guardado
+         nlohmann::json responseBody;
+         responseBody["enabled"]             = chunkStore.enabled();
+         responseBody["chunks"]              = stats.storedChunks;
+         responseBody["bytes"]               = stats.storedBytes;
+         responseBody["chunks_written"]      = stats.chunksWritten;
+         responseBody["chunks_deduplicated"] = stats.chunksDeduplicated;
+         responseBody["logical_bytes"]       = stats.logicalBytes;
+         responseBody["written_bytes"]       = stats.writtenBytes;
+         responseBody["dedup_ratio"]         = stats.dedupRatio;
+
+         res.status = 200;
+         res.set_content(responseBody.dump(), "application/json");
+      }
+   ));
+
+
+
+   /***********************************   METRICAS (PROMETHEUS)  ***********************************/
+   server_.Get("/metrics",
+      [&metrics](const httplib::Request&, httplib::Response& res) {
+         res.status = 200;
+         res.set_content(metrics.renderPrometheus(), "text/plain; version=0.0.4");
+      }
    );
 
 
 
    /***********************************   DESCIFRAR UN REPOSITORIO  ***********************************/
-   
-   // chance este pase a ser un get con query params porque le enviaremos el tar cifrado
-   server_.Post("/repo/dec_local_protect", [](const httplib::Request&, httplib::Response& res) {
-      res.set_content("Repository deciphered!", "text/plain");
-   });
+   // Descifrado, gunzip y extraccion en proceso; la carpeta <repo>_<alias> aparece completa o no aparece
+   server_.Post("/repo/dec_local_protect", instrument(metrics, "POST", "/repo/dec_local_protect",
+      [&sessionUseCase, &decryptLocalProtectUseCase](const httplib::Request& req, httplib::Response& res) {
+         try {
+            // 1. Autenticar con el token de sesion (sin consultas a la BDD)
+            std::optional<Principal> principal = authenticate(sessionUseCase, req, res);
+            if (!principal) return;
+
+            // 2. Decodificar y validar el body (campos declarados en DecryptLocalProtectRequest)
+            DecryptLocalProtectRequest body;
+            if (!decodeBody(req, res, body)) return;
+
+            // 3. Ejecutar caso de uso
+            std::string folder = decryptLocalProtectUseCase.execute(*principal, body.repoName, body.repoTag, body.aesKey);
+
+            // 4. Respuesta
+            nlohmann::json responseBody;
+            responseBody["status"]    = "Repository deciphered";
+            responseBody["repo_name"] = body.repoName;
+            responseBody["folder"]    = folder;
+
+            res.status = 200;
+            res.set_content(responseBody.dump(), "application/json");
+            Log::info("Protected repository deciphered", {{"folder", folder}});
+         }
+         catch (const std::exception &e) {
+            // Error de negocio u otro tipo
+            res.status = 500;
+            Log::error("Error deciphering protected repository", {{"error", e.what()}});
+            res.set_content(std::string("Internal error: ") + e.what(), "text/plain");
+         }
+         catch (...) {
+            // Capturar cualquier otro tipo de excepción
+            res.status = 500;
+            Log::error("Unknown error occurred while deciphering protected repository");
+            res.set_content("Internal error: Unknown error occurred", "text/plain");
+         }
+      }
+   ));
 
 }
 
 void HttpApi::listen(const char* host, int port) {
-   std::cout << "Intentando iniciar servidor HTTPS en https://" << host << ":" << port << std::endl;
-   std::cout << "Ahoa con json y msql!" << std::endl;
+   Log::info("Intentando iniciar servidor HTTPS", {{"url", "https://" + std::string(host) + ":" + std::to_string(port)}});
    
    // Verificar que los archivos de certificado y clave existen
 
@@ -661,11 +1138,10 @@ void HttpApi::listen(const char* host, int port) {
    bool success = server_.listen(host, port);
    
    if (!success) {
-      std::cerr << "Error: No se pudo iniciar el servidor en " << host << ":" << port << std::endl;
-      std::cerr << "Posibles causas:" << std::endl;
-      std::cerr << "  - Puerto ya en uso" << std::endl;
-      std::cerr << "  - Certificados inválidos o no encontrados" << std::endl;
-      std::cerr << "  - Permisos insuficientes" << std::endl;
+      Log::error("No se pudo iniciar el servidor", {
+         {"host", host}, {"port", port},
+         {"posibles_causas", {"Puerto ya en uso", "Certificados inválidos o no encontrados", "Permisos insuficientes"}}
+      });
       throw std::runtime_error("Failed to start server");
    }
 }
\ No newline at end of file
@@ -12,6 +12,27 @@
 #include "../application/SavePublicKeyRSAUseCase.hpp"
 #include "../application/CipherRepositoryUseCase.hpp"
 #include "../application/AddUserToRepoUseCase.hpp"
+#include "../application/ExtractProtectedFileUseCase.hpp"
+#include "../application/DecryptLocalProtectUseCase.hpp"
+#include "../application/CloneRepositoryUseCase.hpp"
+#include "../application/PushRepositoryUseCase.hpp"
+#include "../application/SessionUseCase.hpp"
+#include "../application/RepoAccessUseCase.hpp"
+
+// estadisticas del pool de sesiones de la BDD
+#include "../infrastructure/database/DBSessionPool.hpp"
+
+// estadisticas del almacen deduplicado de chunks
+#include "../infrastructure/crypto/ChunkStore.hpp"
+
+// logger asincrono (JSON lines) con id de peticion
+#include "../infrastructure/logging/Log.hpp"
+
+// metricas por ruta y por etapa (Prometheus)
+#include "../infrastructure/metrics/MetricsRegistry.hpp"
+
+// cola de trabajos en segundo plano (cifrado de repositorios)
+#include "../infrastructure/concurrency/JobQueue.hpp"
 
 /////////  caso de uso exclusivo para pruebas  //////////////////////
 #include "../application/testUseCase.hpp"
@@ -32,6 +53,16 @@ public:
       SavePublicKeyRSAUseCase &saveKPubRSAUseCase,
       CipherRepositoryUseCase &cipherRepoUseCase,
       AddUserToRepoUseCase &addUserToRepoUseCase,
+      ExtractProtectedFileUseCase &extractProtectedFileUseCase,
+      CloneRepositoryUseCase &cloneRepoUseCase,
+      PushRepositoryUseCase &pushRepoUseCase,
+      SessionUseCase &sessionUseCase,
+      RepoAccessUseCase &repoAccessUseCase,
+      DecryptLocalProtectUseCase &decryptLocalProtectUseCase,
+      JobQueue &protectJobs,
+      DBSessionPool &dbPool,
+      ChunkStore &chunkStore,
+      MetricsRegistry &metrics,
 
 
       TestUseCase &testUseCase  // Caso de uso exclusivo para pruebas
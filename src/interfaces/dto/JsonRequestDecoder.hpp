@@ -0,0 +1,272 @@
+// interfaces/dto/JsonRequestDecoder.hpp
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "../../third_party/json.hpp"
+
+// Decodificacion de bodies JSON a DTOs en una sola pasada SAX (nlohmann::json::sax_parse), sin DOM.
+// Cada DTO declara sus campos con dto::field(...) en un static fields(); de esa lista salen
+// la busqueda por nombre, la conversion de tipos y la validacion de faltantes/vacios.
+//
+//    struct ChangeLevelRequest {
+//       std::string approverEmail;
+//       int newRole = 0;
+//       static auto fields() {
+//          return std::make_tuple(dto::field("approver_email", &ChangeLevelRequest::approverEmail),
+//                                 dto::field("new_role", &ChangeLevelRequest::newRole));
+//       }
+//    };
+//
+// Los campos declarados con dto::field son obligatorios; los strings ademas no pueden ser vacios
+// salvo que se declaren con allowEmpty. Los declarados con dto::optionalField pueden faltar
+// (el miembro conserva su valor inicial). Las claves desconocidas se ignoran.
+namespace dto {
+
+   // Body invalido: la API responde 400 con el mensaje
+   class DecodeError : public std::runtime_error {
+   public:
+      using std::runtime_error::runtime_error;
+   };
+
+   template <class Dto, class Member>
+   struct Field {
+      const char *name;
+      Member Dto::*member;
+      bool allowEmpty;
+      bool required;
+   };
+
+   template <class Dto, class Member>
+   Field<Dto, Member> field(const char *name, Member Dto::*member, bool allowEmpty = false) {
+      static_assert(std::is_same<Member, std::string>::value || std::is_same<Member, int>::value ||
+                    std::is_same<Member, std::int64_t>::value || std::is_same<Member, bool>::value,
+                    "Unsupported DTO field type");
+      return Field<Dto, Member>{name, member, allowEmpty, true};
+   }
+
+   // Campo que puede faltar en el body; si llega se valida igual que uno obligatorio
+   template <class Dto, class Member>
+   Field<Dto, Member> optionalField(const char *name, Member Dto::*member, bool allowEmpty = false) {
+      Field<Dto, Member> declared = field(name, member, allowEmpty);
+      declared.required = false;
+      return declared;
+   }
+
+   namespace detail {
+
+      // Aplica f(field, index) a cada campo de la tupla
+      template <class Tuple, class F, std::size_t... I>
+      void forEachField(Tuple &fields, F &&f, std::index_sequence<I...>) {
+         (f(std::get<I>(fields), I), ...);
+      }
+
+      template <class Tuple, class F>
+      void forEachField(Tuple &fields, F &&f) {
+         forEachField(fields, std::forward<F>(f), std::make_index_sequence<std::tuple_size<Tuple>::value>{});
+      }
+
+      // Handler SAX: solo mira las claves del objeto raiz; valores anidados se saltan
+      template <class Dto>
+      class SaxDecoder {
+      public:
+         using json = nlohmann::json;
+         using Fields = decltype(Dto::fields());
+         static constexpr std::size_t FIELD_COUNT = std::tuple_size<Fields>::value;
+
+         explicit SaxDecoder(Dto &dto) : dto_(dto), fields_(Dto::fields()) {}
+
+         bool null() { return scalar("null"); }
+
+         bool boolean(bool value) {
+            if (depth_ != 1) return skipValue();
+            return assign([&](auto &member) -> bool {
+               using Member = std::decay_t<decltype(member)>;
+               if constexpr (std::is_same<Member, bool>::value) { member = value; return true; }
+               else return false;
+            }, "a boolean");
+         }
+
+         bool number_integer(json::number_integer_t value) { return integer(static_cast<long double>(value), value); }
+         bool number_unsigned(json::number_unsigned_t value) { return integer(static_cast<long double>(value), value); }
+         bool number_float(json::number_float_t, const json::string_t &) { return scalar("a number with decimals"); }
+
+         bool string(json::string_t &value) {
+            if (depth_ != 1) return skipValue();
+            return assign([&](auto &member) -> bool {
+               using Member = std::decay_t<decltype(member)>;
+               if constexpr (std::is_same<Member, std::string>::value) { member = std::move(value); return true; }
+               else return false;
+            }, "a string");
+         }
+
+         bool binary(json::binary_t &) { return scalar("binary"); }
+
+         bool start_object(std::size_t) {
+            if (depth_ == 0) {
+               depth_ = 1;
+               return true;
+            }
+            if (depth_ == 1 && !nested("an object")) return false;
+            ++depth_;
+            return true;
+         }
+
+         bool key(json::string_t &name) {
+            if (depth_ == 1) current_ = indexOf(name);
+            return true;
+         }
+
+         bool end_object() {
+            --depth_;
+            return true;
+         }
+
+         bool start_array(std::size_t) {
+            if (depth_ == 0) return fail("Request body must be a JSON object");
+            if (depth_ == 1 && !nested("an array")) return false;
+            ++depth_;
+            return true;
+         }
+
+         bool end_array() {
+            --depth_;
+            return true;
+         }
+
+         bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &e) {
+            return fail(std::string("Invalid JSON: ") + e.what());
+         }
+
+         const std::string &error() const { return error_; }
+
+         // Despues de parsear: faltantes y vacios, en el orden de declaracion
+         void validate() const {
+            std::string missing, empty;
+            forEachField(fields_, [&](const auto &field, std::size_t index) {
+               if (!seen_[index]) {
+                  if (field.required) missing += (missing.empty() ? "" : ", ") + std::string(field.name);
+                  return;
+               }
+               using Member = std::decay_t<decltype(dto_.*(field.member))>;
+               if constexpr (std::is_same<Member, std::string>::value) {
+                  if (!field.allowEmpty && (dto_.*(field.member)).empty())
+                     empty += (empty.empty() ? "" : ", ") + std::string(field.name);
+               }
+            });
+            if (!missing.empty()) throw DecodeError("Missing required fields: " + missing);
+            if (!empty.empty()) throw DecodeError("Fields cannot be empty: " + empty);
+         }
+
+      private:
+         static constexpr std::size_t NONE = static_cast<std::size_t>(-1);
+
+         Dto &dto_;
+         Fields fields_;
+         std::array<bool, FIELD_COUNT> seen_{};
+         std::size_t depth_ = 0;
+         std::size_t current_ = NONE;
+         std::string error_;
+
+         // Valor fuera del objeto raiz: anidado (se ignora) o el body no es un objeto
+         bool skipValue() {
+            return depth_ > 1 || fail("Request body must be a JSON object");
+         }
+
+         bool fail(std::string message) {
+            if (error_.empty()) error_ = std::move(message);
+            return false;
+         }
+
+         std::size_t indexOf(const std::string &name) {
+            std::size_t found = NONE;
+            forEachField(fields_, [&](const auto &field, std::size_t index) {
+               if (found == NONE && name == field.name) found = index;
+            });
+            return found;
+         }
+
+         // Asigna al campo actual si el setter acepta el tipo; si no, error de tipo
+         template <class Setter>
+         bool assign(Setter &&setter, const char *received) {
+            if (depth_ == 0) return fail("Request body must be a JSON object");
+            if (current_ == NONE) return true;   // clave desconocida
+
+            bool ok = true;
+            const char *expected = "";
+            forEachField(fields_, [&](const auto &field, std::size_t index) {
+               if (index != current_) return;
+               ok = setter(dto_.*(field.member));
+               expected = typeName(dto_.*(field.member));
+               if (ok) seen_[index] = true;
+            });
+            if (!ok)
+               return fail(std::string("Field '") + fieldName(current_) + "' must be " + expected + ", got " + received);
+            return true;
+         }
+
+         template <class T>
+         bool integer(long double asFloat, T value) {
+            if (depth_ != 1) return skipValue();
+            bool inRange = true;
+            bool ok = assign([&](auto &member) -> bool {
+               using Member = std::decay_t<decltype(member)>;
+               if constexpr (std::is_same<Member, int>::value || std::is_same<Member, std::int64_t>::value) {
+                  inRange = asFloat >= static_cast<long double>(std::numeric_limits<Member>::min()) &&
+                            asFloat <= static_cast<long double>(std::numeric_limits<Member>::max());
+                  if (inRange) member = static_cast<Member>(value);
+                  return true;
+               }
+               else return false;
+            }, "an integer");
+            if (ok && !inRange)
+               return fail(std::string("Field '") + fieldName(current_) + "' is out of range");
+            return ok;
+         }
+
+         bool scalar(const char *received) {
+            if (depth_ != 1) return skipValue();
+            return assign([](auto &) { return false; }, received);
+         }
+
+         bool nested(const char *received) {
+            if (current_ == NONE) return true;
+            return assign([](auto &) { return false; }, received);
+         }
+
+         std::string fieldName(std::size_t wanted) {
+            std::string name;
+            forEachField(fields_, [&](const auto &field, std::size_t index) {
+               if (index == wanted) name = field.name;
+            });
+            return name;
+         }
+
+         static const char *typeName(const std::string &) { return "a string"; }
+         static const char *typeName(int) { return "an integer"; }
+         static const char *typeName(std::int64_t) { return "an integer"; }
+         static const char *typeName(bool) { return "a boolean"; }
+      };
+   }
+
+   // Decodifica y valida el body; lanza DecodeError con un mensaje apto para el cliente
+   template <class Dto>
+   Dto decode(const std::string &body) {
+      if (body.empty())
+         throw DecodeError("Request body is empty");
+
+      Dto dto{};
+      detail::SaxDecoder<Dto> decoder(dto);
+      if (!nlohmann::json::sax_parse(body, &decoder))
+         throw DecodeError(decoder.error().empty() ? "Invalid JSON" : decoder.error());
+
+      decoder.validate();
+      return dto;
+   }
+}
@@ -0,0 +1,199 @@
+// interfaces/dto/RequestDtos.hpp
+#pragma once
+#include <string>
+#include <tuple>
+#include "JsonRequestDecoder.hpp"
+
+// Bodies JSON de la API, uno por endpoint. Los nombres entre comillas son las claves del JSON;
+// los campos son obligatorios salvo los declarados con optionalField, y los strings no pueden llegar vacios.
+// Salvo /auth/login y /user/create, el usuario se identifica con el token de sesion (Authorization: Bearer),
+// no con email + password en el body.
+
+// POST /test
+struct TestRequest {
+   std::string argument;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("argument", &TestRequest::argument, true));
+   }
+};
+
+// POST /repo/init
+struct CreateRepoRequest {
+   std::string repoName;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("repo_name", &CreateRepoRequest::repoName));
+   }
+};
+
+// POST /auth/login
+struct LoginRequest {
+   std::string email;
+   std::string password;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("email", &LoginRequest::email),
+                             dto::field("password", &LoginRequest::password));
+   }
+};
+
+// POST /user/create
+struct CreateUserRequest {
+   std::string name;
+   std::string email;
+   std::string password;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("name", &CreateUserRequest::name),
+                             dto::field("email", &CreateUserRequest::email),
+                             dto::field("password", &CreateUserRequest::password));
+   }
+};
+
+// POST /user/add_kpub_ecdsa
+struct SaveKPubEcdsaRequest {
+   std::string kpubEcdsa;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("kpub_ecdsa", &SaveKPubEcdsaRequest::kpubEcdsa));
+   }
+};
+
+// POST /user/add_kpub_rsa
+struct SaveKPubRsaRequest {
+   std::string kpubRsa;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("kpub_rsa", &SaveKPubRsaRequest::kpubRsa));
+   }
+};
+
+// POST /user/change_level
+struct ChangeLevelRequest {
+   std::string targetUserEmail;
+   int newRole = 0;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("target_user_email", &ChangeLevelRequest::targetUserEmail),
+                             dto::field("new_role", &ChangeLevelRequest::newRole));
+   }
+};
+
+// POST /user/verify_email
+struct VerifyEmailRequest {
+   std::string targetUserEmail;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("target_user_email", &VerifyEmailRequest::targetUserEmail));
+   }
+};
+
+// POST /user/change_status
+struct ChangeStatusRequest {
+   std::string targetUserEmail;
+   int newStatus = 0;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("target_user_email", &ChangeStatusRequest::targetUserEmail),
+                             dto::field("new_status", &ChangeStatusRequest::newStatus));
+   }
+};
+
+// POST /repo/add_user (claves en camelCase por compatibilidad con los clientes existentes)
+struct AddUserToRepoRequest {
+   std::string projectName;
+   std::string userEmail;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("projectName", &AddUserToRepoRequest::projectName),
+                             dto::field("userEmail", &AddUserToRepoRequest::userEmail));
+   }
+};
+
+// POST /repo/protect (all_members opcional: envolver la clave tambien para todos los miembros del proyecto;
+// wrap_alg opcional: "rsa-oaep" (kpubrsa, por defecto) o "ecies-p256" (kpubecdsa);
+// mode opcional: "full" (por defecto, requiere senior_email) o "incremental" (delta sobre un alias ya
+// protegido, requiere aes_key: la clave del alias ya desenvuelta por el líder))
+struct ProtectRepoRequest {
+   std::string seniorEmail;
+   std::string repoName;
+   std::string repoTag;
+   bool allMembers = false;
+   std::string wrapAlg = "rsa-oaep";
+   std::string mode = "full";
+   std::string aesKey;
+
+   static auto fields() {
+      return std::make_tuple(dto::optionalField("senior_email", &ProtectRepoRequest::seniorEmail),
+                             dto::field("repo_name", &ProtectRepoRequest::repoName),
+                             dto::field("repo_tag", &ProtectRepoRequest::repoTag),
+                             dto::optionalField("all_members", &ProtectRepoRequest::allMembers),
+                             dto::optionalField("wrap_alg", &ProtectRepoRequest::wrapAlg),
+                             dto::optionalField("mode", &ProtectRepoRequest::mode),
+                             dto::optionalField("aes_key", &ProtectRepoRequest::aesKey));
+   }
+};
+
+// POST /repo/protected_file
+struct ProtectedFileRequest {
+   std::string repoName;
+   std::string repoTag;
+   std::string aesKey;
+   std::string path;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("repo_name", &ProtectedFileRequest::repoName),
+                             dto::field("repo_tag", &ProtectedFileRequest::repoTag),
+                             dto::field("aes_key", &ProtectedFileRequest::aesKey),
+                             dto::field("path", &ProtectedFileRequest::path));
+   }
+};
+
+// POST /repo/dec_local_protect (aes_key: la clave del repositorio ya desenvuelta por el cliente)
+struct DecryptLocalProtectRequest {
+   std::string repoName;
+   std::string repoTag;
+   std::string aesKey;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("repo_name", &DecryptLocalProtectRequest::repoName),
+                             dto::field("repo_tag", &DecryptLocalProtectRequest::repoTag),
+                             dto::field("aes_key", &DecryptLocalProtectRequest::aesKey));
+   }
+};
+
+// POST /repo/grant_access (aes_key: la clave del repositorio ya desenvuelta por quien da el acceso;
+// wrap_alg opcional como en /repo/protect)
+struct GrantAccessRequest {
+   std::string repoName;
+   std::string repoTag;
+   std::string aesKey;
+   std::string userEmail;
+   std::string wrapAlg = "rsa-oaep";
+
+   static auto fields() {
+      return std::make_tuple(dto::field("repo_name", &GrantAccessRequest::repoName),
+                             dto::field("repo_tag", &GrantAccessRequest::repoTag),
+                             dto::field("aes_key", &GrantAccessRequest::aesKey),
+                             dto::field("user_email", &GrantAccessRequest::userEmail),
+                             dto::optionalField("wrap_alg", &GrantAccessRequest::wrapAlg));
+   }
+};
+
+// POST /repo/revoke_access (reencrypt opcional: cambiar la clave del archivo en segundo plano, requiere aes_key)
+struct RevokeAccessRequest {
+   std::string repoName;
+   std::string repoTag;
+   std::string userEmail;
+   bool reencrypt = false;
+   std::string aesKey;
+
+   static auto fields() {
+      return std::make_tuple(dto::field("repo_name", &RevokeAccessRequest::repoName),
+                             dto::field("repo_tag", &RevokeAccessRequest::repoTag),
+                             dto::field("user_email", &RevokeAccessRequest::userEmail),
+                             dto::optionalField("reencrypt", &RevokeAccessRequest::reencrypt),
+                             dto::optionalField("aes_key", &RevokeAccessRequest::aesKey, true));
+   }
+};
@@ -1,6 +1,9 @@
-// g++ src/main.cpp src/infrastructure/config/ConfigEnv.cpp src/interfaces/HttpApi.cpp -I../third_party -I/usr/include/mysql -o main -lssl -lcrypto -lsoci_core -lsoci_mysql -lmariadb
+// g++ src/main.cpp src/infrastructure/config/ConfigEnv.cpp src/interfaces/HttpApi.cpp -I../third_party -I/usr/include/mysql -o main -lssl -lcrypto -lsoci_core -lsoci_mysql -lmariadb -lz -pthread
 
 #include <iostream>
+#include <algorithm>
+#include <thread>
+#include <chrono>
 #include "infrastructure/config/ConfigEnv.hpp"
 #include "interfaces/HttpApi.hpp"
 
@@ -8,10 +11,22 @@
 #include <soci/mysql/soci-mysql.h>
 
 // Repositorios
+#include "infrastructure/database/DBSessionPool.hpp"
 #include "infrastructure/database/DBUserRepository.hpp"
 #include "infrastructure/storage/FilesystemStorage.hpp"
 #include "infrastructure/database/DBProjectRepository.hpp"
 #include "infrastructure/crypto/ProtectRepo.hpp"
+#include "infrastructure/crypto/CipherSuite.hpp"
+#include "infrastructure/crypto/ChunkStore.hpp"
+#include "infrastructure/concurrency/ThreadPool.hpp"
+#include "infrastructure/concurrency/JobQueue.hpp"
+#include "infrastructure/metrics/MetricsRegistry.hpp"
+#include "infrastructure/logging/AsyncLogger.hpp"
+#include "infrastructure/logging/Log.hpp"
+#include "infrastructure/auth/SessionTokenStore.hpp"
+#include "infrastructure/crypto/PasswordHasher.hpp"
+#include "infrastructure/crypto/SecureRandom.hpp"
+#include "domain/utils/AliasLocks.hpp"
 
 // Casos de uso
 #include "application/CreateRepositoryUseCase.hpp"
@@ -23,6 +38,12 @@
 #include "application/SavePublicKeyRSAUseCase.hpp"
 #include "application/CipherRepositoryUseCase.hpp"
 #include "application/AddUserToRepoUseCase.hpp"
+#include "application/ExtractProtectedFileUseCase.hpp"
+#include "application/DecryptLocalProtectUseCase.hpp"
+#include "application/CloneRepositoryUseCase.hpp"
+#include "application/PushRepositoryUseCase.hpp"
+#include "application/SessionUseCase.hpp"
+#include "application/RepoAccessUseCase.hpp"
 
 //////////////// Caso de uso exclusivo para pruebas ////////////////////////
 #include "application/testUseCase.hpp"
@@ -33,31 +54,95 @@ int main() {
       // 1. Cargar variables de entorno desde .env
       ConfigEnv configEnvs = loadConfigFromEnv();
 
-      // 2. Crear sesion SOCI (conexion a la BDD MySQL/MariaDB)
+      // Logger asincrono (JSON lines a stdout); se instala como destino de Log::info/error...
+      AsyncLogger logger{AsyncLogger::parseLevel(configEnvs.logLevel), configEnvs.logRingSize,
+                         AsyncLogger::parseOverflow(configEnvs.logOverflow)};
+      Log::Installation logInstallation{logger};
+
+      // 2. Crear pool de sesiones SOCI (conexiones a la BDD MySQL/MariaDB)
       std::string connStr =
          "db=" + configEnvs.dbName +
          " user=" + configEnvs.dbUser +
          " password=" + configEnvs.dbPassword +
          " host=" + configEnvs.dbHost;
 
-      soci::session sql(soci::mysql, connStr);
+      DBSessionPool dbPool(connStr, configEnvs.dbPoolSize, configEnvs.dbPoolTimeoutMs);
 
       // 3. Infraestructura para repositorios
-      FilesystemStorage repoStore{configEnvs.repositoriesRoot, configEnvs.repositoriesCipher};
-      DBUserRepository userRepo{sql};
-      DBProjectRepository projectRepo{sql};
-      ProtectRepoCrypto repoCrypto{};
-
-      // 4. Casos de uso (aplicacion)
+      std::size_t compressThreads = configEnvs.compressThreads > 0
+         ? static_cast<std::size_t>(configEnvs.compressThreads)
+         : std::max(1u, std::thread::hardware_concurrency());
+      ThreadPool compressPool{compressThreads};
+      // Con el almacen de chunks, los bloques gzip de los tar.gz con indice se cortan por contenido (CHUNK_AVG_SIZE)
+      FilesystemStorage repoStore{configEnvs.repositoriesRoot, configEnvs.repositoriesCipher, compressPool, configEnvs.compressBlockSize,
+                                  configEnvs.chunkStoreEnabled ? configEnvs.chunkAvgSize : 0};
+      // Usuarios con cache en memoria (las consultas de autorizacion no van a la BDD en cada peticion)
+      DBUserRepository userRepo{dbPool, static_cast<std::size_t>(std::max(0, configEnvs.userCacheCapacity)),
+                                static_cast<std::size_t>(std::max(1, configEnvs.userCacheShards)),
+                                configEnvs.userCacheTtlSeconds};
+      DBProjectRepository projectRepo{dbPool};
+      // Hash de passwords en su propio pool: rafagas de login/altas no ocupan los workers HTTP
+      ThreadPool passwordHashPool{static_cast<std::size_t>(std::max(1, configEnvs.passwordHashThreads))};
+      PasswordHasher passwordHasher{passwordHashPool, static_cast<unsigned int>(configEnvs.passwordHashIterations),
+                                    static_cast<std::size_t>(std::max(1, configEnvs.passwordHashQueueMax))};
+      // Sesiones en memoria: los tokens Bearer se validan sin consultar la BDD
+      SessionTokenStore sessionTokens{configEnvs.sessionTtlSeconds,
+                                      static_cast<std::size_t>(std::max(1, configEnvs.sessionStoreShards)),
+                                      configEnvs.sessionSigningKey};
+      std::size_t cipherThreads = configEnvs.cipherThreads > 0
+         ? static_cast<std::size_t>(configEnvs.cipherThreads)
+         : std::max(1u, std::thread::hardware_concurrency());
+      ThreadPool cipherPool{cipherThreads};
+      // Claves AES, IVs y relleno OAEP: un generador por hilo en lugar de sembrar uno desde el SO por llamada
+      SecureRandom secureRandom{configEnvs.randomReseedBytes, std::chrono::seconds(std::max(1, configEnvs.randomReseedSeconds))};
+      // Suite de los .tar.enc nuevos: AES-256-GCM con AES/PCLMUL por hardware, si no ChaCha20-Poly1305
+      std::uint8_t cipherSuite = CipherSuite::select(configEnvs.cipherSuite);
+      // Almacen deduplicado de chunks en REPOSITORIES_CIPHER/.chunks; deshabilitado solo se usa para leer
+      ChunkStore chunkStore{(std::filesystem::path(configEnvs.repositoriesCipher) / ".chunks").string(), configEnvs.chunkStoreKey,
+                            configEnvs.chunkAvgSize, configEnvs.chunkStoreEnabled, cipherPool, cipherSuite};
+      ProtectRepoCrypto repoCrypto{cipherPool, secureRandom, configEnvs.cipherBufferSize, static_cast<std::uint32_t>(configEnvs.cipherSegmentSize),
+                                   1024, cipherSuite, &chunkStore};
+      if (configEnvs.cipherSelfTestBytes > 0) {
+         double gbps = CipherSuite::measureGBps(cipherSuite, configEnvs.cipherSelfTestBytes,
+                                                static_cast<std::uint32_t>(configEnvs.cipherSegmentSize));
+         Log::info("Cipher suite selected", {{"suite", SegmentedAead::suiteName(cipherSuite)},
+                                             {"configured", configEnvs.cipherSuite},
+                                             {"aes_hardware", CipherSuite::hasAesHardware()},
+                                             {"gbps_per_thread", gbps},
+                                             {"threads", cipherThreads}});
+      } else {
+         Log::info("Cipher suite selected", {{"suite", SegmentedAead::suiteName(cipherSuite)}, {"configured", configEnvs.cipherSuite}});
+      }
+
+      // Metricas por ruta y por etapa interna de los casos de uso (/metrics)
+      MetricsRegistry metrics{CipherRepositoryUseCase::stageNames()};
+      metrics.addCollector([&userRepo] { return userRepo.cache().renderPrometheus(); });
+      metrics.addCollector([&repoCrypto] { return repoCrypto.rsaKeyCache().renderPrometheus(); });
+      metrics.addCollector([&repoCrypto] { return repoCrypto.ecKeyCache().renderPrometheus(); });
+      metrics.addCollector([&chunkStore] { return chunkStore.renderPrometheus(); });
+
+      // 4. Casos de uso (aplicacion); un lock por alias protegido compartido entre los que tocan sus archivos y claves
+      AliasLocks aliasLocks;
       CreateRepositoryUseCase createRepoUseCase{repoStore, userRepo, projectRepo};
-      CreateUserUseCase createUserUseCase{userRepo};
+      CreateUserUseCase createUserUseCase{userRepo, passwordHasher};
       SavePublicKeyECDSAUseCase saveKPubUseCase{userRepo};
       ChangeLevelUserUseCase changeLevelUserUseCase{userRepo};
       VerifyUserUseCase verifyUserUseCase{userRepo};
       ChangeStatusUserUseCase changeUserStatusUseCase{userRepo};
-      SavePublicKeyRSAUseCase saveKPubRSAUseCase{userRepo};
-      CipherRepositoryUseCase cipherRepoUseCase{repoStore, projectRepo, userRepo, repoCrypto};
+      SavePublicKeyRSAUseCase saveKPubRSAUseCase{userRepo, repoCrypto};
+      CipherRepositoryUseCase cipherRepoUseCase{repoStore, projectRepo, userRepo, repoCrypto, metrics, aliasLocks};
       AddUserToRepoUseCase addUserToRepoUseCase{projectRepo, userRepo};
+      ExtractProtectedFileUseCase extractProtectedFileUseCase{repoStore, projectRepo, userRepo, repoCrypto, aliasLocks};
+      CloneRepositoryUseCase cloneRepoUseCase{repoStore, projectRepo, userRepo, repoCrypto, aliasLocks};
+      PushRepositoryUseCase pushRepoUseCase{repoStore, projectRepo, userRepo, configEnvs.pushMaxBytes};
+      SessionUseCase sessionUseCase{userRepo, sessionTokens, passwordHasher};
+      RepoAccessUseCase repoAccessUseCase{repoStore, projectRepo, userRepo, repoCrypto, aliasLocks};
+      DecryptLocalProtectUseCase decryptLocalProtectUseCase{repoStore, projectRepo, userRepo, repoCrypto, aliasLocks};
+
+      // Cola de trabajos para /repo/protect (hilos propios, fuera de los workers HTTP)
+      JobQueue protectJobs{static_cast<std::size_t>(std::max(1, configEnvs.protectWorkers)),
+                           static_cast<std::size_t>(std::max(1, configEnvs.protectQueueMax)),
+                           std::chrono::seconds(configEnvs.protectJobTtlSeconds)};
 
       ////////////////// Caso de uso exclusivo para pruebas ////////////////////////
       TestUseCase testUseCase{repoStore, repoCrypto};
@@ -76,11 +161,26 @@ int main() {
          saveKPubRSAUseCase,
          cipherRepoUseCase,
          addUserToRepoUseCase,
+         extractProtectedFileUseCase,
+         cloneRepoUseCase,
+         pushRepoUseCase,
+         sessionUseCase,
+         repoAccessUseCase,
+         decryptLocalProtectUseCase,
+         protectJobs,
+         dbPool,
+         chunkStore,
+         metrics,
 
          testUseCase  // Caso de uso exclusivo para pruebas
       );
       
-      // 7. Iniciar servidor
+      // 7. Terminar o deshacer re-cifrados cortados por un reinicio (antes de atender peticiones)
+      std::size_t rekeyFiles = repoAccessUseCase.recoverInterruptedRekeys();
+      if (rekeyFiles > 0)
+         Log::info("Interrupted rekeys recovered", {{"removed_files", rekeyFiles}});
+
+      // 8. Iniciar servidor
       http_api.listen(configEnvs.serverHost.c_str(), configEnvs.serverPort);
 
    }
@@ -0,0 +1,4 @@
+-- users.password guarda ahora un hash PBKDF2 codificado:
+--   pbkdf2-sha256$<iteraciones>$<sal base64>$<hash base64>  (~90 caracteres)
+-- Las filas existentes (password en claro) siguen funcionando y se rehashean en el siguiente login.
+ALTER TABLE users MODIFY password VARCHAR(255) NOT NULL;
@@ -0,0 +1,5 @@
+-- repo_protect.rsa_aes guarda ahora la clave AES envuelta con RSA-OAEP o con ECIES (P-256 + HKDF + AES-GCM);
+-- wrap_alg dice cual. Las filas existentes son RSA-OAEP.
+--   rsa-oaep:   Base64(RSA-OAEP-SHA256(clave AES))                                 ~344 caracteres con RSA-2048
+--   ecies-p256: Base64(0x01 || punto efimero sin comprimir (65) || cifrado || tag (16))  ~168 caracteres
+ALTER TABLE repo_protect ADD COLUMN wrap_alg VARCHAR(16) NOT NULL DEFAULT 'rsa-oaep';
@@ -0,0 +1,5 @@
+-- Generacion de la clave AES de cada alias protegido. Un re-cifrado escribe los archivos del alias en la
+-- generacion siguiente (<repo>_<alias>.g<N>.tar.enc, .g<N>.d<M>.tar.enc, .g<N>.manifest.enc) y la activa al
+-- confirmar las filas nuevas; todas las filas de un alias tienen la misma. Las filas existentes son la
+-- generacion 0, cuyos archivos conservan los nombres sin sufijo.
+ALTER TABLE repo_protect ADD COLUMN key_generation INT UNSIGNED NOT NULL DEFAULT 0;